@@ -0,0 +1,594 @@
+/*=============================================================================
+ * cut_pursuit_cli --solver {ql1b | lsx | d0} [--config file] [--key value]...
+ *
+ * Standalone command line driver for batch processing, running one of the
+ * specializations Cp_d1_ql1b, Cp_d1_lsx or Cp_d0_dist on a graph and
+ * observations read from raw binary files, and writing components, values
+ * and statistics to raw binary and text files.
+ *
+ * Parameters are given either on the command line as "--key value" (or
+ * "--key=value"), or in a configuration file given with "--config file",
+ * one "key = value" per line, '#' starting a comment; command line values
+ * override configuration file values. Run without argument for the list of
+ * keys.
+ *
+ * Binary files contain raw arrays in native byte order, without header
+ * (e.g. as written by numpy.ndarray.tofile() or Octave fwrite()); real arrays
+ * are in single or double precision according to the key "precision",
+ * multidimensional arrays are in column major format (D-by-V); graph arrays
+ * are unsigned 32-bit integers, in the forward-star representation described
+ * in include/cut_pursuit.hpp.
+ *
+ * Parameters which can be either an array or a homogeneous value (e.g.
+ * "edge_weights") are given either as a number or as a file name.
+ *
+ * Outputs, where <prefix> is given by key "output":
+ *   <prefix>_comp.bin   component assignment, unsigned 32-bit integers (V)
+ *   <prefix>_values.bin values of the components, real (D-by-rV)
+ *   <prefix>_stats.txt  number of iterations, of components, elapsed time,
+ *                       objective values if "monitor" is set, duality gap
+ *                       if "gap_tol" is set, and estimated distortion if
+ *                       "compress" is set
+ *
+ * The number of threads is limited with key "threads", or else by the
+ * environment variable OMP_NUM_THREADS. Parallelization thresholds are read
+ * from the profile file given with key "calibration"; if the file does not
+ * exist, the host is calibrated and the profile is saved in it (see
+ * include/omp_num_threads.hpp).
+ *
+ * Typical compilation command, from the root of the repository:
+ *   g++ -std=c++11 -O3 -fopenmp cli/cut_pursuit_cli.cpp
+ *       src/cp_pfdr_d1_ql1b.cpp src/cp_pfdr_d1_lsx.cpp src/cp_kmpp_d0_dist.cpp
+ *       src/cut_pursuit_d1.cpp src/cut_pursuit_d0.cpp src/cut_pursuit.cpp
+ *       src/cp_graph.cpp src/pfdr_d1_ql1b.cpp src/pfdr_d1_lsx.cpp
+ *       src/matrix_tools.cpp src/proj_simplex.cpp src/pfdr_graph_d1.cpp
+ *       src/pcd_fwd_doug_rach.cpp src/pcd_prox_split.cpp src/pd_d1_ql1b.cpp
+ *       src/pd_d1_lsx.cpp src/pd_graph_d1.cpp src/compressed_adjacency.cpp
+ *       src/ssnal_d1_ql1b.cpp
+ *       -o bin/cut_pursuit_cli
+ *===========================================================================*/
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <cerrno>
+#include <string>
+#include <map>
+#include <fstream>
+#include "../include/cp_pfdr_d1_ql1b.hpp"
+#include "../include/cp_pfdr_d1_lsx.hpp"
+#include "../include/cp_kmpp_d0_dist.hpp"
+#include "../include/omp_num_threads.hpp"
+
+using namespace std;
+
+/* index_t must be able to represent the number of vertices and of (undirected)
+ * edges in the main graph;
+ * comp_t must be able to represent the number of constant connected components
+ * in the reduced graph, as well as the dimension D; since batch tiles can be
+ * large and no interpreter constrains the types, 32 bits are used */
+typedef uint32_t index_t;
+typedef uint32_t comp_t;
+
+#define ERR_PREFIX "Cut-pursuit command line: "
+
+typedef map<string, string> Params;
+
+static const char* usage =
+"usage: cut_pursuit_cli --solver {ql1b | lsx | d0} [--config file]\n"
+"    [--key value]...\n"
+"common keys:\n"
+"  first_edge, adj_vertices  graph files (uint32), mandatory\n"
+"  Y                  observations file, mandatory (for ql1b, A^t Y if N\n"
+"                     is full_ata)\n"
+"  D                  dimension of observations (lsx, d0), default 1\n"
+"  edge_weights       file or value, default 1\n"
+"  precision          single or double, default double\n"
+"  cp_dif_tol, cp_it_max, verbose   cut-pursuit parameters\n"
+"  maxflow            bk (default), ibfs, push_relabel or auto\n"
+"  maxflow_auto_min_size, maxflow_auto_dense_degree, maxflow_gather_min_size\n"
+"                     see Cp::set_maxflow_param\n"
+"  init_balance_tol   if given, start from arbitrary components grown in\n"
+"                     parallel, see Cp::set_components\n"
+"  threads            maximum number of threads\n"
+"  calibration        parallelization profile file, created if needed\n"
+"  monitor            if nonzero, compute objective at each iteration\n"
+"  output             prefix of output files, default \"cp\"\n"
+"ql1b keys:\n"
+"  N                  diag_ata (default), full_ata or number of observations\n"
+"  A                  file: N-by-V matrix, V-by-V A^t A if N is full_ata, or\n"
+"                     diagonal of A^t A if N is diag_ata; or value a if N is\n"
+"                     diag_ata, default 1\n"
+"  compress           if given, N must be a number of observations; 0\n"
+"                     precomputes A^t A, otherwise sketch size, see\n"
+"                     compress_quadratic\n"
+"  compress_dist_tol  distortion tolerance, see compress_quadratic, default 0\n"
+"  Yl1, l1_weights, low_bnd, upp_bnd   see Cp_d1_ql1b\n"
+"  pfdr_rho, pfdr_cond_min, pfdr_dif_rcd, pfdr_dif_tol, pfdr_it_max\n"
+"  pfdr_mixed_precision, pfdr_refine_it_max   see set_pfdr_mixed_precision\n"
+"  independent_reduced_solves, independent_min_size   see\n"
+"                     set_independent_reduced_solves, default 1 and 1000\n"
+"  reduced_solver     pfdr (default), pd or auto, see set_reduced_solver\n"
+"  pd_dual_scale, auto_coupling_max   see set_reduced_solver, default 0\n"
+"                     and 0.5\n"
+"  gap_tol            duality gap tolerance, see Cp_d1::set_gap_tol,\n"
+"                     default 0 (no certificate)\n"
+"  loose_dif_tol, loose_it_max, stable_ratio   see set_inexact_reduced,\n"
+"                     default 0 (always accurate), 100 and 0.05\n"
+"  exact_max_size, exact_dif_tol, exact_it_max, exact_direct   see\n"
+"                     set_exact_reduced, default 200, 1e-10, 100 and 0\n"
+"lsx keys:\n"
+"  loss               0 linear, 1 quadratic, in ]0,1[ smoothed KL, mandatory\n"
+"  loss_weights, coor_weights   files, see Cp_d1_lsx\n"
+"  pfdr_rho, pfdr_cond_min, pfdr_dif_rcd, pfdr_dif_tol, pfdr_it_max\n"
+"  pfdr_mixed_precision, pfdr_refine_it_max   see set_pfdr_mixed_precision\n"
+"  independent_reduced_solves, independent_min_size   see\n"
+"                     set_independent_reduced_solves, default 1 and 1000\n"
+"  reduced_solver     pfdr (default), pd or auto, see set_reduced_solver\n"
+"  pd_dual_scale, auto_coupling_max   see set_reduced_solver, default 0\n"
+"                     and 0.5\n"
+"  gap_tol            duality gap tolerance, see Cp_d1::set_gap_tol,\n"
+"                     default 0 (no certificate)\n"
+"  loose_dif_tol, loose_it_max, stable_ratio   see set_inexact_reduced,\n"
+"                     default 0 (always accurate), 100 and 0.05\n"
+"d0 keys:\n"
+"  loss               1 quadratic, in ]0,1[ smoothed KL, default 1\n"
+"  vert_weights, coor_weights   files, see Cp_d0_dist\n"
+"  K, split_iter_num, kmpp_init_num, kmpp_iter_num\n"
+"  recursive_split    if nonzero, split components recursively, see Cp_d0\n"
+"  standard_refine    if nonzero (default), only the first split is\n"
+"                     recursive, see Cp_d0::set_split_param\n"
+"  matching_merge     if nonzero, merge by rounds of matchings, see Cp_d0\n";
+
+static void error(const string& msg)
+{
+    cerr << ERR_PREFIX << msg << endl;
+    exit(EXIT_FAILURE);
+}
+
+/**  parameters  **/
+
+static string trim(const string& s)
+{
+    size_t b = s.find_first_not_of(" \t\r\n");
+    if (b == string::npos){ return ""; }
+    size_t e = s.find_last_not_of(" \t\r\n");
+    return s.substr(b, e - b + 1);
+}
+
+static void read_config(const char* file_name, Params& params)
+{
+    ifstream file(file_name);
+    if (!file){ error(string("cannot open configuration file ") + file_name
+        + " (" + strerror(errno) + ")."); }
+    string line;
+    int line_num = 0;
+    while (getline(file, line)){
+        line_num++;
+        size_t comment = line.find('#');
+        if (comment != string::npos){ line.erase(comment); }
+        line = trim(line);
+        if (line.empty()){ continue; }
+        size_t eq = line.find('=');
+        if (eq == string::npos){
+            error(string("configuration file ") + file_name + ", line "
+                + to_string(line_num) + ": 'key = value' expected.");
+        }
+        params[trim(line.substr(0, eq))] = trim(line.substr(eq + 1));
+    }
+}
+
+static void parse_args(int argc, char** argv, Params& params)
+{
+    Params cmd_params;
+    string config;
+    for (int i = 1; i < argc; i++){
+        string arg = argv[i];
+        if (arg.compare(0, 2, "--")){
+            error("unexpected argument '" + arg + "'.");
+        }
+        arg.erase(0, 2);
+        string value;
+        size_t eq = arg.find('=');
+        if (eq != string::npos){
+            value = arg.substr(eq + 1);
+            arg.erase(eq);
+        }else if (i + 1 < argc){
+            value = argv[++i];
+        }else{
+            error("missing value for key '" + arg + "'.");
+        }
+        if (arg == "config"){ config = value; }
+        else{ cmd_params[arg] = value; }
+    }
+    if (!config.empty()){ read_config(config.c_str(), params); }
+    for (Params::iterator p = cmd_params.begin(); p != cmd_params.end(); p++){
+        params[p->first] = p->second;
+    }
+}
+
+static bool has(const Params& params, const char* key)
+{ return params.find(key) != params.end(); }
+
+static bool is_number(const string& s, double* value = nullptr)
+{
+    char* end;
+    double x = strtod(s.c_str(), &end);
+    if (end == s.c_str() || *end != '\0'){ return false; }
+    if (value){ *value = x; }
+    return true;
+}
+
+static double get_number(const Params& params, const char* key,
+    double default_value)
+{
+    Params::const_iterator p = params.find(key);
+    if (p == params.end()){ return default_value; }
+    double value;
+    if (!is_number(p->second, &value)){
+        error(string("key '") + key + "' expects a number, but '" + p->second
+            + "' is given.");
+    }
+    return value;
+}
+
+static string get_string(const Params& params, const char* key,
+    const char* default_value = nullptr)
+{
+    Params::const_iterator p = params.find(key);
+    if (p != params.end()){ return p->second; }
+    if (!default_value){
+        error(string("key '") + key + "' is mandatory.");
+    }
+    return default_value;
+}
+
+/**  binary files  **/
+
+/* read a raw array of 'size' elements, or of any size if 'size' is zero;
+ * the number of elements read is returned in 'size' */
+template <typename type_t>
+static type_t* read_array(const string& file_name, size_t& size)
+{
+    FILE* file = fopen(file_name.c_str(), "rb");
+    if (!file){ error("cannot open " + file_name + " ("
+        + strerror(errno) + ")."); }
+    fseek(file, 0, SEEK_END);
+    long bytes = ftell(file);
+    fseek(file, 0, SEEK_SET);
+    if (bytes < 0 || bytes % sizeof(type_t)){
+        error(file_name + " size is not a multiple of "
+            + to_string(sizeof(type_t)) + " bytes.");
+    }
+    size_t num = bytes/sizeof(type_t);
+    if (size && num != size){
+        error(file_name + " should contain " + to_string(size)
+            + " elements, but " + to_string(num) + " are found.");
+    }
+    size = num;
+    type_t* array = (type_t*) malloc(sizeof(type_t)*(size ? size : 1));
+    if (!array){ error("not enough memory."); }
+    if (fread(array, sizeof(type_t), size, file) != size){
+        error("cannot read " + file_name + ".");
+    }
+    fclose(file);
+    return array;
+}
+
+/* array parameter which can alternatively be given as a homogeneous value;
+ * return null and set the value if a number is given */
+template <typename real_t>
+static real_t* get_array_or_value(const Params& params, const char* key,
+    size_t size, real_t& value, real_t default_value)
+{
+    value = default_value;
+    Params::const_iterator p = params.find(key);
+    if (p == params.end()){ return nullptr; }
+    double x;
+    if (is_number(p->second, &x)){ value = x; return nullptr; }
+    return read_array<real_t>(p->second, size);
+}
+
+template <typename real_t>
+static real_t* get_array(const Params& params, const char* key, size_t size)
+{
+    if (!has(params, key)){ return nullptr; }
+    return read_array<real_t>(get_string(params, key), size);
+}
+
+template <typename type_t>
+static void write_array(const string& file_name, const type_t* array,
+    size_t size)
+{
+    FILE* file = fopen(file_name.c_str(), "wb");
+    if (!file){ error("cannot open " + file_name + " for writing ("
+        + strerror(errno) + ")."); }
+    if (fwrite(array, sizeof(type_t), size, file) != size){
+        error("cannot write " + file_name + ".");
+    }
+    fclose(file);
+}
+
+/**  run the solver  **/
+
+template <typename real_t>
+static int cut_pursuit_cli(const Params& params)
+{
+    string solver = get_string(params, "solver");
+    string output = get_string(params, "output", "cp");
+
+    /* graph structure */
+    size_t size = 0;
+    index_t* first_edge = read_array<index_t>(get_string(params,
+        "first_edge"), size);
+    if (size < 1){ error("'first_edge' must contain at least one element."); }
+    index_t V = size - 1;
+    size = first_edge[V];
+    index_t* adj_vertices = read_array<index_t>(get_string(params,
+        "adj_vertices"), size);
+    index_t E = size;
+
+    size_t D = get_number(params, "D", 1);
+    real_t homo_edge_weight;
+    real_t* edge_weights = get_array_or_value<real_t>(params, "edge_weights",
+        E, homo_edge_weight, 1.0);
+
+    /* algorithmic parameters */
+    real_t cp_dif_tol = get_number(params, "cp_dif_tol",
+        solver == "ql1b" ? 1e-4 : 1e-3);
+    int cp_it_max = get_number(params, "cp_it_max", 10);
+    int verbose = get_number(params, "verbose", 0);
+    real_t pfdr_rho = get_number(params, "pfdr_rho", 1.0);
+    real_t pfdr_cond_min = get_number(params, "pfdr_cond_min", 1e-2);
+    real_t pfdr_dif_rcd = get_number(params, "pfdr_dif_rcd", 0.0);
+    real_t pfdr_dif_tol = get_number(params, "pfdr_dif_tol",
+        1e-3*cp_dif_tol);
+    int pfdr_it_max = get_number(params, "pfdr_it_max", 1e4);
+    bool pfdr_mixed = get_number(params, "pfdr_mixed_precision", 0);
+    int pfdr_refine_it_max = get_number(params, "pfdr_refine_it_max", 100);
+    bool independent = get_number(params, "independent_reduced_solves", 1);
+    comp_t independent_min_size = get_number(params, "independent_min_size",
+        1000);
+    typedef Cp_d1<real_t, index_t, comp_t> Cp_d1_t;
+    typename Cp_d1_t::Reduced_solver reduced_solver;
+    string reduced_solver_str = get_string(params, "reduced_solver", "pfdr");
+    if (reduced_solver_str == "pfdr"){
+        reduced_solver = Cp_d1_t::REDUCED_PFDR;
+    }else if (reduced_solver_str == "pd"){
+        reduced_solver = Cp_d1_t::REDUCED_PD;
+    }else if (reduced_solver_str == "auto"){
+        reduced_solver = Cp_d1_t::REDUCED_AUTO;
+    }else{ error("'reduced_solver' must be pfdr, pd or auto, but '" +
+        reduced_solver_str + "' is given."); }
+    real_t pd_dual_scale = get_number(params, "pd_dual_scale", 0.0);
+    real_t auto_coupling_max = get_number(params, "auto_coupling_max", 0.5);
+    real_t gap_tol = get_number(params, "gap_tol", 0.0);
+    real_t loose_dif_tol = get_number(params, "loose_dif_tol", 0.0);
+    int loose_it_max = get_number(params, "loose_it_max", 100);
+    real_t stable_ratio = get_number(params, "stable_ratio", 0.05);
+
+    /* monitoring */
+    real_t* Obj = get_number(params, "monitor", 0) ?
+        (real_t*) malloc(sizeof(real_t)*(cp_it_max + 1)) : nullptr;
+    double* Time = (double*) malloc(sizeof(double)*(cp_it_max + 1));
+    if (!Time || (get_number(params, "monitor", 0) && !Obj)){
+        error("not enough memory.");
+    }
+
+    /* arrays to be free()'d at the end */
+    real_t *Y = nullptr, *A = nullptr, *Yl1 = nullptr, *l1_weights = nullptr,
+        *low_bnd = nullptr, *upp_bnd = nullptr, *loss_weights = nullptr,
+        *coor_weights = nullptr;
+
+    Cp<real_t, index_t, comp_t>* cp;
+    Cp_d1_t* cp_d1 = nullptr; // for retrieving the duality gap
+    real_t compress_dist = -1.0; // estimated distortion, negative if unused
+
+    if (solver == "ql1b"){
+        D = 1;
+        size_t N;
+        string N_str = get_string(params, "N", "diag_ata");
+        double N_num;
+        if (N_str == "diag_ata"){ N = DIAG_ATA; }
+        else if (N_str == "full_ata"){ N = FULL_ATA; }
+        else if (is_number(N_str, &N_num) && N_num >= 1){ N = N_num; }
+        else{ error("'N' must be diag_ata, full_ata or a positive number of "
+            "observations, but '" + N_str + "' is given."); }
+
+        size = N == FULL_ATA || N == DIAG_ATA ? V : N;
+        Y = read_array<real_t>(get_string(params, "Y"), size);
+        real_t a = 1.0;
+        if (N == DIAG_ATA){
+            A = get_array_or_value<real_t>(params, "A", V, a, 1.0);
+        }else{
+            size = (N == FULL_ATA ? V : N)*V;
+            A = read_array<real_t>(get_string(params, "A"), size);
+        }
+
+        Yl1 = get_array<real_t>(params, "Yl1", V);
+        real_t homo_l1_weight, homo_low_bnd, homo_upp_bnd;
+        l1_weights = get_array_or_value<real_t>(params, "l1_weights", V,
+            homo_l1_weight, 0.0);
+        low_bnd = get_array_or_value<real_t>(params, "low_bnd", V,
+            homo_low_bnd, -INF_REAL);
+        upp_bnd = get_array_or_value<real_t>(params, "upp_bnd", V,
+            homo_upp_bnd, INF_REAL);
+
+        Cp_d1_ql1b<real_t, index_t, comp_t>* cp_ql1b =
+            new Cp_d1_ql1b<real_t, index_t, comp_t>(V, E, first_edge,
+                adj_vertices);
+        cp_ql1b->set_edge_weights(edge_weights, homo_edge_weight);
+        cp_ql1b->set_quadratic(Y, N, A, a);
+        if (has(params, "compress")){
+            if (N == FULL_ATA || N == DIAG_ATA){ error("'compress' requires "
+                "'N' to be a number of observations."); }
+            compress_dist = cp_ql1b->compress_quadratic(
+                get_number(params, "compress", 0),
+                get_number(params, "compress_dist_tol", 0.0));
+        }
+        cp_ql1b->set_l1(l1_weights, homo_l1_weight, Yl1);
+        cp_ql1b->set_bounds(low_bnd, homo_low_bnd, upp_bnd, homo_upp_bnd);
+        cp_ql1b->set_cp_param(cp_dif_tol, cp_it_max, verbose);
+        cp_ql1b->set_pfdr_param(pfdr_rho, pfdr_cond_min, pfdr_dif_rcd,
+            pfdr_it_max, pfdr_dif_tol);
+        cp_ql1b->set_pfdr_mixed_precision(pfdr_mixed, pfdr_refine_it_max);
+        cp_ql1b->set_independent_reduced_solves(independent,
+            independent_min_size);
+        cp_ql1b->set_reduced_solver(reduced_solver, pd_dual_scale,
+            auto_coupling_max);
+        cp_ql1b->set_gap_tol(gap_tol);
+        cp_ql1b->set_inexact_reduced(loose_dif_tol, loose_it_max,
+            stable_ratio);
+        cp_ql1b->set_exact_reduced(get_number(params, "exact_max_size", 200),
+            get_number(params, "exact_dif_tol", 1e-10),
+            get_number(params, "exact_it_max", 100),
+            get_number(params, "exact_direct", 0));
+        cp = cp_d1 = cp_ql1b;
+    }else if (solver == "lsx"){
+        if (!has(params, "loss")){ error("key 'loss' is mandatory."); }
+        real_t loss = get_number(params, "loss", 0.0);
+        size = D*V;
+        Y = read_array<real_t>(get_string(params, "Y"), size);
+        loss_weights = get_array<real_t>(params, "loss_weights", V);
+        coor_weights = get_array<real_t>(params, "coor_weights", D);
+
+        Cp_d1_lsx<real_t, index_t, comp_t>* cp_lsx =
+            new Cp_d1_lsx<real_t, index_t, comp_t>(V, E, first_edge,
+                adj_vertices, D, Y);
+        cp_lsx->set_loss(loss, Y, loss_weights);
+        cp_lsx->set_edge_weights(edge_weights, homo_edge_weight,
+            coor_weights);
+        cp_lsx->set_cp_param(cp_dif_tol, cp_it_max, verbose);
+        cp_lsx->set_pfdr_param(pfdr_rho, pfdr_cond_min, pfdr_dif_rcd,
+            pfdr_it_max, pfdr_dif_tol);
+        cp_lsx->set_pfdr_mixed_precision(pfdr_mixed, pfdr_refine_it_max);
+        cp_lsx->set_independent_reduced_solves(independent,
+            independent_min_size);
+        cp_lsx->set_reduced_solver(reduced_solver, pd_dual_scale,
+            auto_coupling_max);
+        cp_lsx->set_gap_tol(gap_tol);
+        cp_lsx->set_inexact_reduced(loose_dif_tol, loose_it_max,
+            stable_ratio);
+        cp = cp_d1 = cp_lsx;
+    }else if (solver == "d0"){
+        real_t loss = get_number(params, "loss", 1.0);
+        size = D*V;
+        Y = read_array<real_t>(get_string(params, "Y"), size);
+        loss_weights = get_array<real_t>(params, "vert_weights", V);
+        coor_weights = get_array<real_t>(params, "coor_weights", D);
+
+        Cp_d0_dist<real_t, index_t, comp_t>* cp_d0 =
+            new Cp_d0_dist<real_t, index_t, comp_t>(V, E, first_edge,
+                adj_vertices, Y, D);
+        cp_d0->set_loss(loss, Y, loss_weights, coor_weights);
+        cp_d0->set_edge_weights(edge_weights, homo_edge_weight);
+        cp_d0->set_cp_param(cp_dif_tol, cp_it_max, verbose);
+        cp_d0->set_split_param(get_number(params, "K", 2),
+            get_number(params, "split_iter_num", 2),
+            get_number(params, "recursive_split", 0),
+            get_number(params, "standard_refine", 1));
+        cp_d0->set_merge_param(get_number(params, "matching_merge", 0));
+        cp_d0->set_kmpp_param(get_number(params, "kmpp_init_num", 3),
+            get_number(params, "kmpp_iter_num", 3));
+        cp = cp_d0;
+    }else{
+        error("unknown solver '" + solver + "', expected ql1b, lsx or d0.");
+        return EXIT_FAILURE;
+    }
+
+    /* the adjacency is stored in the flow graph from now on */
+    free(adj_vertices); adj_vertices = nullptr;
+
+    cp->set_monitoring_arrays(Obj, Time);
+
+    string maxflow = get_string(params, "maxflow", "bk");
+    Maxflow_engine engine;
+    if (maxflow == "bk"){ engine = MAXFLOW_BK; }
+    else if (maxflow == "ibfs"){ engine = MAXFLOW_IBFS; }
+    else if (maxflow == "push_relabel"){ engine = MAXFLOW_PUSH_RELABEL; }
+    else if (maxflow == "auto"){ engine = MAXFLOW_AUTO; }
+    else{ error("'maxflow' must be bk, ibfs, push_relabel or auto, but '"
+        + maxflow + "' is given."); return EXIT_FAILURE; }
+    cp->set_maxflow_param(engine,
+        get_number(params, "maxflow_auto_min_size", 10000),
+        get_number(params, "maxflow_auto_dense_degree", 16.0),
+        get_number(params, "maxflow_gather_min_size", 0));
+
+    if (params.count("init_balance_tol")){
+        cp->set_components(0, nullptr,
+            get_number(params, "init_balance_tol", 0.5));
+    }
+
+    int it = cp->cut_pursuit();
+
+    /**  write outputs  **/
+
+    comp_t* comp_assign;
+    comp_t rV = cp->get_components(&comp_assign);
+    write_array(output + "_comp.bin", comp_assign, V);
+    write_array(output + "_values.bin", cp->get_reduced_values(), rV*D);
+
+    string stats_name = output + "_stats.txt";
+    FILE* stats = fopen(stats_name.c_str(), "w");
+    if (!stats){ error("cannot open " + stats_name + " for writing ("
+        + strerror(errno) + ")."); }
+    fprintf(stats, "solver %s\nV %lu\nE %lu\nD %lu\niterations %d\n"
+        "components %lu\ntime %g\n", solver.c_str(), (unsigned long) V,
+        (unsigned long) E, (unsigned long) D, it, (unsigned long) rV,
+        Time[it]);
+    if (Obj){
+        fprintf(stats, "objective");
+        for (int i = 0; i <= it; i++){ fprintf(stats, " %.9g", Obj[i]); }
+        fprintf(stats, "\n");
+    }
+    if (cp_d1 && gap_tol > 0.0){
+        fprintf(stats, "duality_gap %g\n", cp_d1->get_duality_gap());
+    }
+    if (compress_dist >= 0.0){
+        fprintf(stats, "compress_distortion %g\n", compress_dist);
+    }
+    fclose(stats);
+
+    delete cp;
+    free(first_edge); free(adj_vertices); free(edge_weights);
+    free(Y); free(A); free(Yl1); free(l1_weights); free(low_bnd);
+    free(upp_bnd); free(loss_weights); free(coor_weights);
+    free(Obj); free(Time);
+
+    return EXIT_SUCCESS;
+}
+
+int main(int argc, char** argv)
+{
+    if (argc < 2){
+        cerr << usage;
+        return EXIT_FAILURE;
+    }
+
+    Params params;
+    parse_args(argc, argv, params);
+
+    int threads = get_number(params, "threads", 0);
+    if (threads > 0){ omp_set_num_threads(threads); }
+
+    if (has(params, "calibration")){
+        string calibration = get_string(params, "calibration");
+        if (!load_num_threads_calibration(calibration.c_str())){
+            calibrate_num_threads();
+            if (!save_num_threads_calibration(calibration.c_str())){
+                error("cannot write calibration profile " + calibration
+                    + ".");
+            }
+        }
+    }
+
+    string precision = get_string(params, "precision", "double");
+    if (precision == "double"){
+        return cut_pursuit_cli<double>(params);
+    }else if (precision == "single"){
+        return cut_pursuit_cli<float>(params);
+    }else{
+        error("precision must be single or double, but '" + precision
+            + "' is given.");
+    }
+    return EXIT_FAILURE;
+}
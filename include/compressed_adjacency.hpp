@@ -0,0 +1,141 @@
+/*=============================================================================
+ * Compressed forward-star adjacency of a graph
+ *
+ * The ending vertices of the edges originating from each vertex are encoded
+ * as differences, each with respect to the previous one (the first one with
+ * respect to the originating vertex itself), mapped to unsigned integers by
+ * zigzag encoding (0, -1, 1, -2, 2... to 0, 1, 2, 3, 4...), and written as
+ * variable-length integers, with seven bits per byte and the eighth bit
+ * flagging that more bytes follow.
+ *
+ * For graphs whose vertices are mostly adjacent to vertices with close
+ * indices (e.g. k-nearest neighbors graphs over spatially sorted points),
+ * most differences hold in one or two bytes instead of four or eight.
+ *
+ * Decoding is sequential within the edges originating from a vertex; the byte
+ * position is recorded only every ADJ_BLOCK_SIZE vertices, so that the
+ * overhead per vertex is negligible.
+ *
+ * The adjacency can be compressed vertex after vertex, in order, without
+ * ever storing the uncompressed array of adjacent vertices.
+ *===========================================================================*/
+#pragma once
+#include <cstdlib>
+#include <cstdint>
+
+/* number of vertices between two recorded byte positions */
+#define ADJ_BLOCK_SIZE 32
+
+/* index_t is an integer type able to represent the number of vertices and of
+ * (directed) edges */
+template <typename index_t>
+class Compressed_adjacency
+{
+public:
+    /**  constructors, destructor  **/
+
+    /* empty adjacency over V vertices, to be filled with append();
+     * 'first_edge' is the forward-star array of length V + 1, see
+     * cut_pursuit.hpp; it is not copied and must remain available */
+    Compressed_adjacency(index_t V, const index_t* first_edge);
+
+    /* compress the forward-star array of adjacent vertices 'adj_vertices' */
+    Compressed_adjacency(index_t V, const index_t* first_edge,
+        const index_t* adj_vertices);
+
+    ~Compressed_adjacency();
+
+    /**  compression  **/
+
+    /* append the ending vertices of the edges originating from the next
+     * vertex, array of length first_edge[v + 1] - first_edge[v]; vertices
+     * must be appended in increasing order, until all V are */
+    void append(const index_t* adj_vertices_v);
+
+    /* release memory reserved beyond the actual compressed size */
+    void shrink_to_fit();
+
+    /**  decompression  **/
+
+    /* sequential decoder of the ending vertices of all edges, in the order of
+     * the forward-star representation, starting from a given vertex */
+    class Decoder
+    {
+    public:
+        Decoder(const Compressed_adjacency& adjacency, index_t v = 0);
+
+        /* ending vertex of the next edge */
+        index_t next();
+
+    private:
+        const index_t* const first_edge;
+        const uint8_t* byte;
+        index_t v; // current originating vertex
+        index_t e; // next edge
+        index_t last; // last decoded vertex
+    };
+
+    /* decode the ending vertices of the edges originating from vertex v into
+     * the array 'adj_vertices_v' of length first_edge[v + 1] - first_edge[v] */
+    void decode(index_t v, index_t* adj_vertices_v) const;
+
+    /**  information  **/
+
+    index_t get_num_vertices() const { return V; }
+
+    /* compressed size in bytes, including recorded byte positions */
+    size_t memory_size() const;
+
+private:
+    const index_t V;
+    const index_t* const first_edge;
+
+    uint8_t* bytes; // compressed differences
+    size_t num_bytes, max_bytes; // actual and reserved sizes of 'bytes'
+
+    /* byte position of the edges originating from every ADJ_BLOCK_SIZE-th
+     * vertex, array of length V/ADJ_BLOCK_SIZE + 1 */
+    size_t* block_byte;
+
+    index_t appended; // number of vertices already appended
+
+    void* realloc_check(void* ptr, size_t size);
+};
+
+/***  inline methods  ***/
+
+template <typename index_t>
+inline index_t Compressed_adjacency<index_t>::Decoder::next()
+{
+    /* skip vertices with no more edges */
+    while (e == first_edge[v + 1]){ last = ++v; }
+    uintmax_t zigzag = 0;
+    int shift = 0;
+    uint8_t b;
+    do {
+        b = *(byte++);
+        zigzag |= (uintmax_t) (b & 0x7F) << shift;
+        shift += 7;
+    } while (b & 0x80);
+    /* differences are computed modulo the range of uintmax_t */
+    uintmax_t dif = (zigzag >> 1) ^ (~(zigzag & 1) + 1);
+    last = (uintmax_t) last + dif;
+    e++;
+    return last;
+}
+
+/* ending vertices of the edges of a forward-star representation, either as a
+ * plain array or as a compressed adjacency; implicitly constructible from
+ * both, so that either can be given to the cut-pursuit constructors */
+template <typename index_t>
+struct Adj_vertices
+{
+    const index_t* array;
+    const Compressed_adjacency<index_t>* compressed;
+
+    Adj_vertices(const index_t* adj_vertices)
+        : array(adj_vertices), compressed(nullptr){}
+
+    Adj_vertices(const Compressed_adjacency<index_t>& adjacency)
+        : array(nullptr), compressed(&adjacency){}
+};
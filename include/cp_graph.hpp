@@ -4,7 +4,9 @@
  *
  * - reuse tree option removed, together with dedicated variables
  * - nodes and arcs arrays made public for direct manipulation by cut-pursuit
- * - cannot reallocate nodes and arcs array for now
+ * - nodes and arcs arrays can be enlarged with reserve(), but not while
+ *   parallel copies exist; edges can be inserted with insert_edges() and
+ *   detached with detach_edge()
  * - max flows are not computed anymore, since they are not useful here
  * - capacities are all of type real_t, nodes and edges are indexed by
  *   integral type index_t, and a type comp_t is used to index components
@@ -20,6 +22,16 @@
  *   orphans (see process_*_orphan() in cp_graph.cpp)
  * - a derived class Cp_graph_parallel is implemented, useful to handle
  *   private copies of a main graph in parallel threads
+ * - besides the Boykov & Kolmogorov algorithm, two other maximum flow
+ *   algorithms are available on the same structures, selected by the engine
+ *   parameter of maxflow(): incremental breadth-first search (Goldberg,
+ *   Hed, Kaplan, Tarjan & Werneck, 2011), which grows both search trees by
+ *   layers of distance labels, so that orphans are adopted without walking
+ *   back to the terminals; and the first phase of the
+ *   highest-label push-relabel algorithm (Goldberg & Tarjan, 1988) with
+ *   periodic global relabeling; all return the same cut, the source side
+ *   being the set of nodes reachable from the source in the residual graph,
+ *   and all respect the negative residual capacities of active edges
  *
  * some other modifications:
  *  - do not initialize nodes array with memset() because the null pointer
@@ -50,6 +62,11 @@
 #include <iostream>
 #include "block.hpp"
 
+/* maximum flow algorithms; MAXFLOW_AUTO is not an algorithm itself, but
+ * lets cut-pursuit choose one for each component, see Cp::set_maxflow_param */
+enum Maxflow_engine {MAXFLOW_BK, MAXFLOW_IBFS, MAXFLOW_PUSH_RELABEL,
+    MAXFLOW_AUTO};
+
 /* declare cut-pursuit base class for friendship */
 template <typename real_t, typename index_t, typename comp_t,
     typename value_t> class Cp;
@@ -63,7 +80,10 @@ template <typename real_t, typename index_t, typename comp_t,
 template <typename real_t, typename index_t, typename comp_t,
     typename value_t = real_t> class Cp_graph
 {
-    friend class Cp<real_t, index_t, comp_t, value_t>;
+    /* the capacity type of the flow graph can differ from the real type of
+     * the cut-pursuit object */
+    template <typename cp_real_t, typename cp_index_t, typename cp_comp_t,
+        typename cp_value_t> friend class Cp;
 
 public:
 
@@ -91,6 +111,29 @@ public:
      * and 'rev_cap' */
 	void add_edge(index_t i, index_t j, real_t cap, real_t rev_cap);
 
+    /* enlarge the nodes and arcs arrays, if necessary, so that they can hold
+     * at least the given numbers of nodes and edges; arrays grow
+     * geometrically, so that repeated small enlargements are cheap; parallel
+     * copies of the graph must not exist while this is called */
+    void reserve(index_t node_num_max, index_t edge_num_max);
+
+    /* detach both arcs of edge e from the lists of their originating nodes,
+     * and make them loop on the origin of the edge, so that the edge is
+     * ignored by maximum flows and does not link its ends anymore; residual
+     * capacities are set to zero; returns false if the edge was already
+     * detached */
+    bool detach_edge(index_t e);
+
+    /* renumber the edges after insertion of new edges in the forward-star
+     * structure of the current nodes: the edges 'old_first_edge[i]', ...,
+     * 'old_first_edge[i + 1] - 1' originating from node i become edges
+     * 'first_edge[i]', ..., followed up to 'first_edge[i + 1] - 1' by new
+     * edges ending at the nodes given in 'adj_nodes', with zero residual
+     * capacities; arcs lists are rebuilt, detached edges staying detached;
+     * parallel copies of the graph must not exist while this is called */
+    void insert_edges(const index_t* old_first_edge, const index_t* first_edge,
+        const index_t* adj_nodes);
+
 	// Adds new edges 'SOURCE->i' and 'i->SINK' with corresponding weights.
 	// Can be called multiple times for each node.
 	// Weights can be negative.
@@ -98,7 +141,9 @@ public:
 	void add_tweights(index_t i, real_t cap_source, real_t cap_sink);
 
 	// Computes the maxflow. Can be called several times.
-	void maxflow(index_t comp_size = 0, const index_t *comp_nodes = nullptr);
+    // The engine selects the algorithm; MAXFLOW_AUTO falls back to BK.
+	void maxflow(index_t comp_size = 0, const index_t *comp_nodes = nullptr,
+        Maxflow_engine engine = MAXFLOW_BK);
 
 private:
 
@@ -186,6 +231,40 @@ private:
 	void process_source_orphan(node *i);
 	void process_sink_orphan(node *i);
 
+    /* Boykov & Kolmogorov, incremental breadth-first search, push-relabel */
+    void maxflow_bk(index_t comp_size, const index_t *comp_nodes);
+    void maxflow_ibfs(index_t comp_size, const index_t *comp_nodes);
+    void maxflow_push_relabel(index_t comp_size, const index_t *comp_nodes);
+
+    /* incremental breadth-first search: the nodes to scan in each tree
+     * (indexed by is_sink) are listed in buckets by distance labels, up to
+     * the current layer, plus the next layer being built; orphans are
+     * adopted by increasing labels, using buckets of the adoption list */
+    nodeptr **scan_bucket[2];
+    index_t scan_bucket_size[2];
+    index_t scan_first[2]; // lowest label possibly listed
+    index_t scan_num[2], next_num[2]; // listed up to, beyond current layer
+    index_t layer_dist[2]; // label of the current layer of each tree
+    int growing; // tree currently grown, -1 if none
+    nodeptr **orphan_bucket;
+    index_t orphan_bucket_size, orphan_bucket_first, orphan_bucket_last;
+    /* list i for scanning in its tree, after its label */
+    void set_layer(node *i);
+    void set_orphan_bucket(node *i);
+    void process_ibfs_orphan(node *i);
+
+    /* push-relabel: distance labels stored in DIST, current arcs in parent,
+     * and buckets of active nodes linked through next; nodes are also
+     * gathered in doubly linked lists by labels, using their positions in the
+     * component stored in TS; global relabeling computes exact labels with a
+     * breadth-first search from the sink */
+    node **active_bucket;
+    index_t *label_first, *label_next, *label_prev;
+    void set_label(node *i, index_t d);
+    void unset_label(node *i);
+    void global_relabel(index_t comp_size, const index_t *comp_nodes,
+        node **queue, index_t &highest, index_t &max_label);
+
     bool is_parallel_copy; // flag a private copy in a parallel thread
 };
 
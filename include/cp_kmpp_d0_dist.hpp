@@ -44,7 +44,7 @@ public:
 
     /* only creates BK graph structure and assign Y, D */
     Cp_d0_dist(index_t V, index_t E, const index_t* first_edge,
-        const index_t* adj_vertices, const real_t* Y, size_t D = 1);
+        Adj_vertices<index_t> adj_vertices, const real_t* Y, size_t D = 1);
 
     /* the destructor does not free pointers which are supposed to be provided 
      * by the user (forward-star graph structure given at construction, 
@@ -66,11 +66,17 @@ public:
         const real_t* coor_weights = nullptr)
     { set_loss(loss, nullptr, vert_weights, coor_weights); }
 
+    /* observations quantized over 8 or 16 bits, see quantized_array.hpp;
+     * replace the ones given at construction or to set_loss(), and
+     * conversely */
+    void set_quantized_observations(Quantized_array<real_t> Y);
+
     void set_kmpp_param(int kmpp_init_num = 3, int kmpp_iter_num = 3);
 
 private:
     /**  separable loss term: weighted square l2 or smoothed KL **/
     const real_t* Y; // observations, D-by-V array, column major format
+    Quantized_array<real_t> quantized_Y; // used if Y is null
 
     /* 1 for quadratic (macro QUADRATIC)
      *      f(x) = 1/2 ||y - x||_{l2,W}^2 ,
@@ -101,8 +107,10 @@ private:
     const real_t *vert_weights, *coor_weights;
 
     /* compute the functional f at a single vertex */
-    /* NOTA: not actually a metric, in spite of its name */
-    real_t distance(const real_t* Xv, const real_t* Yv);
+    /* NOTA: not actually a metric, in spite of its name; arguments are
+     * arrays of real_t or quantized arrays */
+    template <typename Y_t, typename X_t>
+    real_t distance(const Y_t& Yv, const X_t& Xv);
     real_t fv(index_t v, const real_t* Xv) override;
     /* override for storing values (used for iterate evolution) */
     real_t compute_f() override;
@@ -123,10 +131,10 @@ private:
 
     real_t component_average(comp_t rv, real_t* avgXv);
 
-    void init_split_values(comp_t rv, real_t* altX, comp_t* label_assign)
-        override; // k-means ++
-    void update_split_values(comp_t rv, real_t* altX, comp_t* label_assign)
-        override; // weighted average
+    void init_split_values(index_t comp_size, const index_t* comp_vertices,
+        real_t* altX, comp_t* label_assign) override; // k-means ++
+    void update_split_values(index_t comp_size, const index_t* comp_vertices,
+        real_t* altX, comp_t* label_assign) override; // weighted average
     bool is_split_value(real_t altX) override; // flag with infinity
 
     /**  merging components **/
@@ -167,7 +175,7 @@ private:
     using Cp<real_t, index_t, comp_t>::V;
     using Cp<real_t, index_t, comp_t>::E;
     using Cp<real_t, index_t, comp_t>::first_edge;
-    using Cp<real_t, index_t, comp_t>::adj_vertices; 
+    using Cp<real_t, index_t, comp_t>::adj_vertex;
     using Cp<real_t, index_t, comp_t>::edge_weights;
     using Cp<real_t, index_t, comp_t>::homo_edge_weight;
     using Cp<real_t, index_t, comp_t>::rV;
@@ -184,7 +192,8 @@ private:
 #define TPL template <typename real_t, typename index_t, typename comp_t>
 #define CP_D0_DIST Cp_d0_dist<real_t, index_t, comp_t>
 
-TPL inline real_t CP_D0_DIST::distance(const real_t* Yv, const real_t* Xv)
+TPL template <typename Y_t, typename X_t>
+inline real_t CP_D0_DIST::distance(const Y_t& Yv, const X_t& Xv)
 {
     real_t dist = 0.0;
     if (loss == QUADRATIC){
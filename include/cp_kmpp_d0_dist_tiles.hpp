@@ -0,0 +1,163 @@
+/*=============================================================================
+ * Out-of-core cut-pursuit with separable distance and contour length, by
+ * tiles stitched together
+ *
+ * The graph is covered by tiles, each made of a core and of a halo: the cores
+ * partition the vertices of the graph, and the halo of a tile is made of
+ * vertices of other cores; typically, the tiles of a point cloud are spatial
+ * blocks, and their halos are the neighbors of their points in other blocks.
+ *
+ * Tiles are loaded in turn, each one being solved by its own Cp_d0_dist while
+ * the next one is loaded in the background; the halo gives some context to
+ * the vertices near the boundary of the core, but only the components over
+ * the core are kept.
+ *
+ * Components crossing the seams between tiles are then reconciled by the
+ * merge step of Cp_d0_dist, over the graph whose vertices are the components
+ * of all tiles, and whose edges are the edges of the main graph between
+ * them, within and across tiles; since the loss over a component depends
+ * only on its total weight and on its weighted mean observation, the merge
+ * gains are those of the problem over the main graph.
+ *
+ * The memory is bounded by the size of two tiles, of the components, and of
+ * the edges between them.
+ *
+ * The halo of each tile must contain all vertices adjacent to its core, and
+ * the graph of the tile must contain all edges involving its core vertices,
+ * so that each edge between two cores appears in the graphs of both tiles.
+ *
+ * Usage: derive a class implementing load_tile() and store_tile(), set the
+ * parameters, call solve(), and relabel the stored components with
+ * get_components().
+ *===========================================================================*/
+#pragma once
+#include <cstdint>
+#include "cp_kmpp_d0_dist.hpp"
+
+/* real_t is the real numeric type, index_t and comp_t are the integer types
+ * of the cut-pursuit over each tile, see cp_kmpp_d0_dist.hpp; they must also
+ * be able to represent the number of components and of edges between
+ * components over the whole graph, for the final merge */
+template <typename real_t, typename index_t, typename comp_t>
+class Cp_d0_dist_tiles
+{
+public:
+    /* a tile, given by load_tile(); vertices are numbered locally, core
+     * vertices first; arrays must be allocated with malloc() and the likes,
+     * and are free()'d once the tile is solved */
+    struct Tile
+    {
+        index_t V, E; // numbers of vertices and of edges of the tile graph
+        index_t core_V; // core vertices are 0, ..., core_V - 1
+        /* forward-star representation, see cut_pursuit.hpp */
+        index_t *first_edge, *adj_vertices;
+        real_t *Y; // observations, D-by-V array, column major format
+        /* weights of the vertices and of the edges, null for homogeneous
+         * weights, see set_loss() and set_edge_weights() */
+        real_t *vert_weights, *edge_weights;
+        uint64_t *global_index; // identifier of each vertex in the graph
+
+        Tile();
+    };
+
+    /**  constructor, destructor  **/
+
+    Cp_d0_dist_tiles(size_t tile_num, size_t D = 1);
+
+    /* free the components and values retrieved by get_components(), unless
+     * set to null beforehand */
+    virtual ~Cp_d0_dist_tiles();
+
+    /**  methods for manipulating parameters  **/
+
+    /* see Cp_d0_dist::set_loss(); vertex weights are given by the tiles */
+    void set_loss(real_t loss, const real_t* coor_weights = nullptr);
+
+    /* used for tiles without edge weights */
+    void set_edge_weights(real_t homo_edge_weight = 1.0);
+
+    void set_verbose(bool verbose = true);
+
+    /**  solve the main problem  **/
+
+    /* returns the number of components after stitching */
+    uint64_t solve();
+
+    /* components are numbered over all tiles in the order of the calls to
+     * store_tile(); 'stitched' gives for each of them its final component,
+     * array of length the number of components stored; 'values' gives the
+     * value of each final component, D-by-rV array; returns the number of
+     * components stored, rV being returned by solve() */
+    uint64_t get_components(uint64_t** stitched = nullptr,
+        real_t** values = nullptr);
+
+protected:
+    const size_t tile_num, D; // number of tiles, dimension of observations
+
+    /* load the t-th tile; called on a separate thread, concurrently with the
+     * solving of the previous tile and with store_tile() */
+    virtual void load_tile(size_t t, Tile& tile) = 0;
+
+    /* store the results over the core of the t-th tile; 'comp' gives the
+     * component of each core vertex, numbered over all tiles before
+     * stitching, see get_components() */
+    virtual void store_tile(size_t t, const Tile& tile,
+        const uint64_t* comp) = 0;
+
+    /* set the parameters of the cut-pursuit of each tile, e.g. with
+     * set_cp_param() or set_split_param(); loss and weights are already
+     * set, see set_loss() and set_edge_weights() */
+    virtual void configure(Cp_d0_dist<real_t, index_t, comp_t>& /* cp */){}
+
+private:
+    real_t loss;
+    const real_t* coor_weights;
+    real_t homo_edge_weight;
+    bool verbose;
+
+    /**  components over all tiles, before stitching  **/
+    uint64_t comp_num, comp_cap; // number of components, reserved size
+    real_t *comp_weights, *comp_sums; // total weight and weighted sums of Y
+
+    /* edges of the main graph between components; for edges across seams,
+     * the component of the end in the halo is not known until the tile of
+     * which it is in the core is solved, and 'v' is first the identifier of
+     * this vertex */
+    struct Comp_edge
+    {
+        uint64_t u, v;
+        real_t weight;
+        bool seam;
+    };
+    uint64_t edge_num, edge_cap;
+    Comp_edge* comp_edges;
+
+    /* components of the core vertices adjacent to a halo, for retrieving the
+     * ends of edges across seams */
+    struct Seam_vertex
+    {
+        uint64_t vertex, comp;
+    };
+    uint64_t seam_num, seam_cap;
+    Seam_vertex* seam_vertices;
+
+    /**  results  **/
+    uint64_t rV;
+    uint64_t* stitched;
+    real_t* values;
+
+    /* solve one tile and record its components and edges between them */
+    void solve_tile(size_t t, Tile& tile);
+
+    /* merge components across seams */
+    void stitch();
+
+    static void free_tile(Tile& tile);
+
+    /* capacity for at least 'num' elements, growing geometrically */
+    static uint64_t grow(uint64_t cap, uint64_t num)
+    { return cap + cap/2 > num ? cap + cap/2 : num; }
+
+    /* reallocate memory and fail with error message if not successful */
+    static void* realloc_check(void* ptr, size_t size);
+};
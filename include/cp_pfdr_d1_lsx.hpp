@@ -51,7 +51,7 @@ public:
 
     /* only creates BK graph structure and assign Y, D */
     Cp_d1_lsx(index_t V, index_t E, const index_t* first_edge,
-        const index_t* adj_vertices, size_t D, const real_t* Y);
+        Adj_vertices<index_t> adj_vertices, size_t D, const real_t* Y);
 
     /* the destructor does not free pointers which are supposed to be provided 
      * by the user (forward-star graph structure given at construction, 
@@ -70,6 +70,11 @@ public:
     void set_loss(const real_t* loss_weights)
     { set_loss(loss, nullptr, loss_weights); }
 
+    /* observations quantized over 8 or 16 bits, see quantized_array.hpp;
+     * replace the ones given at construction or to set_loss(), and
+     * conversely */
+    void set_quantized_observations(Quantized_array<real_t> Y);
+
     void set_pfdr_param(real_t rho, real_t cond_min, real_t dif_rcd,
         int it_max, real_t dif_tol);
 
@@ -78,12 +83,20 @@ public:
         real_t dif_rcd = 0.0, int it_max = 1e4)
     { set_pfdr_param(rho, cond_min, dif_rcd, it_max, 1e-3*dif_tol); }
 
+    /* mixed precision for the reduced problem, only relevant if real_t is
+     * double: the preconditioned forward-Douglas-Rachford algorithm first
+     * iterates in single precision, halving memory traffic, and its solution
+     * is then refined in double precision with at most 'refine_it_max'
+     * iterations */
+    void set_pfdr_mixed_precision(bool mixed = true, int refine_it_max = 100);
+
 private:
     /**  separable loss term  **/
 
     /* observations, D-by-V array, column major format;
      * must lie on the simplex */
     const real_t* Y; 
+    Quantized_array<real_t> quantized_Y; // used if Y is null
 
     /* 0 for linear (macro LINEAR)
      *     f(x) = - <x, y>_w ,
@@ -115,12 +128,46 @@ private:
     /**  reduced problem  **/
     real_t pfdr_rho, pfdr_cond_min, pfdr_dif_rcd, pfdr_dif_tol;
     int pfdr_it, pfdr_it_max;
+    bool pfdr_mixed;
+    int pfdr_refine_it_max;
 
     /**  methods  **/
 
     /* compute reduced values */
     void solve_reduced_problem() override;
 
+    /* solve with preconditioned forward-Douglas-Rachford the reduced problem
+     * on the given reduced graph, with reduced observations and loss
+     * weights; return the number of iterations */
+    int solve_reduced_pfdr(comp_t rV, size_t rE, const comp_t* reduced_edges,
+        const real_t* reduced_edge_weights, const real_t* rY,
+        const real_t* reduced_loss_weights, real_t* rX, int verbose);
+
+    /* same with diagonally preconditioned primal-dual algorithm */
+    int solve_reduced_pd(comp_t rV, size_t rE, const comp_t* reduced_edges,
+        const real_t* reduced_edge_weights, const real_t* rY,
+        const real_t* reduced_loss_weights, real_t* rX, int verbose);
+
+    /* same with the algorithm selected by use_primal_dual() */
+    int solve_reduced_iterative(comp_t rV, size_t rE,
+        const comp_t* reduced_edges, const real_t* reduced_edge_weights,
+        const real_t* rY, const real_t* reduced_loss_weights, real_t* rX,
+        int verbose);
+
+    /* solve the reduced problem on a connected component of the reduced
+     * graph, see compute_reduced_components(); return the number of
+     * iterations */
+    int solve_reduced_component(comp_t rcomp_size,
+        const comp_t* rcomp_vertices, size_t rcomp_E,
+        const comp_t* rcomp_edges, const real_t* rcomp_edge_weights,
+        const real_t* rY, const real_t* reduced_loss_weights);
+
+    /* gradient at the current iterate of the loss and of the total
+     * variation along active edges; D-by-V array; if 'skip_saturated' is
+     * true, it is only computed at the vertices of components which are not
+     * saturated, other values being left undefined */
+    void compute_gradient(real_t* grad, bool skip_saturated = false);
+
     index_t split() override;
 
     /* relative iterate evolution in l1 norm and components saturation */
@@ -128,32 +175,71 @@ private:
 
     real_t compute_objective() override;
 
+    /* duality gap, see Cp_d1::set_gap_tol(); linear and quadratic losses
+     * are taken into account exactly, while the smoothed Kullback-Leibler
+     * loss is linearized, which is valid since the simplex is bounded; the
+     * multiplier of the simplex constraint is fixed at each vertex, so that
+     * the certificate can be loose where neighboring components share some
+     * coordinate values; it would then prevent most saturations, so that
+     * the components are flagged by their contributions only when the gap
+     * is within ten times 'gap_tol', and by the evolution of their values
+     * otherwise, see compute_evolution() */
+    real_t certify() override;
+
     /**  type resolution for base template class members  **/
     using Cp_d1<real_t, index_t, comp_t>::D11;
     using Cp_d1<real_t, index_t, comp_t>::coor_weights;
     using Cp_d1<real_t, index_t, comp_t>::compute_graph_d1;
+    using Cp_d1<real_t, index_t, comp_t>::convert_array;
+    using Cp_d1<real_t, index_t, comp_t>::gather_array;
+    using Cp_d1<real_t, index_t, comp_t>::independent_reduced_solves;
+    using Cp_d1<real_t, index_t, comp_t>::compute_reduced_components;
+    using Cp_d1<real_t, index_t, comp_t>::large_reduced_component_size;
+    using Cp_d1<real_t, index_t, comp_t>::pd_dual_scale;
+    using Cp_d1<real_t, index_t, comp_t>::use_primal_dual;
+    using Cp_d1<real_t, index_t, comp_t>::compute_dual_flows;
+    using Cp_d1<real_t, index_t, comp_t>::certify_components;
+    using Cp_d1<real_t, index_t, comp_t>::dual_flows;
+    using Cp_d1<real_t, index_t, comp_t>::certified_grad;
+    using Cp_d1<real_t, index_t, comp_t>::schedule_reduced;
+    using Cp_d1<real_t, index_t, comp_t>::reduced_decrease;
+    using Cp_d1<real_t, index_t, comp_t>::reduced_dif_tol;
+    using Cp_d1<real_t, index_t, comp_t>::reduced_it_max;
+    using Cp_d1<real_t, index_t, comp_t>::is_tied;
     using Cp<real_t, index_t, comp_t>::D;
     using Cp<real_t, index_t, comp_t>::rX;
     using Cp<real_t, index_t, comp_t>::last_rX;
     using Cp<real_t, index_t, comp_t>::saturation_count;
     using Cp<real_t, index_t, comp_t>::monitor_evolution;
+    using Cp<real_t, index_t, comp_t>::gap_tol;
     using Cp<real_t, index_t, comp_t>::is_active;
     using Cp<real_t, index_t, comp_t>::set_active;
     using Cp<real_t, index_t, comp_t>::is_sink;
     using Cp<real_t, index_t, comp_t>::is_saturated;
+    using Cp<real_t, index_t, comp_t>::is_cancelled;
+    using Cp<real_t, index_t, comp_t>::get_cancel_flag;
     using Cp<real_t, index_t, comp_t>::set_saturation;
+    using Cp<real_t, index_t, comp_t>::list_unsaturated_vertices;
+    using Cp<real_t, index_t, comp_t>::get_tmp_comp_list;
+    using Cp<real_t, index_t, comp_t>::incident_edges;
     using Cp<real_t, index_t, comp_t>::set_edge_capacities;
     using Cp<real_t, index_t, comp_t>::set_term_capacities;
     using Cp<real_t, index_t, comp_t>::add_term_capacities;
     using Cp<real_t, index_t, comp_t>::get_tmp_comp_assign;
+    using typename Cp<real_t, index_t, comp_t>::Flow_graph;
     using Cp<real_t, index_t, comp_t>::get_parallel_flow_graph;
+    using Cp<real_t, index_t, comp_t>::get_maxflow_engine;
+    using Cp<real_t, index_t, comp_t>::compute_maxflow;
+    using Cp<real_t, index_t, comp_t>::get_task_num;
+    using Cp<real_t, index_t, comp_t>::component_tasks;
     using Cp<real_t, index_t, comp_t>::eps;
     using Cp<real_t, index_t, comp_t>::V;
     using Cp<real_t, index_t, comp_t>::E;
     using Cp<real_t, index_t, comp_t>::first_edge;
-    using Cp<real_t, index_t, comp_t>::adj_vertices; 
+    using Cp<real_t, index_t, comp_t>::adj_vertex;
     using Cp<real_t, index_t, comp_t>::edge_weights;
     using Cp<real_t, index_t, comp_t>::homo_edge_weight;
+    using Cp<real_t, index_t, comp_t>::quantized_edge_weights;
     using Cp<real_t, index_t, comp_t>::rV;
     using Cp<real_t, index_t, comp_t>::rE;
     using Cp<real_t, index_t, comp_t>::comp_assign;
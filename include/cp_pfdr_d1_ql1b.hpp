@@ -56,13 +56,14 @@ class Cp_d1_ql1b : public Cp_d1<real_t, index_t, comp_t>
 private:
     /**  type resolution for base template class members  **/
     using Cp<real_t, index_t, comp_t>::dif_tol;
+    using Cp<real_t, index_t, comp_t>::gap_tol;
 
 public:
     /**  constructor, destructor  **/
 
     /* only creates BK graph structure and assign Y, A, N */
     Cp_d1_ql1b(index_t V, index_t E, const index_t* first_edge,
-        const index_t* adj_vertices);
+        Adj_vertices<index_t> adj_vertices);
 
     /* the destructor does not free pointers which are supposed to be provided 
      * by the user (forward-star graph structure given at construction, 
@@ -79,6 +80,25 @@ public:
     void set_quadratic(const real_t* Y, size_t N = DIAG_ATA,
         const real_t* A = nullptr, real_t a = 1.0);
 
+    /* compress a tall matrix given in direct form (positive N) to
+     * set_quadratic(), so that the cost of each iteration does not depend on
+     * the number of observations anymore; must be called before
+     * cut_pursuit(), and again after each call to set_quadratic();
+     * if sketch_size is zero, (A^t A) and (A^t Y) are precomputed, and the
+     * problem is solved in this form (N set to FULL_ATA), the objective values
+     * being unchanged; this requires a V-by-V array;
+     * otherwise, A and Y are replaced by S A and S Y, where S is a random
+     * sketch_size-by-N count-sketch matrix, adding each row of A with a random
+     * sign to a random row of S A; the quadratic part becomes
+     * 1/2 ||S (y - A x)||^2, an approximation of the original one;
+     * the distortion is estimated as the relative error of the sketched
+     * gradient ||(S A)^t S r - A^t r||/||A^t r|| over a few probe residuals
+     * r = y - A x, with x zero and random; if dist_tol is
+     * positive, the sketch size is doubled until the estimate falls below
+     * dist_tol, and the matrix is left uncompressed if it reaches N;
+     * returns the estimated distortion, zero if uncompressed or precomputed */
+    real_t compress_quadratic(size_t sketch_size = 0, real_t dist_tol = 0.0);
+
     /* set l1_weights null for homogeneously equal to homo_l1_weight */
     void set_l1(const real_t* l1_weights = nullptr,
         real_t homo_l1_weight = 0.0, const real_t* Yl1 = nullptr);
@@ -88,6 +108,15 @@ public:
         const real_t* low_bnd = nullptr, real_t homo_low_bnd = -INF_REAL,
         const real_t* upp_bnd = nullptr, real_t homo_upp_bnd = INF_REAL);
 
+    /* duality gap certificates, see Cp_d1::set_gap_tol(); on each vertex,
+     * either the diagonal of A^t A must be positive, or both bounds must be
+     * finite: otherwise the quadratic part is linearized, and the gap is
+     * infinite as soon as this linearization is unbounded below on some
+     * vertex; a positive tolerance is then rejected, here as well as by
+     * later calls to set_quadratic(), compress_quadratic() or set_bounds();
+     * thus with a nondiagonal A^t A, certificates require finite bounds */
+    void set_gap_tol(real_t gap_tol = 0.0);
+
     void set_pfdr_param(real_t rho, real_t cond_min, real_t dif_rcd,
         int it_max, real_t dif_tol);
 
@@ -96,6 +125,37 @@ public:
         real_t dif_rcd = 0.0, int it_max = 1e4)
     { set_pfdr_param(rho, cond_min, dif_rcd, it_max, 1e-3*dif_tol); }
 
+    /* mixed precision for the reduced problem, only relevant if real_t is
+     * double: the preconditioned forward-Douglas-Rachford algorithm first
+     * iterates in single precision, halving memory traffic, and its solution
+     * is then refined in double precision with at most 'refine_it_max'
+     * iterations;
+     * the single precision phase stops at relative evolutions of about 1e-5,
+     * and with ill-conditioned matrices the rounding of the reduced problem
+     * can move its solution further away; the final accuracy is that of
+     * double precision only if the refinement converges within
+     * 'refine_it_max' iterations, otherwise it can remain close to that of
+     * single precision; with a matrix in direct form (positive N), a single
+     * precision copy of the observations Y is kept along the run */
+    void set_pfdr_mixed_precision(bool mixed = true, int refine_it_max = 100);
+
+    /* reduced problems with at most 'max_size' reduced vertices and with
+     * precomputed A^t A, either given or premultiplied for the reduced
+     * problem, are solved with a semismooth Newton augmented Lagrangian
+     * method, see ssnal_d1_ql1b.hpp, which reaches the precision of a direct
+     * solver within a few Newton iterations, each factorizing a dense matrix;
+     * 'dif_tol' and 'it_max' are its stopping criterion and maximum number of
+     * Newton iterations, after which the problem is solved again with the
+     * algorithm selected by set_reduced_solver(); set 'max_size' to zero for
+     * always using the latter;
+     * with a matrix in direct form (positive N), the reduced problem is
+     * premultiplied only when worth it for the iterative algorithm, unless
+     * 'direct' is true, in which case small enough reduced problems are
+     * always premultiplied for the exact method; by default, this is thus
+     * used automatically only when the main problem has precomputed A^t A */
+    void set_exact_reduced(comp_t max_size = 200, real_t dif_tol = 1e-10,
+        int it_max = 100, bool direct = false);
+
 private:
 
     /**  main problem  **/
@@ -124,6 +184,14 @@ private:
 
     real_t *R; // residual, array of length N, used only if N is positive
 
+    /* matrix and observations computed by compress_quadratic(), replacing
+     * the ones given to set_quadratic(); freed by the destructor */
+    real_t *compressed_A, *compressed_Y;
+
+    /* constant 1/2||Y||^2 of the quadratic part, when known in the
+     * precomputed A^t A version, see compress_quadratic() */
+    real_t quadratic_offset;
+
     /* regularizations */
 
     /* observations for l1 fidelity, array of length V, set to null for zero */
@@ -148,26 +216,126 @@ private:
     /**  reduced problem  **/
     real_t pfdr_rho, pfdr_cond_min, pfdr_dif_rcd, pfdr_dif_tol;
     int pfdr_it, pfdr_it_max;
+    bool pfdr_mixed;
+    int pfdr_refine_it_max;
+    /* single precision copies of the observations and of the reduced matrix
+     * in direct form, for mixed precision; the former is kept along the
+     * run, the latter is built along with the reduced matrix */
+    float *mixed_Y, *mixed_rA;
+    comp_t exact_max_size;
+    real_t exact_dif_tol;
+    int exact_it_max;
+    bool exact_direct;
 
     /**  methods  **/
 
+    /* the two forms of compress_quadratic() */
+    void precompute_gram();
+    real_t compute_sketch(size_t sketch_size, real_t dist_tol);
+
+    /* replace A and Y by the given compressed ones, for N observations */
+    void set_compressed(real_t* cA, real_t* cY, size_t N);
+
     /* compute reduced values;
      * NOTA: if Yl1 is not constant, this actually solves only an approximation
      * of the reduced problem, replacing the weighted sum of distances to Yl1
      * by the distance to the weighted median of Yl1 */
     void solve_reduced_problem() override;
 
+    /* solution of the reduced problem restricted to a single reduced vertex,
+     * given its aggregated parameters */
+    static real_t solve_reduced_vertex(real_t rY, real_t rAA,
+        real_t rl1_weight, real_t rYl1, real_t rlow_bnd, real_t rupp_bnd);
+
+    /* solve with preconditioned forward-Douglas-Rachford the reduced problem
+     * on the given reduced graph, with reduced parameters; 'rN' conveys the
+     * shape of the matricial information as N does, see set_quadratic();
+     * return the number of iterations */
+    int solve_reduced_pfdr(comp_t rV, size_t rE, const comp_t* reduced_edges,
+        const real_t* reduced_edge_weights, size_t rN, const real_t* rY,
+        const real_t* rAA, const real_t* rA, const real_t* rl1_weights,
+        const real_t* rYl1, const real_t* rlow_bnd, const real_t* rupp_bnd,
+        real_t* rX, int verbose);
+
+    /* same with diagonally preconditioned primal-dual algorithm */
+    int solve_reduced_pd(comp_t rV, size_t rE, const comp_t* reduced_edges,
+        const real_t* reduced_edge_weights, size_t rN, const real_t* rY,
+        const real_t* rAA, const real_t* rA, const real_t* rl1_weights,
+        const real_t* rYl1, const real_t* rlow_bnd, const real_t* rupp_bnd,
+        real_t* rX, int verbose);
+
+    /* same with semismooth Newton augmented Lagrangian method, only for
+     * precomputed A^t A; return -1 if the stopping criterion is not met */
+    int solve_reduced_exact(comp_t rV, size_t rE, const comp_t* reduced_edges,
+        const real_t* reduced_edge_weights, size_t rN, const real_t* rY,
+        const real_t* rAA, const real_t* rl1_weights, const real_t* rYl1,
+        const real_t* rlow_bnd, const real_t* rupp_bnd, real_t* rX,
+        int verbose);
+
+    /* same with the exact method if small enough, see set_exact_reduced(),
+     * and otherwise with the algorithm selected by use_primal_dual() */
+    int solve_reduced_iterative(comp_t rV, size_t rE,
+        const comp_t* reduced_edges, const real_t* reduced_edge_weights,
+        size_t rN, const real_t* rY, const real_t* rAA, const real_t* rA,
+        const real_t* rl1_weights, const real_t* rYl1, const real_t* rlow_bnd,
+        const real_t* rupp_bnd, real_t* rX, int verbose);
+
+    /* solve the reduced problem on a connected component of the reduced
+     * graph, see compute_reduced_components(); only valid if A^t A is
+     * diagonal; return the number of iterations */
+    int solve_reduced_component(comp_t rcomp_size,
+        const comp_t* rcomp_vertices, size_t rcomp_E,
+        const comp_t* rcomp_edges, const real_t* rcomp_edge_weights,
+        const real_t* rY, const real_t* rAA, const real_t* rl1_weights,
+        const real_t* rYl1, const real_t* rlow_bnd, const real_t* rupp_bnd);
+
+    /* gradient at the current iterate of the quadratic part, of the total
+     * variation along active edges, and of the l1 norm where it is
+     * differentiable; array of length V; if 'skip_saturated' is true, it is
+     * only computed at the vertices of components which are not saturated,
+     * other values being left undefined */
+    void compute_gradient(real_t* grad, bool skip_saturated = false);
+
     index_t split() override;
 
     /* relative iterate evolution in l2 norm and components saturation */
     real_t compute_evolution(bool compute_dif) override;
 
     /* in the precomputed A^t A version, a constant 1/2||Y||^2 in the quadratic
-     * part is omited */
+     * part is omited, unless precomputed by compress_quadratic() */
     real_t compute_objective() override;
 
+    /* duality gap, see set_gap_tol(); the quadratic part is taken into
+     * account exactly if A^t A is diagonal, otherwise it is linearized */
+    real_t certify() override;
+
+    /* exit with an error if certificates are required but might be
+     * infinite, see set_gap_tol() */
+    void check_gap_certificates();
+
+    /* contribution of a vertex to the duality gap, which is the gap
+     * phi(x) - min phi, for phi(z) = alpha/2 z^2 - p z + l1_weight |z - yl1|
+     * over [low_bnd, upp_bnd] */
+    static real_t vertex_gap(real_t x, real_t alpha, real_t p,
+        real_t l1_weight, real_t yl1, real_t low_bnd, real_t upp_bnd);
+
     /**  type resolution for base template class members  **/
     using Cp_d1<real_t, index_t, comp_t>::compute_graph_d1;
+    using Cp_d1<real_t, index_t, comp_t>::convert_array;
+    using Cp_d1<real_t, index_t, comp_t>::gather_array;
+    using Cp_d1<real_t, index_t, comp_t>::independent_reduced_solves;
+    using Cp_d1<real_t, index_t, comp_t>::compute_reduced_components;
+    using Cp_d1<real_t, index_t, comp_t>::large_reduced_component_size;
+    using Cp_d1<real_t, index_t, comp_t>::pd_dual_scale;
+    using Cp_d1<real_t, index_t, comp_t>::use_primal_dual;
+    using Cp_d1<real_t, index_t, comp_t>::compute_dual_flows;
+    using Cp_d1<real_t, index_t, comp_t>::certify_components;
+    using Cp_d1<real_t, index_t, comp_t>::dual_flows;
+    using Cp_d1<real_t, index_t, comp_t>::certified_grad;
+    using Cp_d1<real_t, index_t, comp_t>::schedule_reduced;
+    using Cp_d1<real_t, index_t, comp_t>::reduced_decrease;
+    using Cp_d1<real_t, index_t, comp_t>::reduced_dif_tol;
+    using Cp_d1<real_t, index_t, comp_t>::reduced_it_max;
     using Cp<real_t, index_t, comp_t>::rX;
     using Cp<real_t, index_t, comp_t>::last_rX;
     using Cp<real_t, index_t, comp_t>::saturation_count;
@@ -176,18 +344,29 @@ private:
     using Cp<real_t, index_t, comp_t>::set_active;
     using Cp<real_t, index_t, comp_t>::is_sink;
     using Cp<real_t, index_t, comp_t>::is_saturated;
+    using Cp<real_t, index_t, comp_t>::is_cancelled;
+    using Cp<real_t, index_t, comp_t>::get_cancel_flag;
     using Cp<real_t, index_t, comp_t>::set_saturation;
+    using Cp<real_t, index_t, comp_t>::list_unsaturated_vertices;
+    using Cp<real_t, index_t, comp_t>::get_tmp_comp_list;
+    using Cp<real_t, index_t, comp_t>::incident_edges;
     using Cp<real_t, index_t, comp_t>::set_edge_capacities;
     using Cp<real_t, index_t, comp_t>::set_term_capacities;
     using Cp<real_t, index_t, comp_t>::add_term_capacities;
     using Cp<real_t, index_t, comp_t>::get_tmp_comp_assign;
+    using typename Cp<real_t, index_t, comp_t>::Flow_graph;
     using Cp<real_t, index_t, comp_t>::get_parallel_flow_graph;
+    using Cp<real_t, index_t, comp_t>::get_maxflow_engine;
+    using Cp<real_t, index_t, comp_t>::compute_maxflow;
+    using Cp<real_t, index_t, comp_t>::get_task_num;
+    using Cp<real_t, index_t, comp_t>::component_tasks;
     using Cp<real_t, index_t, comp_t>::V;
     using Cp<real_t, index_t, comp_t>::E;
     using Cp<real_t, index_t, comp_t>::first_edge;
-    using Cp<real_t, index_t, comp_t>::adj_vertices; 
+    using Cp<real_t, index_t, comp_t>::adj_vertex;
     using Cp<real_t, index_t, comp_t>::edge_weights;
     using Cp<real_t, index_t, comp_t>::homo_edge_weight;
+    using Cp<real_t, index_t, comp_t>::quantized_edge_weights;
     using Cp<real_t, index_t, comp_t>::rV;
     using Cp<real_t, index_t, comp_t>::rE;
     using Cp<real_t, index_t, comp_t>::comp_assign;
@@ -26,11 +26,15 @@
  * along with this program.  If not, see <https://www.gnu.org/licenses/>.
  *===========================================================================*/
 #pragma once
+#include <cstdint>
 #include <cstdlib>
+#include <atomic>
 #include <chrono>
 #include <limits>
 #include <iostream>
 #include "cp_graph.hpp" /* Boykov-Kolmogorov graph class modified for CP */
+#include "compressed_adjacency.hpp"
+#include "quantized_array.hpp"
 
 /* flag an activated edge on residual capacity of its corresponding arcs */
 #define ACTIVE_EDGE ((real_t) -1.0) 
@@ -40,8 +44,24 @@
 #define CHAIN_ROOT MAX_NUM_COMP
 #define CHAIN_LEAF MAX_NUM_COMP
 
+/* progress of a cut-pursuit run, shared with another thread which can also
+ * request its cancellation, see Cp::set_control() and cut_pursuit_async.hpp */
+struct Cp_control
+{
+    std::atomic<bool> cancel; // set to true for stopping as soon as possible
+    std::atomic<int> iteration; // number of completed iterations
+    std::atomic<uintmax_t> components; // current number of components
+    std::atomic<double> objective; // objective functional at that iteration
+
+    Cp_control() : cancel(false), iteration(0), components(0),
+        objective(std::numeric_limits<double>::quiet_NaN()){}
+};
+
 /* real_t is the real numeric type, used for objective functional computation
- * and thus for edge weights and flow graph capacities;
+ * and thus for edge weights and flow graph capacities; capacities only
+ * determine the cuts, for which single precision is usually enough: if
+ * CP_FLOW_SINGLE_PRECISION is defined at compilation, they are stored in
+ * single precision even if real_t is double, see flow_t below;
  * index_t must be able to represent the number of vertices and of (undirected)
  * edges in the main graph;
  * comp_t must be able to represent the number of constant connected components
@@ -56,9 +76,13 @@ class Cp
 public:
     /**  constructor, destructor  **/
 
-    /* only creates flow graph structure */
+    /* only creates flow graph structure; 'adj_vertices' can be given either
+     * as a plain array or as a compressed adjacency (see
+     * compressed_adjacency.hpp), which is decoded once into the flow graph;
+     * in both cases, it is not used anymore after construction, and can be
+     * deleted then */
     Cp(index_t V, index_t E, const index_t* first_edge, 
-        const index_t* adj_vertices, size_t D = 1);
+        Adj_vertices<index_t> adj_vertices, size_t D = 1);
 
     /* the destructor does not free pointers which are supposed to be provided 
      * by the user (forward-star graph structure given at construction, 
@@ -76,15 +100,30 @@ public:
     void set_edge_weights(const real_t* edge_weights = nullptr,
         real_t homo_edge_weight = 1.0);
 
+    /* edge weights quantized over 8 or 16 bits, see quantized_array.hpp;
+     * replace the ones set by set_edge_weights(), and conversely */
+    void set_quantized_edge_weights(Quantized_array<real_t> edge_weights);
+
     void set_monitoring_arrays(real_t* objective_values = nullptr,
         double* elapsed_time = nullptr, real_t* iterate_evolution = nullptr);
 
+    /* report progress in 'control' at each iteration (the objective
+     * functional is then computed even without monitoring array), and stop
+     * if cancellation is requested: remaining components are not split, the
+     * reduced problem is solved only up to the current iterate of its
+     * algorithm, and cut-pursuit returns at the end of the current iteration,
+     * with consistent components and values; see Cp_control above */
+    void set_control(Cp_control* control = nullptr);
+
     /* if rV is zero or unity, comp_assign will be automatically initialized;
      * if rV is zero, arbitrary components will be assigned at initialization,
-     * in an attempt to optimize parallelization along components;
+     * in an attempt to optimize parallelization along components; they are
+     * grown in parallel from spread seeds, and none of them can exceed their
+     * average size by a factor more than (1 + balance_tol);
      * if rV is greater than one, comp_assign must be given and initialized;
      * comp_assign is free()'d by destructor, unless set to null beforehand */
-    void set_components(comp_t rV = 0, comp_t* comp_assign = nullptr);
+    void set_components(comp_t rV = 0, comp_t* comp_assign = nullptr,
+        real_t balance_tol = 0.5);
 
     void set_cp_param(real_t dif_tol, int it_max, int verbose, real_t eps);
     /* overload for default eps parameter */
@@ -95,6 +134,24 @@ public:
             std::numeric_limits<real_t>::epsilon());
     }
 
+    /* maximum flow algorithm used for splitting components, see
+     * cp_graph.hpp; the Boykov & Kolmogorov algorithm is the default, and
+     * with MAXFLOW_AUTO, it is used on components with less than
+     * 'auto_min_size' vertices, while larger components use the push-relabel
+     * algorithm if their average degree is at least 'auto_dense_degree',
+     * incremental breadth-first search if it is at least half of it, and
+     * the Boykov & Kolmogorov algorithm otherwise, which remains faster on
+     * sparse components such as grids;
+     * components with at least 'gather_min_size' vertices are copied into a
+     * compact local flow graph, with renumbered nodes and arcs stored
+     * consecutively, before computing the maximum flow; this costs one pass
+     * over the component but avoids scattered accesses to the main flow graph
+     * when the vertices of the component are spread across the whole graph;
+     * set to zero for never gathering */
+    void set_maxflow_param(Maxflow_engine maxflow_engine = MAXFLOW_BK,
+        index_t auto_min_size = 10000, real_t auto_dense_degree = 16.0,
+        index_t gather_min_size = 0);
+
     /* the 'get' methods takes pointers to pointers as arguments; a null means
      * that the user is not interested by the corresponding pointer; NOTA:
      * 1) if not explicitely set by the user, memory pointed by these members
@@ -116,26 +173,97 @@ public:
      * allocated with malloc() and the likes */
     void set_reduced_values(value_t* rX);
 
-    /* solve the main problem */
+    /**  dynamic graph updates  **/
+
+    /* append 'added_V' vertices to the graph, together with the edges
+     * originating from them; 'first_edge' is the forward-star array of the
+     * extended graph, of length V + added_V + 1, which must coincide with the
+     * current one over its first V + 1 values; 'adj_vertices' gives the
+     * ending vertices of the new edges only, that is of edges
+     * E, ..., first_edge[V + added_V] - 1; new edges can end at any vertex,
+     * see add_edges() for edges originating from current vertices;
+     * arrays of observations and weights must then be set again over the
+     * extended graph, with the corresponding methods of derived classes;
+     * if cut-pursuit has already run, the new vertices form new components,
+     * which are not saturated, as well as the components adjacent to them, so
+     * that calling cut_pursuit(false) updates the solution by processing
+     * only these components, see touch_vertices() below; otherwise, the new
+     * vertices are assigned to a new component if components are given,
+     * see set_components() */
+    void add_vertices(index_t added_V, const index_t* first_edge,
+        const index_t* adj_vertices);
+
+    /* insert new edges originating from current vertices; 'first_edge' is
+     * the forward-star array of the extended graph, of length V + 1, in
+     * which the current edges of each vertex come first, in their current
+     * order, followed by its new edges; 'adj_vertices' gives the ending
+     * vertices of all edges of the extended graph, but only the ones of new
+     * edges are read; edges are thus renumbered, and arrays of edge weights
+     * must then be set again; if cut-pursuit has already run, new edges
+     * between different components are active, and these components are not
+     * saturated anymore; new edges within a component do not change the
+     * solution, and its saturation is kept */
+    void add_edges(const index_t* first_edge, const index_t* adj_vertices);
+
+    /* remove the given edges; the numbering of edges is kept, so that
+     * arrays of edge weights remain valid, but the removed edges are
+     * detached from the flow graph and then link their starting vertex to
+     * itself (see adj_vertex()), so that they are ignored by cut-pursuit;
+     * if cut-pursuit has already run, the components at both ends are not
+     * saturated anymore, see touch_vertices() */
+    void remove_edges(index_t num, const index_t* edges);
+
+    /* remove all edges involving the given vertices, see remove_edges();
+     * the vertices themselves are kept, since they are still involved in
+     * the data term of derived classes, but if cut-pursuit has already run,
+     * each of them is isolated in a new component, unless no other vertex
+     * is left in its current component, so that it does not influence the
+     * values of other components in separable problems; for removing them
+     * from the objective altogether, set their observation weights to zero,
+     * when available in derived classes */
+    void remove_vertices(index_t num, const index_t* vertices);
+
+    /* flag the components of the given vertices as not saturated, so that
+     * the next call to cut_pursuit(false) processes them again; this must be
+     * done when their observations or weights are modified, or those of the
+     * edges involving them (for both ends), in which case the corresponding
+     * arrays must be set again */
+    void touch_vertices(index_t num, const index_t* vertices);
+
+    /* solve the main problem; if 'init' is false, start from the current
+     * components and values, after updating the reduced problem if the graph
+     * or the data changed, see add_vertices() and the following methods */
     int cut_pursuit(bool init = true);
 
 protected:
+    /* type of the flow graph capacities; capacities set with the methods
+     * below are converted with to_flow() */
+    #ifdef CP_FLOW_SINGLE_PRECISION
+    typedef float flow_t;
+    #else
+    typedef real_t flow_t;
+    #endif
+    typedef Cp_graph<flow_t, index_t, comp_t> Flow_graph;
+
     const size_t D; // dimension of the data; total size is V*D
     value_t *rX, *last_rX; // reduced iterate (values of the components)
     comp_t saturation_count; // number of saturated components
 
     /**  main graph  **/
 
-    const index_t V, E; // number of vertices, of edges
+    index_t V, E; // number of vertices, of edges, see add_vertices()
     /* forward-star representation:
      * - edges are numeroted so that all vertices originating from a same 
      * vertex are consecutive;
      * - for each vertex, 'first_edge' indicates the first edge starting
      * from the vertex (or, if there are none, starting from the next vertex);
      * array of length V+1, the last value is the total number of edges
-     * - for each edge, 'adj_vertices' indicates its ending vertex */
-    const index_t *first_edge, *adj_vertices; 
+     * - for each edge, 'adj_vertices' indicates its ending vertex; it is
+     * only given at construction, and then read from the flow graph, see
+     * adj_vertex() */
+    const index_t *first_edge; 
     const real_t *edge_weights;
+    Quantized_array<real_t> quantized_edge_weights; // used if set
     real_t homo_edge_weight;
 
     /**  reduced graph  **/
@@ -155,6 +283,9 @@ protected:
     /** parameters **/
 
     real_t dif_tol, eps; // eps gives a characteristic precision 
+    /* stop when the optimality certificate is below this value, see
+     * certify(); zero for not computing certificates */
+    real_t gap_tol;
     /* with nonzero verbose information on the process will be printed;
      * for convex methods, this will be passed on to the reduced problem
      * subroutine, controlling the number of subiterations between prints */
@@ -163,10 +294,31 @@ protected:
     /* for stopping criterion or component saturation */
     bool monitor_evolution;
 
+    real_t balance_tol; // for arbitrary components, see set_components()
+
+    /* maximum flow algorithm */
+    Maxflow_engine maxflow_engine;
+    index_t maxflow_auto_min_size;
+    real_t maxflow_auto_dense_degree;
+    index_t maxflow_gather_min_size;
+
     /**  methods for manipulating nodes and arcs in the flow graph  **/
 
     bool is_active(index_t e); // check if edge e is active
 
+    /* ending vertex of edge e, stored in the corresponding arc of the flow
+     * graph; this saves an array of length E, and the arc is often accessed
+     * anyway for checking activity or capacities; a removed edge ends at
+     * its starting vertex, see remove_edges() */
+    index_t adj_vertex(index_t e);
+
+    /* call 'body(e, w, forward)' for each edge e involving vertex v, where w
+     * is its other end and 'forward' tells whether e starts from v; edges
+     * are stored along one direction only in 'first_edge', but both arcs of
+     * an edge are linked to their ends in the flow graph */
+    template <typename Body>
+    void incident_edges(index_t v, Body body);
+
     void set_active(index_t e); // flag an active edge
 
     void set_inactive(index_t e); // flag an inactive edge
@@ -184,13 +336,33 @@ protected:
 
     bool is_saturated(comp_t rv); // check component's saturation
 
+    bool is_cancelled(); // check for cancellation request, see set_control()
+
+    /* for passing cancellation requests to reduced problem algorithms */
+    const std::atomic<bool>* get_cancel_flag()
+    { return control ? &control->cancel : nullptr; }
+
     /* NOTA: saturation is flagged on the first vertex of the component, so
      * this must be reset if the component list is modified or reordered */
     void set_saturation(comp_t rv, bool saturation);
 
+    /* list the vertices of the components which are not saturated, in the
+     * order of the components, into the temporary components list, see
+     * get_tmp_comp_list(); return their number; the list is overwritten by
+     * the next computation of connected components or of maximum flows */
+    index_t list_unsaturated_vertices();
+
+    /* convert a capacity to flow_t; finite values out of range saturate to
+     * the largest finite value, infinite values are preserved */
+    static flow_t to_flow(real_t cap);
+
     /* manipulate flow graph residual capacities */
     void set_edge_capacities(index_t e, real_t cap_uv, real_t cap_vu);
 
+    /* net flow along edge e, from its starting to its ending vertex, after a
+     * maximum flow computed with equal capacities in both directions */
+    real_t get_edge_flow(index_t e);
+
     void set_term_capacities(index_t v, real_t cap);
 
     void add_term_capacities(index_t v, real_t cap);
@@ -198,13 +370,65 @@ protected:
     /**  methods for cut-pursuit steps  **/
 
     /* get a parallel copy of the flow graph */
-    Cp_graph<real_t, index_t, comp_t>* get_parallel_flow_graph();
-
-    /* compute reduced values */
+    Flow_graph* get_parallel_flow_graph();
+
+    /* maximum flow algorithm for splitting the given component */
+    Maxflow_engine get_maxflow_engine(comp_t rv);
+
+    /* overload for a component given by its list of vertices */
+    Maxflow_engine get_maxflow_engine(index_t comp_size,
+        const index_t* comp_vertices);
+
+    /* when there are less components than threads in the current team, the
+     * threads left idle by a parallel loop over components can process the
+     * items (vertices, coordinates) of large components with concurrent
+     * tasks; number of such tasks for a component with 'item_num' items,
+     * given a rough number of operations per item; unity if not worth it */
+    index_t get_task_num(index_t item_num, uintmax_t ops_per_item = 1);
+
+    /* call 'body(first, last)' over consecutive ranges partitioning
+     * [0, item_num[, each in a separate task if 'task_num' is greater than
+     * unity; returns once all tasks are completed; 'body' must thus be safe
+     * to call concurrently on disjoint ranges */
+    template <typename Body>
+    void component_tasks(index_t task_num, index_t item_num, Body body);
+
+    /* find min cut over a component given by its list of vertices, closed
+     * under inactive edges, with capacities set in the main flow graph; the
+     * parallel copy 'Gpar' is used, unless the component is large enough to
+     * be gathered into a local flow graph, see set_maxflow_param(), or small
+     * enough to be cut by enumeration, see enumerate_min_cut(); in all cases,
+     * the cut can then be retrieved with is_sink() */
+    void compute_maxflow(Flow_graph* Gpar, index_t comp_size,
+        const index_t* comp_vertices, Maxflow_engine engine);
+
+    /* find min cut over a tiny component by evaluating all its 2^comp_size
+     * labelings; the cut is the same as the one given by maximum flow
+     * algorithms, see cp_graph.hpp */
+    void enumerate_min_cut(index_t comp_size, const index_t* comp_vertices);
+
+    /* reorder the given list of vertices, closed under inactive edges, so
+     * that the connected components that they form are consecutive; the
+     * number of such components is returned, and their first positions in
+     * the list are stored in 'first_local', allocated with malloc(), of
+     * length this number plus one; vertices are assigned to component 'rv'
+     * in 'comp_assign'; can be called in parallel on disjoint lists */
+    index_t compute_local_connected_components(comp_t rv, index_t comp_size,
+        index_t* comp_vertices, index_t*& first_local);
+
+    /* compute reduced values; the reduced problem can be solved only
+     * approximately, in which case 'approx_reduced' must be set, unless
+     * 'exact_reduced' is set; an approximate solution left at the end of the
+     * iterations is then computed again accurately, see cut_pursuit() */
     virtual void solve_reduced_problem() = 0;
+    bool exact_reduced, approx_reduced;
 
-    /* split components with graph cuts, by activating edges */
+    /* split components with graph cuts, by activating edges; 'first_split'
+     * is set for the first split of each call to cut_pursuit(), and
+     * 'last_activation' is the number of edges activated by the last one */
     virtual index_t split() = 0;
+    bool first_split;
+    index_t last_activation;
 
     /**  merging components when deemed useful  **/
 
@@ -222,6 +446,9 @@ protected:
      * component in the chain with lowest index */
     comp_t get_merge_chain_root(comp_t rv);
 
+    /* next component in the merge chain of rv, or CHAIN_LEAF */
+    comp_t get_merge_chain_next(comp_t rv);
+
     /* merge the merge chains of the two given roots;
      * the root of the resulting chain will be the component in the chains
      * with lowest index, and assigned to the parameter ru; the root of the
@@ -247,6 +474,15 @@ protected:
     /* compute objective functional, often on the reduced problem objects */
     virtual real_t compute_objective() = 0;
 
+    /* optimality certificate, computed at the end of each iteration if
+     * gap_tol is positive: upper bound on the difference between the
+     * objective functional and its minimum, sum of the contributions of each
+     * component; components whose contribution is certified small enough
+     * are flagged as saturated, the others as not saturated, and
+     * saturation_count is updated accordingly; by default, no certificate
+     * is available, and this returns infinity */
+    virtual real_t certify();
+
     /* allocate memory and fail with error message if not successful */
     static void* malloc_check(size_t size){
         void *ptr = malloc(size);
@@ -273,30 +509,44 @@ protected:
 
 private:
 
-    using arc = typename Cp_graph<real_t, index_t, comp_t>::arc;
+    using arc = typename Flow_graph::arc;
 
-    Cp_graph<real_t, index_t, comp_t>* G; // flow graph
+    Flow_graph* G; // flow graph
+
+    /* reduced problem must be computed again before resuming cut-pursuit,
+     * see add_vertices() and the following methods */
+    bool pending_update;
+
+    /* detach an edge from the flow graph, see remove_edges() */
+    void remove_edge(index_t e);
 
     /* monitoring */
     real_t *objective_values;
     double *elapsed_time;
     real_t *iterate_evolution;
+    Cp_control* control;
 
     double monitor_time(std::chrono::steady_clock::time_point start);
 
-    void print_progress(int it, real_t dif, double t);
+    void print_progress(int it, real_t dif, real_t gap, double t);
+
+    void report_progress(int it); // to 'control', see set_control()
 
     /* set components assignment and values (and allocate them if needed);
      * assumes that no edge of the graph are active when it is called */
     void initialize();
 
+    /* compute reduced graph and values again, keeping the components and
+     * their saturation, for resuming after dynamic graph updates */
+    void update();
+
     /* initialize with only one component and reduced graph accordingly */
     void single_connected_component();
 
-    /* auxiliary function for setting a new connected component */
-    void new_arbitrary_connected_component(comp_t& rv, index_t& comp_size);
-
-    /* initialize approximately rV arbitrary connected components */
+    /* initialize approximately rV arbitrary connected components, by
+     * synchronous breadth-first searches from rV seeds in parallel; vertices
+     * which cannot be reached within size limits are then grouped
+     * sequentially into additional components */
     void arbitrary_connected_components();
 
     /* initialize with components specified in 'comp_assign' */
@@ -305,9 +555,27 @@ private:
     /* update connected components and count saturated ones */
     void compute_connected_components();
 
-    /* allocate and compute reduced graph structure */
+    /* connected components of the previous component rv with 'task_num'
+     * concurrent tasks (see get_task_num()), by hooking and pointer jumping
+     * of labels along inactive edges; 'label' is an array of length V, used
+     * only over the vertices of the component; new components are put in the
+     * temporary components list in the order of their first vertex in the
+     * previous list, each of them in the order of the previous list, and
+     * their roots are flagged in 'comp_assign'; returns their number */
+    index_t label_connected_components(comp_t rv, index_t task_num,
+        index_t* label);
+
+    /* allocate and compute reduced graph structure; if components are
+     * saturated, the reduced graph of the previous iteration (after merge) is
+     * updated, see below */
     void compute_reduced_graph();
 
+    /* components saturated during the split are unchanged, so are the
+     * reduced edges between them: these are remapped from the previous
+     * reduced graph, and only the boundaries of the other components are
+     * scanned; requires the previous assignment in tmp_comp_assign */
+    void update_reduced_graph();
+
     /* during the merging step, merged components are stored as chains */
     comp_t *merge_chains_root, *merge_chains_next, *merge_chains_leaf;
 };
@@ -321,6 +589,18 @@ private:
 TPL inline bool CP::is_active(index_t e)
 { return G->arcs[(size_t) 2*e].r_cap == ACTIVE_EDGE; }
 
+TPL inline index_t CP::adj_vertex(index_t e)
+{ return G->arcs[(size_t) 2*e].head - G->nodes; }
+
+TPL template <typename Body>
+inline void CP::incident_edges(index_t v, Body body)
+{
+    for (arc* a = G->nodes[v].first; a; a = a->next){
+        size_t i = a - G->arcs;
+        body((index_t) (i/2), (index_t) (a->head - G->nodes), !(i & 1));
+    }
+}
+
 TPL inline bool CP::is_sink(index_t v)
 { return !G->nodes[v].parent || G->nodes[v].is_sink; }
 
@@ -336,12 +616,28 @@ TPL inline void CP::set_tmp_comp_list(index_t i, index_t v)
 TPL inline index_t CP::get_tmp_comp_list(index_t v)
 { return G->nodes[v].vertex; }
 
+TPL inline typename CP::flow_t CP::to_flow(real_t cap)
+{
+    const real_t max = std::numeric_limits<flow_t>::max();
+    const real_t inf = std::numeric_limits<real_t>::infinity();
+    if (cap > max && cap < inf){ return std::numeric_limits<flow_t>::max(); }
+    if (cap < -max && cap > -inf){ return -std::numeric_limits<flow_t>::max(); }
+    return cap;
+}
+
 TPL inline void CP::set_edge_capacities(index_t e, real_t cap_uv,
     real_t cap_vu)
 {
     size_t a = (size_t) 2*e; // cast as size_t to avoid overflow
-    G->arcs[a].r_cap = cap_uv;
-    G->arcs[a + 1].r_cap = cap_vu;
+    G->arcs[a].r_cap = to_flow(cap_uv);
+    G->arcs[a + 1].r_cap = to_flow(cap_vu);
+}
+
+TPL inline real_t CP::get_edge_flow(index_t e)
+{
+    size_t a = (size_t) 2*e; // cast as size_t to avoid overflow
+    /* residual capacities in both directions sum up to twice the capacity */
+    return ((real_t) G->arcs[a + 1].r_cap - (real_t) G->arcs[a].r_cap)/2;
 }
 
 TPL inline void CP::set_active(index_t e)
@@ -351,13 +647,51 @@ TPL inline void CP::set_inactive(index_t e)
 { set_edge_capacities(e, 0.0, 0.0); }
 
 TPL inline void CP::set_term_capacities(index_t v, real_t cap)
-{ G->nodes[v].tr_cap = cap; }
+{ G->nodes[v].tr_cap = to_flow(cap); }
 
 TPL inline void CP::add_term_capacities(index_t v, real_t cap)
-{ G->nodes[v].tr_cap += cap; }
+{ G->nodes[v].tr_cap = to_flow(G->nodes[v].tr_cap + cap); }
+
+TPL inline typename CP::Flow_graph* CP::get_parallel_flow_graph()
+{ return new Flow_graph(*G); }
 
-TPL inline Cp_graph<real_t, index_t, comp_t>* CP::get_parallel_flow_graph()
-{ return new Cp_graph<real_t, index_t, comp_t>(*G); }
+TPL inline Maxflow_engine CP::get_maxflow_engine(index_t comp_size,
+    const index_t* comp_vertices)
+{
+    if (maxflow_engine != MAXFLOW_AUTO){ return maxflow_engine; }
+    if (comp_size < maxflow_auto_min_size){ return MAXFLOW_BK; }
+    /* each edge is stored once in the forward-star representation */
+    size_t comp_edges = 0;
+    for (index_t i = 0; i < comp_size; i++){
+        index_t v = comp_vertices[i];
+        comp_edges += first_edge[v + 1] - first_edge[v];
+    }
+    if (2.0*comp_edges >= maxflow_auto_dense_degree*comp_size){
+        return MAXFLOW_PUSH_RELABEL;
+    }
+    return 4.0*comp_edges >= maxflow_auto_dense_degree*comp_size ?
+        MAXFLOW_IBFS : MAXFLOW_BK;
+}
+
+TPL inline Maxflow_engine CP::get_maxflow_engine(comp_t rv)
+{
+    return get_maxflow_engine(first_vertex[rv + 1] - first_vertex[rv],
+        comp_list + first_vertex[rv]);
+}
+
+TPL template <typename Body>
+inline void CP::component_tasks(index_t task_num, index_t item_num, Body body)
+{
+    if (task_num <= 1){ body(0, item_num); return; }
+    for (index_t t = 0; t < task_num; t++){
+        /* cast as uintmax_t to avoid overflow */
+        index_t first = (uintmax_t) item_num*t/task_num;
+        index_t last = (uintmax_t) item_num*(t + 1)/task_num;
+        #pragma omp task
+        body(first, last);
+    }
+    #pragma omp taskwait
+}
 
 TPL inline void CP::set_saturation(comp_t rv, bool saturation)
 { G->nodes[comp_list[first_vertex[rv]]].saturation = saturation; }
@@ -365,11 +699,17 @@ TPL inline void CP::set_saturation(comp_t rv, bool saturation)
 TPL inline bool CP::is_saturated(comp_t rv)
 { return G->nodes[comp_list[first_vertex[rv]]].saturation; }
 
+TPL inline bool CP::is_cancelled()
+{ return control && control->cancel.load(std::memory_order_relaxed); }
+
 TPL inline comp_t CP::get_merge_chain_root(comp_t rv)
 {
     while (merge_chains_root[rv] != CHAIN_ROOT){ rv = merge_chains_root[rv]; }
     return rv;
 }
 
+TPL inline comp_t CP::get_merge_chain_next(comp_t rv)
+{ return merge_chains_next[rv]; }
+
 #undef TPL
 #undef CP
@@ -0,0 +1,66 @@
+/*=============================================================================
+ * Asynchronous run of cut-pursuit, with progress and cancellation
+ *
+ * The constructor launches the cut_pursuit() method of a given cut-pursuit
+ * object on a separate thread, and returns immediately; the resulting object
+ * is a handle for polling or waiting for the end of the run, reading its
+ * progress, and requesting its cancellation.
+ *
+ * Cancellation is cooperative: it is checked between the steps of each
+ * iteration, between the components to split, and between the iterations of
+ * the reduced problem algorithm; the run then stops at the end of the current
+ * iteration, with consistent components and values, see Cp::set_control().
+ *
+ * The cut-pursuit object must neither be used nor deleted until the run is
+ * over, that is until is_done() returns true or wait() returns; parameters
+ * must be set beforehand.
+ *===========================================================================*/
+#pragma once
+#include <future>
+#include "cut_pursuit.hpp"
+
+/* current values of the members of Cp_control, see cut_pursuit.hpp */
+struct Cp_progress
+{
+    int iteration; // number of completed iterations
+    uintmax_t components; // number of components
+    double objective; // objective functional at that iteration
+};
+
+template <typename real_t, typename index_t, typename comp_t,
+    typename value_t = real_t>
+class Cp_async
+{
+public:
+    /* launch cp.cut_pursuit(init) */
+    Cp_async(Cp<real_t, index_t, comp_t, value_t>& cp, bool init = true);
+
+    /* request cancellation if the run is not over, and wait for it */
+    ~Cp_async();
+
+    Cp_async(const Cp_async&) = delete;
+    Cp_async& operator=(const Cp_async&) = delete;
+
+    /* request cancellation; returns immediately */
+    void cancel();
+
+    bool is_cancelled() const;
+
+    /* check if the run is over, without blocking */
+    bool is_done() const;
+
+    /* block until the run is over, at most 'timeout' seconds if positive;
+     * returns true if it is over */
+    bool wait_for(double timeout) const;
+
+    /* block until the run is over; returns the number of iterations, as
+     * returned by cut_pursuit(); can be called only once */
+    int wait();
+
+    Cp_progress get_progress() const;
+
+private:
+    Cp<real_t, index_t, comp_t, value_t>& cp;
+    Cp_control control;
+    std::future<int> run;
+};
@@ -43,7 +43,7 @@ class Cp_d0 : public Cp<real_t, index_t, comp_t, value_t>
 {
 public:
     Cp_d0(index_t V, index_t E, const index_t* first_edge, 
-        const index_t* adj_vertices, size_t D = 1);
+        Adj_vertices<index_t> adj_vertices, size_t D = 1);
 
     /* the destructor does not free pointers which are supposed to be provided 
      * by the user (forward-star graph structure given at construction, 
@@ -52,7 +52,30 @@ public:
      * getting the corresponding pointer member and setting it to null
      * beforehand */
 
-    void set_split_param(int K = 2, int split_iter_num = 2);
+    /* with 'recursive_split', each component is split recursively, that
+     * is split, then each resulting connected component is split in turn, in
+     * independent parallel tasks, until saturation; all components are then
+     * merged at once by the usual merge step; this avoids threads waiting for
+     * the largest component at each step of each iteration; since no merge
+     * can undo a split before its pieces are split further, a split is kept
+     * only if it decreases the objective, compared to the best single value
+     * over the component as given by update_split_values();
+     * with 'standard_refine', only the first split of each call to
+     * cut_pursuit() is recursive, subsequent iterations (see set_cp_param())
+     * using the standard split, and thus stopping at one of its fixed
+     * points; otherwise, all splits are recursive */
+    void set_split_param(int K = 2, int split_iter_num = 2,
+        bool recursive_split = false, bool standard_refine = true);
+
+    /* with 'matching_merge', the greedy merge accepting one candidate per
+     * pass over the reduced edges is replaced by rounds, each accepting at
+     * once all locally dominant candidates, that is whose gain is the greatest
+     * among the candidates involving either of their components; these form
+     * a matching of the current reduced graph, thus their gains are not
+     * affected by each other; the selection is done in parallel, and only
+     * the candidates involving a component merged in the last round are then
+     * updated; the result is usually very close to the greedy merge */
+    void set_merge_param(bool matching_merge = false);
 
 protected:
     /* compute the functional f at a single vertex */
@@ -69,18 +92,21 @@ protected:
 
     comp_t K; // number of alternative values in the split
     int split_iter_num; // number of partition-and-update iterations
+    bool recursive_split, standard_refine; // see set_split_param()
+    bool matching_merge; // see set_merge_param()
 
-    /* manage alternative values for a given component;
+    /* manage alternative values for a given component, given by its list of
+     * 'comp_size' vertices 'comp_vertices';
      * altX is a D-by-K array containing alternatives;
      * label_assign indicates the prefered alternative value for each vertex;
      * initialize usually with k-means;
      * update usually use some kind of averaging, and must flag in some way
      * alternative values which are no longer competing (i.e. associated to no
      * vertex), which can be checked with is_split_value */
-    virtual void init_split_values(comp_t rv, value_t* altX,
-        comp_t* label_assign) = 0;
-    virtual void update_split_values(comp_t rv, value_t* altX,
-        comp_t* label_assign) = 0;
+    virtual void init_split_values(index_t comp_size,
+        const index_t* comp_vertices, value_t* altX, comp_t* label_assign) = 0;
+    virtual void update_split_values(index_t comp_size,
+        const index_t* comp_vertices, value_t* altX, comp_t* label_assign) = 0;
     virtual bool is_split_value(value_t altX) = 0;
 
     /**  merging components  **/
@@ -142,9 +168,10 @@ protected:
     using Cp<real_t, index_t, comp_t>::E;
     using Cp<real_t, index_t, comp_t>::D;
     using Cp<real_t, index_t, comp_t>::first_edge;
-    using Cp<real_t, index_t, comp_t>::adj_vertices;
+    using Cp<real_t, index_t, comp_t>::adj_vertex;
     using Cp<real_t, index_t, comp_t>::edge_weights;
     using Cp<real_t, index_t, comp_t>::homo_edge_weight;
+    using Cp<real_t, index_t, comp_t>::quantized_edge_weights;
     using Cp<real_t, index_t, comp_t>::rV;
     using Cp<real_t, index_t, comp_t>::rE;
     using Cp<real_t, index_t, comp_t>::comp_assign;
@@ -153,16 +180,42 @@ protected:
     using Cp<real_t, index_t, comp_t>::reduced_edge_weights;
     using Cp<real_t, index_t, comp_t>::reduced_edges;
     using Cp<real_t, index_t, comp_t>::is_saturated;
+    using Cp<real_t, index_t, comp_t>::is_cancelled;
+    using Cp<real_t, index_t, comp_t>::first_split;
     using Cp<real_t, index_t, comp_t>::get_merge_chain_root;
+    using Cp<real_t, index_t, comp_t>::get_merge_chain_next;
     using Cp<real_t, index_t, comp_t>::merge_components;
     using Cp<real_t, index_t, comp_t>::malloc_check;
     using Cp<real_t, index_t, comp_t>::realloc_check;
 
 private:
+    using typename Cp<real_t, index_t, comp_t>::Flow_graph;
+
     index_t split() override;
 
+    /* split the given component of the current partition, and return the
+     * number of activated edges; with 'check_gain', the split is discarded
+     * if it does not decrease the objective, see set_split_param() */
+    index_t split_component(comp_t rv, index_t comp_size,
+        const index_t* comp_vertices, Flow_graph* Gpar, value_t* altX,
+        bool check_gain = false);
+
+    /* objective over the given component, with values given by the labels
+     * in 'label_assign' and alternatives 'altX', contour length included */
+    real_t compute_split_objective(index_t task_num, index_t comp_size,
+        const index_t* comp_vertices, const value_t* altX,
+        const comp_t* label_assign);
+
+    /* recursive split; 'Gpar' holds one flow graph per thread, and the
+     * activations are accumulated on the original component rv */
+    index_t split_recursively();
+    void split_component_recursively(comp_t rv, index_t comp_size,
+        index_t* comp_vertices, Flow_graph** Gpar, index_t* comp_activation);
+
     /* compute the merge chains and return the number of effective merges */
     comp_t compute_merge_chains() override;
+    /* merge by rounds of locally dominant candidates, see set_merge_param() */
+    comp_t compute_matching_merge_chains();
     /* auxiliary functions for merge */
     void delete_merge_candidate(size_t re);
     void select_best_merge_candidate(size_t re, real_t* best_gain,
@@ -171,6 +224,11 @@ private:
 
     /**  type resolution for base template class members  **/
     using Cp<real_t, index_t, comp_t>::get_parallel_flow_graph;
+    using Cp<real_t, index_t, comp_t>::get_maxflow_engine;
+    using Cp<real_t, index_t, comp_t>::compute_maxflow;
+    using Cp<real_t, index_t, comp_t>::get_task_num;
+    using Cp<real_t, index_t, comp_t>::component_tasks;
+    using Cp<real_t, index_t, comp_t>::compute_local_connected_components;
     using Cp<real_t, index_t, comp_t>::is_active;
     using Cp<real_t, index_t, comp_t>::set_active;
     using Cp<real_t, index_t, comp_t>::is_sink;
@@ -26,11 +26,11 @@ public:
     enum D1p {D11, D12};
 
     Cp_d1(index_t V, index_t E, const index_t* first_edge, 
-        const index_t* adj_vertices, size_t D, D1p d1p = D12);
+        Adj_vertices<index_t> adj_vertices, size_t D, D1p d1p = D12);
 
     /* delegation for monodimensional setting */
     Cp_d1(index_t V, index_t E, const index_t* first_edge, 
-        const index_t* adj_vertices) :
+        Adj_vertices<index_t> adj_vertices) :
         Cp_d1(V, E, first_edge, adj_vertices, 1, D11){};
 
     /* the destructor does not free pointers which are supposed to be provided 
@@ -39,12 +39,87 @@ public:
      * and reduced problem elements, etc.), but this can be prevented by
      * getting the corresponding pointer member and setting it to null
      * beforehand */
+    ~Cp_d1();
 
     /* overload allowing for different weights along coordinates;
      * if 'edge_weights' is null, homogeneously equal to 'homo_edge_weight' */
     void set_edge_weights(const real_t* edge_weights = nullptr,
         real_t homo_edge_weight = 1.0, const real_t* coor_weights = nullptr);
 
+    /* the reduced graph might be disconnected, in which case the reduced
+     * problem is made of independent subproblems; if 'independent' is true,
+     * they are solved separately and in parallel, each with its own stopping
+     * criterion, and in closed form for single reduced vertices; since each
+     * solve has a fixed overhead per iteration, consecutive small components
+     * are solved together in groups of at least 'min_size' reduced vertices;
+     * otherwise the reduced problem is solved at once */
+    void set_independent_reduced_solves(bool independent = true,
+        comp_t min_size = 1000);
+
+    /* algorithm for the reduced problems: preconditioned
+     * forward-Douglas-Rachford splitting (REDUCED_PFDR), diagonally
+     * preconditioned primal-dual (REDUCED_PD), or automatic choice for each
+     * reduced problem (REDUCED_AUTO); the primal-dual algorithm maintains only
+     * one auxiliary variable along each edge instead of two, hence fewer
+     * memory passes per iteration, but its preconditioning does not adapt to
+     * the local geometry of the total variation, so that it is competitive
+     * only when the graph coupling is weak compared to the curvature of the
+     * loss; the automatic choice resorts to it if the sum of the reduced edge
+     * weights times two (the sum of weighted degrees) is at most
+     * 'auto_coupling_max' times the sum of the curvatures of the loss over
+     * the reduced vertices, and only for losses with uniform curvature known
+     * in closed form; 'pd_dual_scale' is the initial balance of primal and
+     * dual steps, set to zero for automatic setting, see pd_graph_d1.hpp;
+     * stopping criterion and maximum number of iterations are the same as for
+     * PFDR */
+    enum Reduced_solver {REDUCED_PFDR, REDUCED_PD, REDUCED_AUTO};
+
+    void set_reduced_solver(Reduced_solver solver = REDUCED_PFDR,
+        real_t pd_dual_scale = 0.0, real_t auto_coupling_max = 0.5);
+
+    /* duality gap certificates, only for d1,1 total variation: at the end
+     * of each iteration, a dual point is built by taking along each edge
+     * between components the subgradient of the total variation, and along
+     * each edge within components the flow of a maximum flow routing the
+     * gradient of the loss across the component (one per coordinate); the
+     * resulting duality gap is an upper bound on the difference between the
+     * objective functional and its minimum, and is the sum of contributions
+     * of each component; cut-pursuit stops as soon as the gap is at most
+     * 'gap_tol', and components are saturated only if their contribution is
+     * at most their share (proportional to their number of vertices) of
+     * 'gap_tol', instead of heuristically when their values do not evolve;
+     * set to zero for not computing certificates; each certificate costs
+     * about 2D maximum flows over the components which are not saturated,
+     * those of saturated components being kept from the last certificate,
+     * and its gradient is reused by the next split; derived classes can
+     * restrict their availability or their use for saturation, see for
+     * instance Cp_d1_ql1b::set_gap_tol() */
+    void set_gap_tol(real_t gap_tol = 0.0);
+
+    /* duality gap at the end of the last iteration, infinite if not
+     * computed, see set_gap_tol() */
+    real_t get_duality_gap();
+
+    /* inexact reduced problems: early iterations, where the partition is
+     * far from final, solve their reduced problems with a tolerance and a
+     * maximum number of iterations between 'loose_dif_tol' and
+     * 'loose_it_max' on the one hand, and those of the reduced problem
+     * algorithm on the other hand, see e.g. Cp_d1_ql1b::set_pfdr_param();
+     * the interpolation is geometric along the fraction of the active edges
+     * which were activated by the last split, the latter being the loose
+     * ones when all active edges are new, and the accurate ones when this
+     * fraction is at most 'stable_ratio'; an inexact reduced problem which
+     * does not decrease the objective functional is solved again
+     * accurately, so that each iteration still decreases it, at the cost of
+     * computing the objective after each reduced problem; the last
+     * iteration is always solved accurately, and so is the final partition
+     * when iterations stop otherwise; set 'loose_dif_tol' to zero for
+     * always solving accurately; a loose tolerance of the order of the
+     * cut-pursuit 'dif_tol' keeps the evolution of the iterate meaningful,
+     * see set_cp_param() */
+    void set_inexact_reduced(real_t loose_dif_tol = 0.0,
+        int loose_it_max = 100, real_t stable_ratio = 0.05);
+
 protected:
     /* for multidimensional data, weights the coordinates in the lp norms;
      * all weights must be strictly positive, and it is advised to normalize
@@ -54,6 +129,113 @@ protected:
     /* compute graph total variation; use reduced edges and reduced weights */
     real_t compute_graph_d1();
 
+    /* see set_independent_reduced_solves() */
+    bool independent_reduced_solves;
+    comp_t independent_min_size;
+
+    /* compute the connected components of the reduced graph, gathered into
+     * groups as explained in set_independent_reduced_solves(); the reduced
+     * vertices of each group are listed consecutively in 'rcomp_list',
+     * starting at 'first_rcomp_vertex' (of length the number of groups plus
+     * one); similarly, its reduced edges are given in 'rcomp_edges', with
+     * endpoints indexed by their positions in the group list, and weights in
+     * 'rcomp_edge_weights', starting at 'first_rcomp_edge'; edges linking a
+     * reduced vertex to itself are discarded; all arrays are allocated with
+     * malloc(); return the number of groups, a group with a single reduced
+     * vertex being an isolated one */
+    comp_t compute_reduced_components(comp_t*& rcomp_list,
+        comp_t*& first_rcomp_vertex, comp_t*& rcomp_edges,
+        real_t*& rcomp_edge_weights, size_t*& first_rcomp_edge);
+
+    /* groups of components larger than this are solved one after the
+     * other, each in parallel; the others are solved in parallel */
+    comp_t large_reduced_component_size(comp_t rcomp_num);
+
+    /* see set_reduced_solver() */
+    Reduced_solver reduced_solver;
+    real_t pd_dual_scale, auto_coupling_max;
+
+    /**  duality gap certificates, see set_gap_tol()  **/
+
+    /* for each vertex and coordinate (D-by-V arrays), the net flow leaving
+     * the vertex should lie within [out_min, out_max], possibly infinite,
+     * usually the gradient of the smooth part of the objective shifted by
+     * the subdifferential of the separable nonsmooth part; for each
+     * coordinate, flows are routed within each component along the edges
+     * which are not active, with capacities the corresponding edge weights
+     * times the coordinate weight, by a first maximum flow satisfying the
+     * lower bounds as much as possible, and a second one then satisfying the
+     * upper bounds; 'dual_flows' gives the net flow leaving each vertex;
+     * a saturated component has not changed since the last certificate, so
+     * that its flows, if they were routed within it only, remain feasible
+     * and are kept */
+    void compute_dual_flows(const real_t* out_min, const real_t* out_max);
+    real_t* dual_flows;
+
+    /* gradient computed by the last certificate, still valid for the next
+     * split since neither the iterate nor the partition change in between;
+     * the split takes it over, null if not available */
+    real_t* certified_grad;
+
+    /* given the contribution of each vertex to the duality gap, sum them
+     * over components, flag components as saturated accordingly if
+     * 'saturate' is true, and return the total gap */
+    real_t certify_components(const real_t* vertex_gap, bool saturate = true);
+
+    /* test if the ends of an edge starting at v are in different components,
+     * or if they have almost equal values along the d-th coordinate, in
+     * which case flows are also routed along it if it is active */
+    bool is_crossing(index_t v, index_t e);
+    bool is_tied(index_t v, index_t e, size_t d);
+
+    /* set the tolerance and maximum number of iterations of the reduced
+     * problem of the current iteration, see set_inexact_reduced(); to be
+     * called at the beginning of solve_reduced_problem() with the accurate
+     * parameters of the reduced problem algorithm, which are then converted
+     * by reduced_dif_tol() and reduced_it_max() */
+    void schedule_reduced(real_t dif_tol, int it_max);
+    real_t reduced_dif_tol(real_t dif_tol);
+    int reduced_it_max(int it_max);
+
+    /* to be called at the end of solve_reduced_problem(), see
+     * set_inexact_reduced(); return false if the inexact reduced problem
+     * just solved does not decrease the objective functional, in which case
+     * it must be solved again, accurately */
+    bool reduced_decrease();
+
+    /* whether the given reduced problem should be solved with the primal-dual
+     * algorithm, see set_reduced_solver(); 'curvature' is the curvature of the
+     * loss at each reduced vertex, set to null if not available, in which
+     * case the automatic choice discards the primal-dual algorithm */
+    bool use_primal_dual(comp_t rV, size_t rE, const comp_t* reduced_edges,
+        const real_t* reduced_edge_weights, const real_t* curvature);
+
+    /* gather into 'out' the D-dimensional items of 'in' listed in 'list' of
+     * given size; 'out' is allocated if null, and set to null if 'in' is;
+     * nothing is done for an empty list */
+    template <typename T>
+    static void gather_array(T*& out, const T* in, const comp_t* list,
+        size_t size, size_t D = 1)
+    {
+        if (!in){ out = nullptr; return; }
+        if (!size){ return; }
+        if (!out){ out = (T*) malloc_check(sizeof(T)*D*size); }
+        for (size_t i = 0; i < size; i++){
+            for (size_t d = 0; d < D; d++){ out[D*i + d] = in[D*list[i] + d]; }
+        }
+    }
+
+    /* copy an array of given size into 'out', with conversion of the
+     * floating-point precision, for solving reduced problems in mixed
+     * precision; 'out' is allocated if null, and set to null if 'in' is */
+    template <typename out_t, typename in_t>
+    static void convert_array(out_t*& out, const in_t* in, size_t size)
+    {
+        if (!in){ out = nullptr; return; }
+        if (!out){ out = (out_t*) malloc_check(sizeof(out_t)*size); }
+        for (size_t i = 0; i < size; i++){ out[i] = in[i]; }
+    }
+
     /**  type resolution for base template class members  **/
     using Cp<real_t, index_t, comp_t>::rX;
     using Cp<real_t, index_t, comp_t>::last_rX;
@@ -63,7 +245,7 @@ protected:
     using Cp<real_t, index_t, comp_t>::E;
     using Cp<real_t, index_t, comp_t>::D;
     using Cp<real_t, index_t, comp_t>::first_edge;
-    using Cp<real_t, index_t, comp_t>::adj_vertices; 
+    using Cp<real_t, index_t, comp_t>::adj_vertex;
     using Cp<real_t, index_t, comp_t>::rV;
     using Cp<real_t, index_t, comp_t>::rE;
     using Cp<real_t, index_t, comp_t>::first_vertex;
@@ -71,10 +253,51 @@ protected:
     using Cp<real_t, index_t, comp_t>::reduced_edges;
     using Cp<real_t, index_t, comp_t>::malloc_check;
     using Cp<real_t, index_t, comp_t>::realloc_check;
+    using Cp<real_t, index_t, comp_t>::gap_tol;
+    using Cp<real_t, index_t, comp_t>::saturation_count;
+    using Cp<real_t, index_t, comp_t>::comp_list;
+    using Cp<real_t, index_t, comp_t>::is_active;
+    using Cp<real_t, index_t, comp_t>::set_saturation;
+    using Cp<real_t, index_t, comp_t>::is_saturated;
+    using Cp<real_t, index_t, comp_t>::set_active;
+    using Cp<real_t, index_t, comp_t>::comp_assign;
+    using Cp<real_t, index_t, comp_t>::last_rV;
+    using Cp<real_t, index_t, comp_t>::exact_reduced;
+    using Cp<real_t, index_t, comp_t>::approx_reduced;
+    using Cp<real_t, index_t, comp_t>::last_activation;
+    using Cp<real_t, index_t, comp_t>::compute_objective;
+    using Cp<real_t, index_t, comp_t>::is_cancelled;
+    using Cp<real_t, index_t, comp_t>::edge_weights;
+    using Cp<real_t, index_t, comp_t>::quantized_edge_weights;
+    using Cp<real_t, index_t, comp_t>::homo_edge_weight;
+    using Cp<real_t, index_t, comp_t>::set_term_capacities;
+    using Cp<real_t, index_t, comp_t>::set_edge_capacities;
+    using Cp<real_t, index_t, comp_t>::get_edge_flow;
+    using Cp<real_t, index_t, comp_t>::get_parallel_flow_graph;
+    using typename Cp<real_t, index_t, comp_t>::Flow_graph;
 
 private:
     const D1p d1p; // see public enum declaration
 
+    real_t duality_gap; // see get_duality_gap()
+
+    /* for each vertex and coordinate, whether its dual flows were routed
+     * within its own component only, see compute_dual_flows() */
+    bool* own_flows;
+
+    /* discard the gradient of the last certificate, and also its flows if
+     * 'flows' is true; to be called whenever they might not be valid */
+    void reset_certificate_cache(bool flows);
+
+    /* see set_inexact_reduced(); 'inexactness' is zero for accurate solves
+     * and one for the loosest ones */
+    real_t loose_dif_tol, stable_ratio, inexactness;
+    int loose_it_max;
+    /* objective functional after the last accepted reduced problem, and
+     * whether the current one is solved again, see reduced_decrease() */
+    real_t last_objective;
+    bool accurate_retry;
+
     /* test if two components are sufficiently close to merge */
     bool is_almost_equal(comp_t ru, comp_t rv);
 
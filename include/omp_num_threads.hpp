@@ -1,27 +1,176 @@
 /*==========================  omp_num_threads.hpp  ============================
  * include openmp and provide a function to compute a smart number of threads
  *
+ * the minimum number of operations per thread depends on the class of the
+ * parallelized kernel; it can be calibrated on the host by measuring the
+ * fork/join overhead and the cost of an elementary operation for each class
+ * of kernel (see calibrate_num_threads() below); the calibration can be saved
+ * to and loaded from a profile file, and is loaded automatically at first
+ * use from the file given by the environment variable CP_OMP_CALIBRATION, if
+ * any; without calibration, the minimum is MIN_OPS_PER_THREAD for all kernels
+ *
+ * two classes are enough because each call site already weights its count of
+ * operations by the work per item (e.g. V*N for a matrix-vector product, or
+ * 2*E for a traversal of the edges), so that call sites differ mostly by the
+ * cost of an elementary operation, which is dominated by the memory access
+ * pattern: sequential along arrays, or indirect along the graph; thresholds
+ * per call site would require a calibration run over each of them, with
+ * inputs of representative sizes, for little benefit
+ *
  * Hugo Raguet 2018
  *===========================================================================*/
 #pragma once
+#include <cstdint>  // requires C++11, needed for uintmax_t
+#include <cstdlib>
+#include <cstdio>
+#include <cstring>
+#include <cmath>
+#include <chrono>
+
+/* rough minimum number of operations per thread, without calibration */
+#define MIN_OPS_PER_THREAD 1000
+
+/* classes of parallelized kernels, with different costs per operation */
+enum Omp_kernel {
+    OMP_DENSE, // arithmetic along arrays, sequential memory access
+    OMP_GRAPH, // traversal of graph structures, indirect memory access
+    OMP_KERNEL_NUM
+};
+
+/* a thread is considered worth spawning if it performs at least
+ * 'overhead_ratio' times the fork/join overhead */
+struct Num_threads_calibration
+{
+    double fork_join_overhead; // in seconds, zero if not calibrated
+    double cost_per_op[OMP_KERNEL_NUM]; // in seconds, zero if not calibrated
+    double overhead_ratio;
+    uintmax_t min_ops_per_thread[OMP_KERNEL_NUM];
+
+    Num_threads_calibration() : fork_join_overhead(0.0), overhead_ratio(10.0)
+    {
+        for (int k = 0; k < OMP_KERNEL_NUM; k++){
+            cost_per_op[k] = 0.0;
+            min_ops_per_thread[k] = MIN_OPS_PER_THREAD;
+        }
+    }
+
+    /* derive the thresholds from the measures */
+    void update()
+    {
+        for (int k = 0; k < OMP_KERNEL_NUM; k++){
+            if (fork_join_overhead > 0.0 && cost_per_op[k] > 0.0){
+                double min_ops = std::ceil(overhead_ratio*fork_join_overhead
+                    /cost_per_op[k]);
+                min_ops_per_thread[k] = min_ops > 1.0 ? min_ops : 1;
+            }else{
+                min_ops_per_thread[k] = MIN_OPS_PER_THREAD;
+            }
+        }
+    }
+};
+
+static const char* const omp_kernel_names[OMP_KERNEL_NUM] =
+    {"dense", "graph"};
+
+/* load a calibration saved with save_num_threads_calibration();
+ * return false, leaving the calibration unchanged, if the file cannot be read
+ * or is not a calibration profile */
+static inline bool load_num_threads_calibration(
+    Num_threads_calibration& calibration, const char* file_name)
+{
+    FILE* file = fopen(file_name, "r");
+    if (!file){ return false; }
+    Num_threads_calibration loaded;
+    char key[64];
+    double value;
+    bool overhead_read = false;
+    while (fscanf(file, " %63s", key) == 1){
+        if (key[0] == '#'){ // comment until end of line
+            int c;
+            while ((c = fgetc(file)) != EOF && c != '\n'){}
+            continue;
+        }
+        if (fscanf(file, " %lf", &value) != 1 || value < 0.0){
+            fclose(file);
+            return false;
+        }
+        if (!strcmp(key, "fork_join_overhead")){
+            loaded.fork_join_overhead = value;
+            overhead_read = true;
+        }else if (!strcmp(key, "overhead_ratio")){
+            loaded.overhead_ratio = value;
+        }else{
+            for (int k = 0; k < OMP_KERNEL_NUM; k++){
+                if (!strncmp(key, omp_kernel_names[k],
+                        strlen(omp_kernel_names[k])) &&
+                    !strcmp(key + strlen(omp_kernel_names[k]),
+                        "_cost_per_op")){
+                    loaded.cost_per_op[k] = value;
+                }
+            }
+        }
+    }
+    fclose(file);
+    if (!overhead_read){ return false; }
+    loaded.update();
+    calibration = loaded;
+    return true;
+}
+
+/* calibration shared by all translation units; inline function with external
+ * linkage, so that its static local is unique across the program */
+inline Num_threads_calibration& num_threads_calibration()
+{
+    static Num_threads_calibration calibration = [](){
+        Num_threads_calibration c;
+        const char* file_name = getenv("CP_OMP_CALIBRATION");
+        if (file_name){ load_num_threads_calibration(c, file_name); }
+        return c;
+    }();
+    return calibration;
+}
+
+/* overload for the shared calibration */
+static inline bool load_num_threads_calibration(const char* file_name)
+{ return load_num_threads_calibration(num_threads_calibration(), file_name); }
+
+/* save the shared calibration as a text profile; return false on failure */
+static inline bool save_num_threads_calibration(const char* file_name)
+{
+    const Num_threads_calibration& calibration = num_threads_calibration();
+    FILE* file = fopen(file_name, "w");
+    if (!file){ return false; }
+    fprintf(file, "# cut-pursuit parallelization calibration, in seconds\n");
+    fprintf(file, "fork_join_overhead %.6e\n", calibration.fork_join_overhead);
+    fprintf(file, "overhead_ratio %g\n", calibration.overhead_ratio);
+    for (int k = 0; k < OMP_KERNEL_NUM; k++){
+        fprintf(file, "%s_cost_per_op %.6e\n", omp_kernel_names[k],
+            calibration.cost_per_op[k]);
+    }
+    bool success = !ferror(file);
+    return fclose(file) == 0 && success;
+}
 
 #ifdef _OPENMP
 
     #include <omp.h>
-    #include <cstdint>  // requires C++11, needed for uintmax_t
 
-    /* rough minimum number of operations per thread */
-    #define MIN_OPS_PER_THREAD 1000
-
-    /* num_ops is a rough estimation of the total number of operations 
-     * max_threads is the maximum number of jobs performed in parallel */
-    static inline int compute_num_threads(uintmax_t num_ops, \
-        uintmax_t max_threads)
+    /* num_ops is a rough estimation of the total number of operations
+     * max_threads is the maximum number of jobs performed in parallel;
+     * kernel is the class of the parallelized kernel;
+     * the result never exceeds the number of processors, nor the maximum
+     * number of threads set with omp_set_num_threads() or OMP_NUM_THREADS */
+    static inline int compute_num_threads(uintmax_t num_ops,
+        uintmax_t max_threads, Omp_kernel kernel = OMP_DENSE)
     {
-        uintmax_t num_threads = num_ops/MIN_OPS_PER_THREAD;
+        uintmax_t num_threads = num_ops/
+            num_threads_calibration().min_ops_per_thread[kernel];
         if (num_threads > (unsigned) omp_get_num_procs()){
             num_threads = omp_get_num_procs();
         }
+        if (num_threads > (unsigned) omp_get_max_threads()){
+            num_threads = omp_get_max_threads();
+        }
         if (num_threads > max_threads){ num_threads = max_threads; }
         return num_threads > 1 ? num_threads : 1;
     }
@@ -30,6 +179,75 @@
     static inline int compute_num_threads(uintmax_t num_ops)
     { return compute_num_threads(num_ops, num_ops); }
 
+    /* measure on the host the fork/join overhead with the maximum number of
+     * threads and the cost of an elementary operation for each class of
+     * kernel, and update the shared calibration accordingly; takes a fraction
+     * of a second, and should be done once and saved */
+    static inline void calibrate_num_threads(double overhead_ratio = 10.0)
+    {
+        typedef std::chrono::steady_clock clock;
+        const int num_batches = 5, num_reps = 200;
+        const size_t n = (size_t) 1 << 20; // arrays larger than usual caches
+        double best;
+
+        /**  fork/join overhead, best over batches of empty regions  **/
+        int max_threads = omp_get_max_threads();
+        volatile int sink = 0;
+        best = HUGE_VAL;
+        for (int b = 0; b < num_batches; b++){
+            clock::time_point start = clock::now();
+            for (int r = 0; r < num_reps; r++){
+                #pragma omp parallel num_threads(max_threads)
+                if (omp_get_thread_num() == max_threads){ sink = r; }
+            }
+            double t = std::chrono::duration<double>(clock::now() - start)
+                .count()/num_reps;
+            if (t < best){ best = t; }
+        }
+        double fork_join_overhead = best;
+
+        /**  cost per operation, sequential  **/
+        double* x = (double*) malloc(sizeof(double)*n);
+        double* y = (double*) malloc(sizeof(double)*n);
+        uint32_t* idx = (uint32_t*) malloc(sizeof(uint32_t)*n);
+        if (!x || !y || !idx){
+            free(x); free(y); free(idx);
+            return; // calibration left unchanged
+        }
+        for (size_t i = 0; i < n; i++){
+            x[i] = 1.0/(i + 1); y[i] = 0.0;
+            /* odd multiplier modulo a power of two: a permutation */
+            idx[i] = (uint32_t) ((i*2654435761u) & (n - 1));
+        }
+        double cost_per_op[OMP_KERNEL_NUM];
+        for (int k = 0; k < OMP_KERNEL_NUM; k++){
+            best = HUGE_VAL;
+            for (int b = 0; b < num_batches; b++){
+                clock::time_point start = clock::now();
+                if (k == OMP_DENSE){
+                    for (size_t i = 0; i < n; i++){ y[i] += 0.5*x[i]; }
+                }else{ /* OMP_GRAPH */
+                    for (size_t i = 0; i < n; i++){ y[idx[i]] += 0.5*x[i]; }
+                }
+                double t = std::chrono::duration<double>(clock::now()
+                    - start).count()/n;
+                if (t < best){ best = t; }
+            }
+            cost_per_op[k] = best;
+        }
+        sink = (int) y[idx[n/2]];
+        (void) sink;
+        free(x); free(y); free(idx);
+
+        Num_threads_calibration& calibration = num_threads_calibration();
+        calibration.fork_join_overhead = fork_join_overhead;
+        calibration.overhead_ratio = overhead_ratio;
+        for (int k = 0; k < OMP_KERNEL_NUM; k++){
+            calibration.cost_per_op[k] = cost_per_op[k];
+        }
+        calibration.update();
+    }
+
     #define NUM_THREADS(...) \
         num_threads(compute_num_threads((uintmax_t) __VA_ARGS__))
 
@@ -37,8 +255,13 @@
 
     static inline int omp_get_num_procs(){ return 1; }
     static inline int omp_get_thread_num(){ return 0; }
-    static inline int compute_num_threads(int num_ops, int max_threads = 1)
+    static inline int omp_get_num_threads(){ return 1; }
+    static inline int omp_get_max_threads(){ return 1; }
+    static inline void omp_set_num_threads(int num_threads){}
+    static inline int compute_num_threads(int num_ops, int max_threads = 1,
+        Omp_kernel kernel = OMP_DENSE)
         { return 1; }
+    static inline void calibrate_num_threads(double overhead_ratio = 10.0){}
 
     #define NUM_THREADS(...) num_threads(1)
 
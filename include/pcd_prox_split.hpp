@@ -11,6 +11,7 @@
  *============================================================================*/
 #pragma once
 #include <cstdlib>
+#include <atomic>
 #include <iostream>
 #include <limits>
 
@@ -37,6 +38,10 @@ public:
 
     void set_conditioning_param(real_t cond_min = 1e-2, real_t dif_rcd = 1e-4);
 
+    /* iterations stop as soon as the pointed flag is set to true; the
+     * current iterate is then kept as a solution */
+    void set_cancel_flag(const std::atomic<bool>* cancel = nullptr);
+
     void set_algo_param(real_t dif_tol, int it_max, int verbose, real_t eps);
     /* overload for allowing a function call for default parameter 'eps' */
     void set_algo_param(real_t dif_tol = 1e-5, int it_max = 1e4, int verbose = 1e2)
@@ -90,6 +95,8 @@ protected:
 
     real_t eps; // characteristic precision 
 
+    const std::atomic<bool>* cancel; // cancellation request, can be null
+
     /**  arrays  **/
     real_t *X, *last_X; // iterate, previous iterate
 
@@ -0,0 +1,95 @@
+/*=============================================================================
+ * Minimize functional over a graph G = (V, E)
+ *
+ *        F(x) = f(x) + ||x||_d1 + i_{simplex}(x)
+ *
+ * where for each vertex, x_v is a D-dimensional vector,
+ *       f(x) = sum_{v in V} f_v(x_v) is a separable data-fidelity loss
+ *       ||x||_d1 = sum_{uv in E} w_d1_uv (sum_d w_d1_d |x_ud - x_vd|),
+ * and i_{simplex} is the standard D-simplex constraint over each vertex,
+ *     i_{simplex} = 0 for all v, (for all d, x_vd >= 0) and sum_d x_vd = 1,
+ *                 = infinity otherwise;
+ *
+ * using diagonally preconditioned primal-dual algorithm, see pd_graph_d1.hpp.
+ *
+ * Linear and quadratic losses are dealt with within the proximal operator
+ * together with the simplex constraint, which is then exact; for the smoothed
+ * Kullback-Leibler loss, its gradient is used.
+ *
+ * Losses and their parameters are the same as for Pfdr_d1_lsx, see
+ * pfdr_d1_lsx.hpp.
+ *
+ * Parallel implementation with OpenMP API.
+ *===========================================================================*/
+#pragma once
+#include "pd_graph_d1.hpp"
+#define LINEAR ((real_t) 0.0)
+#define QUADRATIC ((real_t) 1.0)
+
+/* vertex_t is an integer type able to represent the number of vertices */
+template <typename real_t, typename vertex_t>
+class Pd_d1_lsx : public Pd_d1<real_t, vertex_t>
+{
+public:
+    /**  constructor, destructor  **/
+
+    Pd_d1_lsx(vertex_t V, size_t E, const vertex_t* edges, real_t loss,
+        size_t D, const real_t* Y, const real_t* d1_coor_weights = nullptr);
+
+    /* the destructor does not free pointers which are supposed to be provided
+     * by the user (adjacency graph structure given at construction,
+     * monitoring arrays, observation arrays); it does free the rest (iterate,
+     * dual variable etc.), but this can be prevented by copying the
+     * corresponding pointer member and set it to null before deleting */
+	~Pd_d1_lsx();
+
+    /**  methods for manipulating parameters  **/
+
+    void initialize_iterate() override; // initialize on simplex based on Y
+
+    /* same as Pfdr_d1_lsx::set_loss() */
+    void set_loss(real_t loss, const real_t* Y = nullptr,
+        const real_t* loss_weights = nullptr);
+
+    /* overload for changing only loss_weights */
+    void set_loss(const real_t* loss_weights)
+    { set_loss(loss, nullptr, loss_weights); }
+
+private:
+    /**  separable loss term, see pfdr_d1_lsx.hpp  **/
+
+    const real_t* Y;
+    real_t loss;
+    const real_t* loss_weights;
+
+    /**  preconditioning  **/
+
+    real_t* Lmut; // Lipschitz metric, used only for Kullback-Leibler loss
+
+    /**  specialization of base virtual methods  **/
+
+    void compute_lipschitz_metric() override;
+
+    void compute_grad_f() override; // only for Kullback-Leibler loss
+
+    /* linear or quadratic loss and simplex constraint */
+    void compute_prox_Tau_h() override;
+
+    real_t compute_f() override; // separable loss
+
+    void preconditioning(bool init) override; // allocate gradient
+
+    /* relative iterate evolution in l1 norm, as Pfdr_d1_lsx */
+    real_t compute_primal_evolution() override;
+
+    /**  type resolution for base template class members  **/
+    using Pd_d1<real_t, vertex_t>::V;
+    using Pd_d1<real_t, vertex_t>::D;
+    using Pd_d1<real_t, vertex_t>::L;
+    using Pd_d1<real_t, vertex_t>::mean_curvature;
+    using Pd_d1<real_t, vertex_t>::Tau;
+    using Pd_d1<real_t, vertex_t>::Grad;
+    using Pcd_prox<real_t>::X;
+    using Pcd_prox<real_t>::last_X;
+    using Pcd_prox<real_t>::malloc_check;
+};
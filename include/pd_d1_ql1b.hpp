@@ -0,0 +1,126 @@
+/*=============================================================================
+ * Minimize functional over a graph G = (V, E)
+ *
+ *        F(x) = 1/2 ||y - A x||^2 + ||x||_d1 + ||yl1 - x||_l1 + i_[m,M](x)
+ *
+ * where y in R^N, x in R^V, A in R^{N-by-|V|}, yl1 in R^V
+ *      ||x||_d1 = sum_{uv in E} w_d1_uv |x_u - x_v|,
+ *      ||x||_l1 = sum_{v  in V} w_l1_v |x_v|,
+ * and the convex indicator
+ *      i_[m,M](x) = infinity any x_v < m_v or x_v > M_v
+ *                 = 0 otherwise;
+ *
+ * using diagonally preconditioned primal-dual algorithm, see pd_graph_d1.hpp.
+ *
+ * When A^t A is diagonal, the quadratic part is dealt with within the
+ * proximal operator together with l1 and bounds, which is then exact;
+ * otherwise, its gradient is used with the diagonal Lipschitz bound given by
+ * the absolute row sums of A^t A (or |A|^t |A| in the direct matricial case).
+ *
+ * Data arrays and their shapes are the same as for Pfdr_d1_ql1b, see
+ * pfdr_d1_ql1b.hpp.
+ *
+ * Parallel implementation with OpenMP API.
+ *===========================================================================*/
+#pragma once
+#include "pd_graph_d1.hpp"
+#define INF_REAL (std::numeric_limits<real_t>::infinity())
+#define FULL_ATA ((size_t) 0)
+#define DIAG_ATA ((size_t) -1)
+#define IS_ATA(N) (N == FULL_ATA || N == DIAG_ATA)
+
+/* vertex_t is an integer type able to represent the number of vertices */
+template <typename real_t, typename vertex_t>
+class Pd_d1_ql1b : public Pd_d1<real_t, vertex_t>
+{
+public:
+    /**  constructor, destructor  **/
+
+    Pd_d1_ql1b(vertex_t V, size_t E, const vertex_t* edges);
+
+    /* the destructor does not free pointers which are supposed to be provided
+     * by the user (adjacency graph structure given at construction,
+     * monitoring arrays, matrix and observation arrays); it does free the rest
+     * (iterate, dual variable etc.), but this can be prevented by copying the
+     * corresponding pointer member and set it to null before deleting */
+	~Pd_d1_ql1b();
+
+    /**  methods for manipulating parameters  **/
+
+    /* same as Pfdr_d1_ql1b::set_quadratic() */
+    void set_quadratic(const real_t* Y, size_t N = DIAG_ATA,
+        const real_t* A = nullptr, real_t a = 1.0);
+
+    /* set l1_weights null for homogeneously equal to homo_l1_weight */
+    void set_l1(const real_t* l1_weights = nullptr,
+        real_t homo_l1_weight = 0.0, const real_t* Yl1 = nullptr);
+
+    /* set bounds *_bnd to null for homogeneously equal to homo_*_bnd */
+    void set_bounds(
+        const real_t* low_bnd = nullptr, real_t homo_low_bnd = -INF_REAL,
+        const real_t* upp_bnd = nullptr, real_t homo_upp_bnd = INF_REAL);
+
+    /* initialize with coordinatewise pseudo-inverse, as Pfdr_d1_ql1b */
+    void initialize_iterate() override;
+
+private:
+    /**  quadratic problem, see pfdr_d1_ql1b.hpp  **/
+
+    size_t N;
+    const real_t* A;
+    real_t a;
+    const real_t* Y;
+
+    /* if N is positive, compute residual (Y - A X) in R;
+     * otherwise, if N is zero, compute directly (A^t A X) in AX */
+    void apply_A();
+
+    /**  regularizations, see pfdr_d1_ql1b.hpp  **/
+
+    const real_t* Yl1;
+    const real_t* l1_weights;
+    real_t homo_l1_weight;
+    const real_t* low_bnd;
+    real_t homo_low_bnd;
+    const real_t* upp_bnd;
+    real_t homo_upp_bnd;
+
+    /**  preconditioning and auxiliary variables  **/
+
+    real_t* R; // residual, array of length N, used only if N is positive
+    real_t* AX; // product (A^t A) X, used only if N is zero
+    real_t* Lmut; // Lipschitz metric, used only if A^t A is not diagonal
+
+    /**  specialization of base virtual methods  **/
+
+    void compute_lipschitz_metric() override;
+
+    void compute_grad_f() override; // assume apply_A() have been called
+
+    /* quadratic part (if A^t A is diagonal), l1 and bounds */
+    void compute_prox_Tau_h() override;
+
+    /* quadratic functional; in the precomputed A^t A version,
+     * a constant 1/2||Y||^2 is omited */
+    real_t compute_f() override;
+
+    real_t compute_h() override; // l1 norm
+
+    void preconditioning(bool init) override; // add some precomputations
+
+    void main_iteration() override; // add application of matrix A
+
+    /* weight l2 norm by the diagonal of A^t A */
+    real_t compute_primal_evolution() override;
+
+    /**  type resolution for base template class members  **/
+    using Pd_d1<real_t, vertex_t>::V;
+    using Pd_d1<real_t, vertex_t>::L;
+    using Pd_d1<real_t, vertex_t>::mean_curvature;
+    using Pd_d1<real_t, vertex_t>::Tau;
+    using Pd_d1<real_t, vertex_t>::Grad;
+    using Pcd_prox<real_t>::X;
+    using Pcd_prox<real_t>::last_X;
+    using Pcd_prox<real_t>::eps;
+    using Pcd_prox<real_t>::malloc_check;
+};
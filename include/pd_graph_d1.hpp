@@ -0,0 +1,196 @@
+/*=============================================================================
+ * Minimize functional over a graph G = (V, E)
+ *
+ * minimize F: x -> f(x) + ||x||_d1 + h(x)
+ *
+ * involving the graph total variation penalisation
+ *
+ *      ||x||_d1 = sum_{uv in E} w_uv (sum_d w_d |x_ud - x_vd|) ,
+ *
+ * and where f has Lipschitz continuous gradient, and the proximal operator of
+ * h is easy to compute, possibly including part of f,
+ *
+ * using a diagonally preconditioned primal-dual algorithm; denoting K the
+ * finite differences operator along the edges and P the dual variable of the
+ * total variation, each iteration reads
+ *
+ *      x <- prox_{T h}(x_prev - T (grad f(x_prev) + K^t P))
+ *      P <- proj_{|P| <= w}(P + S K (2x - x_prev))
+ *
+ * with T and S diagonal steps following Pock and Chambolle (2011), augmented
+ * with the Lipschitz constants of grad f following Condat (2013):
+ *      S = s/2 over the edges, T_v = 1/(s deg(v) + L_v) over the vertices,
+ * where deg(v) is the number of edges adjacent to v, L_v bounds the curvature
+ * of f at v, and s > 0 balances primal and dual steps; by default, s is
+ * adapted along iterations so as to balance primal and dual residuals,
+ * following Goldstein et al. (2015).
+ * Compared to the forward-Douglas-Rachford splitting, only one auxiliary
+ * variable (the dual variable) is maintained along each edge, but the
+ * preconditioning does not adapt to the local geometry of the total variation.
+ *
+ * Parallel implementation with OpenMP API.
+ *
+ * T. Pock and A. Chambolle, Diagonal Preconditioning for First Order
+ * Primal-Dual Algorithms in Convex Optimization, International Conference on
+ * Computer Vision, 2011, 1762-1769
+ *
+ * L. Condat, A Primal-Dual Splitting Method for Convex Optimization Involving
+ * Lipschitzian, Proximable and Linear Composite Terms, Journal of Optimization
+ * Theory and Applications, 2013, 158, 460-479
+ *
+ * T. Goldstein, M. Li and X. Yuan, Adaptive Primal-Dual Splitting Methods for
+ * Statistical Learning and Image Processing, Advances in Neural Information
+ * Processing Systems, 2015, 2089-2097
+ *============================================================================*/
+#pragma once
+#include "pcd_prox_split.hpp"
+
+/* vertex_t is an integer type able to represent the number of vertices */
+template <typename real_t, typename vertex_t>
+class Pd_d1 : public Pcd_prox<real_t>
+{
+public:
+    /**  constructor, destructor  **/
+
+    /* only the d1,1 total variation (sum of weighted l1 norms of finite
+     * differences) is supported for multidimensional data */
+    Pd_d1(vertex_t V, size_t E, const vertex_t* edges, size_t D = 1,
+        const real_t* coor_weights = nullptr);
+
+    /* the destructor does not free pointers which are supposed to be provided
+     * by the user (adjacency graph structure, monitoring arrays, etc.); it
+     * does free the rest (iterate, dual variable, etc.), but this can be
+     * prevented by copying the corresponding pointer member and set it to null
+     * before deleting */
+	virtual ~Pd_d1();
+
+    /**  methods for manipulating parameters  **/
+
+    void set_edge_weights(const real_t* edge_weights = nullptr,
+        real_t homo_edge_weight = 1.0);
+
+    /* initial balance s between primal and dual steps, see header; set to
+     * zero for automatic setting, as the ratio of the average curvature of f
+     * per vertex over the average degree, or the average edge weight if f has
+     * no curvature; if 'adapt_dual_scale' is false, s is kept constant */
+    void set_dual_scale(real_t dual_scale = 0.0, bool adapt_dual_scale = true);
+
+    /* dual variable, D-by-E array, column major format; if not set, it is
+     * allocated and initialized to zero at preconditioning */
+    void set_dual(real_t* P);
+
+    real_t* get_dual();
+
+protected:
+    /**  graph  **/
+
+    const vertex_t V; // number of vertices
+    const size_t E; // number of (undirected) edges
+    const size_t D; // dimension of the data at each vertex
+
+    /* list of edges, array of length 2E;
+     * edge number e connects vertices indexed at edges[2*e] and edges[2*e+1];
+     * edges linking a vertex to itself are ignored */
+    const vertex_t* const edges;
+
+    /**  preconditioning  **/
+
+    /* Lipschitz constants of the gradient of f, array of length V, set to
+     * null for zero (in particular if f is dealt with within the proximal
+     * operator of h); must be set by compute_lipschitz_metric() */
+    const real_t* L;
+    /* average curvature of f per vertex, including the part dealt with within
+     * the proximal operator of h, for automatic setting of the dual scale;
+     * must be set by compute_lipschitz_metric() */
+    real_t mean_curvature;
+
+    real_t* Tau; // primal steps, array of length V
+
+    /* gradient of f, D-by-V array, column major format; allocated and
+     * computed by derived classes if L is not null, otherwise null */
+    real_t* Grad;
+
+    /**  methods  **/
+
+    /* set L and mean_curvature, see above */
+    virtual void compute_lipschitz_metric() = 0;
+
+    /* compute the gradient of f at the current iterate into Grad */
+    virtual void compute_grad_f(){}
+
+    /* proximal operator of h (and possibly f) within metric given by the
+     * inverse of the steps Tau, in place over the iterate X */
+    virtual void compute_prox_Tau_h() = 0;
+
+    virtual real_t compute_f() = 0;
+
+    virtual real_t compute_h(){ return 0.0; }
+
+    real_t compute_g(); // graph total variation
+
+    /* allocate and initialize arrays, compute the steps */
+    void preconditioning(bool init) override;
+
+    void main_iteration() override;
+
+    /* relative evolution of the iterate, by default in Euclidean norm */
+    virtual real_t compute_primal_evolution()
+    { return Pcd_prox<real_t>::compute_evolution(); }
+
+    /* maximum of the relative evolutions of the iterate and of the dual
+     * variable; the latter is needed since the dual variable is initialized
+     * at zero, in which case the iterate might not evolve at first */
+    real_t compute_evolution() override;
+
+    real_t compute_objective() override;
+
+    /**  type resolution for base template class members  **/
+    using Pcd_prox<real_t>::X;
+    using Pcd_prox<real_t>::eps;
+    using Pcd_prox<real_t>::malloc_check;
+
+private:
+    /**  graph total variation  **/
+
+    /* if 'edge_weights' is not null, array of length E;
+     * otherwise homogeneously equal to 'homo_edge_weight' */
+    const real_t* edge_weights;
+    real_t homo_edge_weight;
+    /* for multidimensional data, weights the coordinates in the l1 norms;
+     * all weights must be strictly positive */
+    const real_t* coor_weights;
+
+    /**  primal-dual variables and steps  **/
+
+    real_t dual_scale; // see set_dual_scale()
+    bool adapt_dual_scale;
+    real_t scale; // current value of s, see header
+    real_t dual_step; // S, see header
+    real_t* P; // dual variable, D-by-E array
+    /* evolution of the dual variable in l1 norm during the last iteration,
+     * and its maximum amplitude (sum of the weights) */
+    real_t dual_dif, dual_amp;
+    real_t* X_prev; // previous iterate, for the extrapolation
+
+    /**  adaptive balance of primal and dual steps  **/
+
+    real_t adapt_rate; // relative change of s, decreasing along adaptations
+    /* product K^t P at the previous iteration, D-by-V array, used only if
+     * adapt_dual_scale is true */
+    real_t* KtP;
+    /* squared norm of the dual residual of the previous iteration, negative
+     * if not available */
+    double dual_res;
+
+    void compute_steps(); // set primal and dual steps from current scale
+
+    /* update scale given primal and dual residuals */
+    void balance_steps(double primal_res);
+
+    /* edges adjacent to each vertex, with index into 'adj_edges' starting at
+     * 'first_adj_edge' (array of length V + 1) */
+    size_t* first_adj_edge;
+    size_t* adj_edges;
+
+    void compute_adjacency();
+};
@@ -187,6 +187,7 @@ private:
     using Pfdr_d1<real_t, vertex_t>::E;
     using Pfdr<real_t, vertex_t>::Ga_grad_f;
     using Pfdr<real_t, vertex_t>::Ga;
+    using Pfdr<real_t, vertex_t>::Z;
     using Pfdr<real_t, vertex_t>::L;
     using Pfdr<real_t, vertex_t>::l;
     using Pfdr<real_t, vertex_t>::lshape;
@@ -0,0 +1,45 @@
+/*=============================================================================
+ * Read-only array of real values stored as unsigned 8 or 16 bits integers
+ *
+ * The i-th value is offset + scale*q[i], where q is the array of integers;
+ * for instance, probabilities quantized over 8 bits are given with
+ * scale = 1/255 and offset = 0.
+ *
+ * Values are dequantized when accessed, so that sweeps over the array read
+ * two to eight times less memory than over an array of float or double.
+ *===========================================================================*/
+#pragma once
+#include <cstdlib>
+#include <cstdint>
+
+template <typename real_t>
+class Quantized_array
+{
+public:
+    /* empty array, evaluates to false */
+    Quantized_array() : q8(nullptr), q16(nullptr), scale(1.0), offset(0.0){}
+
+    Quantized_array(const uint8_t* q, real_t scale, real_t offset = 0.0)
+        : q8(q), q16(nullptr), scale(scale), offset(offset){}
+
+    Quantized_array(const uint16_t* q, real_t scale, real_t offset = 0.0)
+        : q8(nullptr), q16(q), scale(scale), offset(offset){}
+
+    explicit operator bool() const { return q8 || q16; }
+
+    real_t operator[](size_t i) const
+    { return offset + scale*(q8 ? (real_t) q8[i] : (real_t) q16[i]); }
+
+    /* array starting at the i-th value, as with pointer arithmetic */
+    Quantized_array operator+(size_t i) const
+    {
+        Quantized_array shifted(*this);
+        if (q8){ shifted.q8 += i; }else if (q16){ shifted.q16 += i; }
+        return shifted;
+    }
+
+private:
+    const uint8_t* q8;
+    const uint16_t* q16;
+    real_t scale, offset;
+};
@@ -0,0 +1,208 @@
+/*=============================================================================
+ * Minimize functional over a graph G = (V, E)
+ *
+ *        F(x) = 1/2 ||y - A x||^2 + ||x||_d1 + ||yl1 - x||_l1 + i_[m,M](x)
+ *
+ * where y in R^N, x in R^V, A in R^{N-by-|V|}, yl1 in R^V
+ *      ||x||_d1 = sum_{uv in E} w_d1_uv |x_u - x_v|,
+ *      ||x||_l1 = sum_{v  in V} w_l1_v |x_v|,
+ * and the convex indicator
+ *      i_[m,M](x) = infinity any x_v < m_v or x_v > M_v
+ *                 = 0 otherwise;
+ *
+ * using a semismooth Newton augmented Lagrangian method; denoting K the
+ * finite differences operator along the edges, the total variation and the
+ * separable part (l1 and bounds) are split from x by the constraints z = K x
+ * and z' = x, with multipliers P and P'; each outer iteration minimizes the
+ * augmented Lagrangian with penalty s over z and z' in closed form, yielding
+ * a convex, continuously differentiable function of x
+ *
+ *   1/2 <x, A^t A x> - <x, A^t y> + sum_uv env_uv((K x)_uv + P_uv/s)
+ *       + sum_v env_v(x_v + P'_v/s),
+ *
+ * with env_uv and env_v the Moreau envelopes of w_d1_uv |.| and of the
+ * separable part, of parameter 1/s, which is minimized by semismooth Newton
+ * iterations with backtracking line search; the generalized Hessian is
+ *
+ *              A^t A + s K_F^t K_F + s I_B,
+ *
+ * where F is the set of edges along which the finite difference is
+ * currently zero, so that K_F^t K_F is the Laplacian of the graph (V, F),
+ * and I_B the identity restricted to vertices currently at a bound or at the
+ * kink of the l1 norm; it is factorized at each Newton iteration by a dense
+ * Cholesky decomposition. The multipliers are then updated, and the penalty
+ * increased if the constraints are not satisfied fast enough.
+ *
+ * The objective being piecewise quadratic, Newton iterations terminate as
+ * soon as the sets F and B are identified, so that only a few of them are
+ * needed, and the solution is accurate up to the precision of the Cholesky
+ * decomposition; but each one costs O(V^3) operations and O(V^2) memory, so
+ * that this is suited to small problems only, such as small reduced problems
+ * of cut-pursuit. Only the precomputed forms of the quadratic part are
+ * supported (N set to FULL_ATA or DIAG_ATA, see pfdr_d1_ql1b.hpp), and its
+ * curvature should be positive, or the edges connect too few vertices for
+ * the Newton systems to be well posed.
+ *
+ * The computations are sequential, several problems being meant to be solved
+ * in parallel.
+ *
+ * X. Li, D. Sun and K.-C. Toh, A Highly Efficient Semismooth Newton
+ * Augmented Lagrangian Method for Solving Lasso Problems, SIAM Journal on
+ * Optimization, 2018, 28, 433-458
+ *===========================================================================*/
+#pragma once
+#include <cstdlib>
+#include <atomic>
+#include <iostream>
+#include <limits>
+#define INF_REAL (std::numeric_limits<real_t>::infinity())
+#define FULL_ATA ((size_t) 0)
+#define DIAG_ATA ((size_t) -1)
+#define IS_ATA(N) (N == FULL_ATA || N == DIAG_ATA)
+
+/* vertex_t is an integer type able to represent the number of vertices */
+template <typename real_t, typename vertex_t>
+class Ssnal_d1_ql1b
+{
+public:
+    /**  constructor, destructor  **/
+
+    Ssnal_d1_ql1b(vertex_t V, size_t E, const vertex_t* edges);
+
+    /* the destructor does not free pointers which are supposed to be provided
+     * by the user (adjacency graph structure, matrix and observation arrays);
+     * it does free the rest (iterate, multipliers, etc.), but this can be
+     * prevented by copying the corresponding pointer member and set it to
+     * null before deleting */
+    ~Ssnal_d1_ql1b();
+
+    /**  methods for manipulating parameters  **/
+
+    void set_edge_weights(const real_t* edge_weights = nullptr,
+        real_t homo_edge_weight = 1.0);
+
+    /* same as Pfdr_d1_ql1b::set_quadratic(), but N must be FULL_ATA or
+     * DIAG_ATA, and A cannot be null */
+    void set_quadratic(const real_t* Y, size_t N, const real_t* A);
+
+    /* set l1_weights null for homogeneously equal to homo_l1_weight */
+    void set_l1(const real_t* l1_weights = nullptr,
+        real_t homo_l1_weight = 0.0, const real_t* Yl1 = nullptr);
+
+    /* set bounds *_bnd to null for homogeneously equal to homo_*_bnd */
+    void set_bounds(
+        const real_t* low_bnd = nullptr, real_t homo_low_bnd = -INF_REAL,
+        const real_t* upp_bnd = nullptr, real_t homo_upp_bnd = INF_REAL);
+
+    /* iterations stop as soon as the pointed flag is set to true */
+    void set_cancel_flag(const std::atomic<bool>* cancel = nullptr);
+
+    /* iterations stop when both the constraints and the gradient of the
+     * augmented Lagrangian are at most 'dif_tol' relatively to the norms of
+     * the iterate and of the terms of the gradient, respectively; 'it_max' is
+     * the total number of Newton iterations; if 'verbose' is nonzero,
+     * information is printed at each outer iteration */
+    void set_algo_param(real_t dif_tol = 1e-10, int it_max = 100,
+        int verbose = 0);
+
+    /* if not set, the iterate is allocated at solve() with malloc(), and is
+     * then free()'d by the destructor unless set to null beforehand; if given,
+     * it must be initialized or initialize_iterate() must be called */
+    void set_iterate(real_t* X);
+
+    /* coordinatewise minimization of the separable part, ignoring the total
+     * variation and the off-diagonal terms of A^t A */
+    void initialize_iterate();
+
+    real_t* get_iterate();
+
+    /**  solve the problem  **/
+
+    /* return the total number of Newton iterations */
+    int solve();
+
+    /* whether the stopping criterion was met by the last call to solve() */
+    bool is_converged();
+
+private:
+    /**  graph  **/
+
+    const vertex_t V; // number of vertices
+    const size_t E; // number of (undirected) edges
+    /* list of edges, array of length 2E; edges linking a vertex to itself
+     * are ignored */
+    const vertex_t* const edges;
+
+    const real_t* edge_weights;
+    real_t homo_edge_weight;
+
+    /**  problem, see pfdr_d1_ql1b.hpp  **/
+
+    size_t N;
+    const real_t* A;
+    const real_t* Y;
+    const real_t* Yl1;
+    const real_t* l1_weights;
+    real_t homo_l1_weight;
+    const real_t* low_bnd;
+    real_t homo_low_bnd;
+    const real_t* upp_bnd;
+    real_t homo_upp_bnd;
+
+    /**  algorithm  **/
+
+    real_t dif_tol;
+    int it_max, verbose;
+    const std::atomic<bool>* cancel;
+    bool converged;
+
+    real_t* X; // iterate, array of length V
+    real_t *P, *Pv; // multipliers along the edges and the vertices
+    real_t s; // penalty
+
+    /* product (A^t A) x into AX */
+    void apply_AA(const real_t* x, real_t* AX);
+
+    /* augmented Lagrangian at x, minimized over the split variables, given
+     * the product AX = (A^t A) x */
+    real_t compute_lagrangian(const real_t* x, const real_t* AX);
+
+    /* closed form minimization over the split variables at x, giving the
+     * gradient of the augmented Lagrangian into Grad, and the updated
+     * multipliers into P_new and Pv_new; 'fused' and 'fixed' flag the edges
+     * in F and the vertices in B, see header; return the norm of the terms
+     * of the gradient, for the relative stopping criterion */
+    real_t compute_gradient(const real_t* x, const real_t* AX, real_t* Grad,
+        real_t* P_new, real_t* Pv_new, bool* fused, bool* fixed);
+
+    /* generalized Hessian into H, V-by-V array, and its Cholesky
+     * factorization in place, regularized if necessary */
+    void factorize_hessian(const bool* fused, const bool* fixed, real_t* H);
+
+    /* active-set step: vertices linked by fused edges are grouped, groups
+     * containing a fixed vertex are set to the corresponding bound or kink,
+     * and the values of the other groups are the exact minimizers of the
+     * objective given the signs along the other edges and of the l1 norm,
+     * given by the multipliers; the iterate is replaced only if feasible and
+     * if the objective does not increase; H is used as workspace */
+    void polish(const bool* fused, const bool* fixed, real_t* H);
+
+    /* objective functional at x, given the product AX = (A^t A) x; in the
+     * precomputed A^t A version, the constant 1/2||y||^2 is omitted */
+    real_t compute_objective(const real_t* x, const real_t* AX);
+
+    /* Cholesky factorization L L^t of a n-by-n matrix in place, lower
+     * triangular part, column major format; return false if a pivot is at
+     * most 'tol' */
+    static bool cholesky(size_t n, real_t* M, real_t tol);
+
+    /* solve L L^t x = b in place of b */
+    static void cholesky_solve(size_t n, const real_t* L, real_t* b);
+
+    /* proximity operator of the separable part with parameter 1/s at v,
+     * flagging if the result is at a bound or at the kink of the l1 norm */
+    real_t prox_vertex(vertex_t v, real_t t, bool& fixed);
+
+    /* allocate memory and fail with error message if not successful */
+    static void* malloc_check(size_t size);
+};
@@ -19,9 +19,11 @@ try
     %{
     mex mex/cp_pfdr_d1_ql1b_mex.cpp ../src/cp_pfdr_d1_ql1b.cpp ...
         ../src/cut_pursuit_d1.cpp ../src/cut_pursuit.cpp ...
-        ../src/cp_graph.cpp ../src/pfdr_d1_ql1b.cpp ../src/matrix_tools.cpp ...
+        ../src/cp_graph.cpp ../src/compressed_adjacency.cpp ...
+        ../src/pfdr_d1_ql1b.cpp ../src/matrix_tools.cpp ...
         ../src/pfdr_graph_d1.cpp ../src/pcd_fwd_doug_rach.cpp ...
-        ../src/pcd_prox_split.cpp ...
+        ../src/pcd_prox_split.cpp ../src/pd_d1_ql1b.cpp ...
+        ../src/pd_graph_d1.cpp ../src/ssnal_d1_ql1b.cpp ...
         -output bin/cp_pfdr_d1_ql1b_mex
     clear cp_pfdr_d1_ql1b_mex
     %}
@@ -29,9 +31,11 @@ try
     %{
     mex mex/cp_pfdr_d1_lsx_mex.cpp ../src/cp_pfdr_d1_lsx.cpp ...
         ../src/cut_pursuit_d1.cpp ../src/cut_pursuit.cpp ...
-        ../src/cp_graph.cpp ../src/pfdr_d1_lsx.cpp ../src/proj_simplex.cpp ...
+        ../src/cp_graph.cpp ../src/compressed_adjacency.cpp ...
+        ../src/pfdr_d1_lsx.cpp ../src/proj_simplex.cpp ...
         ../src/pfdr_graph_d1.cpp ../src/pcd_fwd_doug_rach.cpp ...
-        ../src/pcd_prox_split.cpp ...
+        ../src/pcd_prox_split.cpp ../src/pd_d1_lsx.cpp ...
+        ../src/pd_graph_d1.cpp ...
         -output bin/cp_pfdr_d1_lsx_mex
     clear cp_pfdr_d1_lsx_mex
     %}
@@ -39,7 +43,8 @@ try
     % %{
     mex mex/cp_kmpp_d0_dist_mex.cpp ../src/cp_kmpp_d0_dist.cpp ...
         ../src/cut_pursuit_d0.cpp ../src/cut_pursuit.cpp ...
-        ../src/cp_graph.cpp -output bin/cp_kmpp_d0_dist_mex
+        ../src/cp_graph.cpp ../src/compressed_adjacency.cpp ...
+        -output bin/cp_kmpp_d0_dist_mex
     clear cp_kmpp_d0_dist_mex
     %}
 
@@ -37,9 +37,10 @@ mod = Extension(
         # list source files
         ["cpython/cp_pfdr_d1_lsx_py.cpp", "../src/cp_pfdr_d1_lsx.cpp",
          "../src/cut_pursuit_d1.cpp", "../src/cut_pursuit.cpp",
-         "../src/cp_graph.cpp", "../src/pfdr_d1_lsx.cpp",
-         "../src/proj_simplex.cpp", "../src/pfdr_graph_d1.cpp",
-         "../src/pcd_fwd_doug_rach.cpp", "../src/pcd_prox_split.cpp"], 
+         "../src/cp_graph.cpp", "../src/compressed_adjacency.cpp",
+         "../src/pfdr_d1_lsx.cpp", "../src/proj_simplex.cpp", "../src/pfdr_graph_d1.cpp",
+         "../src/pcd_fwd_doug_rach.cpp", "../src/pcd_prox_split.cpp",
+         "../src/pd_d1_lsx.cpp", "../src/pd_graph_d1.cpp"], 
         # Make sure to include the Numpy headers (not always necessary) 
         # TODO: check if necessary, because final libraries are HUGE
         include_dirs = [numpy.get_include()],
@@ -56,9 +57,11 @@ mod = Extension(
         # list source files
         ["cpython/cp_pfdr_d1_ql1b_py.cpp", "../src/cp_pfdr_d1_ql1b.cpp",
          "../src/cut_pursuit_d1.cpp", "../src/cut_pursuit.cpp",
-         "../src/cp_graph.cpp", "../src/pfdr_d1_ql1b.cpp",
-         "../src/matrix_tools.cpp", "../src/pfdr_graph_d1.cpp", 
-         "../src/pcd_fwd_doug_rach.cpp", "../src/pcd_prox_split.cpp"],
+         "../src/cp_graph.cpp", "../src/compressed_adjacency.cpp",
+         "../src/pfdr_d1_ql1b.cpp", "../src/matrix_tools.cpp", "../src/pfdr_graph_d1.cpp", 
+         "../src/pcd_fwd_doug_rach.cpp", "../src/pcd_prox_split.cpp",
+         "../src/pd_d1_ql1b.cpp", "../src/pd_graph_d1.cpp",
+         "../src/ssnal_d1_ql1b.cpp"],
         # Make sure to include the Numpy headers (not always necessary) 
         # TODO: check if necessary, because final libraries are HUGE
         include_dirs = [numpy.get_include()],
@@ -0,0 +1,113 @@
+/*=============================================================================
+ * Compressed forward-star adjacency of a graph
+ *===========================================================================*/
+#include <iostream>
+#include "../include/compressed_adjacency.hpp"
+
+#define TPL template <typename index_t>
+#define COMP_ADJ Compressed_adjacency<index_t>
+
+using namespace std;
+
+TPL COMP_ADJ::Compressed_adjacency(index_t V, const index_t* first_edge)
+    : V(V), first_edge(first_edge)
+{
+    /* most differences are expected to fit in one or two bytes */
+    max_bytes = (size_t) first_edge[V] + 1;
+    bytes = (uint8_t*) realloc_check(nullptr, max_bytes);
+    num_bytes = 0;
+    block_byte = (size_t*) realloc_check(nullptr,
+        sizeof(size_t)*((size_t) V/ADJ_BLOCK_SIZE + 1));
+    appended = 0;
+}
+
+TPL COMP_ADJ::Compressed_adjacency(index_t V, const index_t* first_edge,
+    const index_t* adj_vertices) : Compressed_adjacency(V, first_edge)
+{
+    for (index_t v = 0; v < V; v++){ append(adj_vertices + first_edge[v]); }
+    shrink_to_fit();
+}
+
+TPL COMP_ADJ::~Compressed_adjacency(){ free(bytes); free(block_byte); }
+
+TPL void* COMP_ADJ::realloc_check(void* ptr, size_t size)
+{
+    ptr = realloc(ptr, size);
+    if (!ptr){
+        cerr << "Compressed adjacency: not enough memory." << endl;
+        exit(EXIT_FAILURE);
+    }
+    return ptr;
+}
+
+TPL void COMP_ADJ::append(const index_t* adj_vertices_v)
+{
+    if (appended == V){
+        cerr << "Compressed adjacency: all " << V << " vertices have already "
+            "been appended." << endl;
+        exit(EXIT_FAILURE);
+    }
+
+    const index_t v = appended++;
+    if (v % ADJ_BLOCK_SIZE == 0){ block_byte[v/ADJ_BLOCK_SIZE] = num_bytes; }
+
+    const index_t deg = first_edge[v + 1] - first_edge[v];
+    /* at most ten bytes for 64-bit differences */
+    const size_t max_size = (sizeof(uintmax_t)*8 + 6)/7;
+    if (num_bytes + max_size*deg > max_bytes){
+        max_bytes += max_bytes/2 + max_size*deg;
+        bytes = (uint8_t*) realloc_check(bytes, max_bytes);
+    }
+
+    uintmax_t last = v;
+    for (index_t i = 0; i < deg; i++){
+        /* differences are computed modulo the range of uintmax_t */
+        uintmax_t dif = (uintmax_t) adj_vertices_v[i] - last;
+        last = adj_vertices_v[i];
+        uintmax_t zigzag = (dif << 1) ^
+            (~(dif >> (sizeof(uintmax_t)*8 - 1)) + 1);
+        while (zigzag >= 0x80){
+            bytes[num_bytes++] = (uint8_t) (zigzag | 0x80);
+            zigzag >>= 7;
+        }
+        bytes[num_bytes++] = (uint8_t) zigzag;
+    }
+}
+
+TPL void COMP_ADJ::shrink_to_fit()
+{
+    max_bytes = num_bytes ? num_bytes : 1;
+    bytes = (uint8_t*) realloc_check(bytes, max_bytes);
+}
+
+TPL COMP_ADJ::Decoder::Decoder(const Compressed_adjacency& adjacency,
+    index_t v) : first_edge(adjacency.first_edge), v(v)
+{
+    if (adjacency.appended < adjacency.V){
+        cerr << "Compressed adjacency: only " << adjacency.appended << " out "
+            "of " << adjacency.V << " vertices have been appended." << endl;
+        exit(EXIT_FAILURE);
+    }
+    /* start from the beginning of the block and skip preceding vertices */
+    index_t u = v - v % ADJ_BLOCK_SIZE;
+    byte = adjacency.bytes + adjacency.block_byte[u/ADJ_BLOCK_SIZE];
+    for (index_t skip = first_edge[v] - first_edge[u]; skip > 0; skip--){
+        while (*(byte++) & 0x80){}
+    }
+    e = first_edge[v];
+    last = v;
+}
+
+TPL void COMP_ADJ::decode(index_t v, index_t* adj_vertices_v) const
+{
+    Decoder decoder(*this, v);
+    const index_t deg = first_edge[v + 1] - first_edge[v];
+    for (index_t i = 0; i < deg; i++){ adj_vertices_v[i] = decoder.next(); }
+}
+
+TPL size_t COMP_ADJ::memory_size() const
+{ return num_bytes + sizeof(size_t)*((size_t) V/ADJ_BLOCK_SIZE + 1); }
+
+/**  instantiate for compilation  **/
+template class Compressed_adjacency<uint32_t>;
+template class Compressed_adjacency<uint64_t>;
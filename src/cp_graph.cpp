@@ -58,6 +58,137 @@ TPL CP_GRAPH::~Cp_graph()
     }
 }
 
+TPL void CP_GRAPH::reserve(index_t node_num_max, index_t edge_num_max)
+{
+    if (is_parallel_copy){
+        cerr << "Boykov & Kolmogorov graph: cannot reserve memory from a "
+            "parallel copy." << endl;
+        exit(EXIT_FAILURE);
+    }
+
+    size_t node_cap = node_max - nodes;
+    size_t arc_cap = arc_max - arcs;
+    size_t new_node_cap = node_cap, new_arc_cap = arc_cap;
+    if (node_num_max > node_cap){
+        new_node_cap = node_cap + node_cap/2;
+        if (new_node_cap < node_num_max){ new_node_cap = node_num_max; }
+    }
+    if (2*(size_t) edge_num_max > arc_cap){
+        new_arc_cap = arc_cap + arc_cap/2;
+        if (new_arc_cap < 2*(size_t) edge_num_max){
+            new_arc_cap = 2*(size_t) edge_num_max;
+        }
+    }
+    if (new_node_cap == node_cap && new_arc_cap == arc_cap){ return; }
+
+    /* copy into new arrays, and translate pointers between both; only the
+     * structure is translated, not the temporary states of maxflow() */
+    node* new_nodes = new_node_cap == node_cap ? nodes :
+        (node*) malloc(sizeof(node)*new_node_cap);
+    arc* new_arcs = new_arc_cap == arc_cap ? arcs :
+        (arc*) malloc(sizeof(arc)*new_arc_cap);
+    if (!new_nodes || !new_arcs){
+        cerr << "Boykov & Kolmogorov graph: not enough memory." << endl;
+        exit(EXIT_FAILURE);
+    }
+    const size_t node_size = node_last - nodes, arc_size = arc_last - arcs;
+    if (new_nodes != nodes){
+        for (size_t i = 0; i < node_size; i++){ new_nodes[i] = nodes[i]; }
+    }
+    if (new_arcs != arcs){
+        for (size_t a = 0; a < arc_size; a++){ new_arcs[a] = arcs[a]; }
+    }
+    for (size_t i = 0; i < node_size; i++){
+        node& n = new_nodes[i];
+        if (n.first){ n.first = new_arcs + (n.first - arcs); }
+        n.parent = nullptr; n.next = nullptr;
+    }
+    for (size_t a = 0; a < arc_size; a++){
+        arc& r = new_arcs[a];
+        r.head = new_nodes + (r.head - nodes);
+        if (r.next){ r.next = new_arcs + (r.next - arcs); }
+        r.sister = new_arcs + (r.sister - arcs);
+    }
+    if (new_nodes != nodes){ free(nodes); }
+    if (new_arcs != arcs){ free(arcs); }
+
+    nodes = new_nodes;
+    node_last = nodes + node_size;
+    node_max = nodes + new_node_cap;
+    arcs = new_arcs;
+    arc_last = arcs + arc_size;
+    arc_max = arcs + new_arc_cap;
+}
+
+TPL bool CP_GRAPH::detach_edge(index_t e)
+{
+    arc* a = arcs + (size_t) 2*e; // cast as size_t to avoid overflow
+    arc* a_rev = a + 1;
+    node* i = a_rev->head; // origin of the edge
+    node* j = a->head;
+    bool attached = false;
+    for (arc** p = &i->first; *p; p = &(*p)->next){
+        if (*p == a){ *p = a->next; attached = true; break; }
+    }
+    for (arc** p = &j->first; *p; p = &(*p)->next){
+        if (*p == a_rev){ *p = a_rev->next; attached = true; break; }
+    }
+    a->head = i;
+    a->next = a_rev->next = nullptr;
+    a->r_cap = a_rev->r_cap = ZERO;
+    return attached;
+}
+
+TPL void CP_GRAPH::insert_edges(const index_t* old_first_edge,
+    const index_t* first_edge, const index_t* adj_nodes)
+{
+    if (is_parallel_copy){
+        cerr << "Boykov & Kolmogorov graph: cannot insert edges from a "
+            "parallel copy." << endl;
+        exit(EXIT_FAILURE);
+    }
+
+    reserve(node_num, first_edge[node_num]);
+
+    /* arcs of current edges can only move forward, and the shift grows with
+     * the node index: move them starting from the last ones */
+    for (index_t i = node_num; i-- > 0;){
+        index_t shift = first_edge[i] - old_first_edge[i];
+        if (!shift){ break; }
+        for (index_t e = old_first_edge[i + 1]; e-- > old_first_edge[i];){
+            size_t a = (size_t) 2*e, b = (size_t) 2*(e + shift);
+            arcs[b] = arcs[a];
+            arcs[b + 1] = arcs[a + 1];
+        }
+    }
+
+    /* rebuild arcs lists in the order of add_edge() */
+    for (node* i = nodes; i < node_last; i++){ i->first = nullptr; }
+    for (index_t i = 0; i < node_num; i++){
+        index_t old_deg = old_first_edge[i + 1] - old_first_edge[i];
+        for (index_t e = first_edge[i]; e < first_edge[i + 1]; e++){
+            arc* a = arcs + (size_t) 2*e;
+            arc* a_rev = a + 1;
+            if (e - first_edge[i] >= old_deg){ /* new edge */
+                a->head = nodes + adj_nodes[e];
+                a_rev->head = nodes + i;
+                a->r_cap = a_rev->r_cap = ZERO;
+            }
+            a->sister = a_rev;
+            a_rev->sister = a;
+            if (a->head == a_rev->head){ /* detached edge */
+                a->next = a_rev->next = nullptr;
+                continue;
+            }
+            a->next = nodes[i].first;
+            nodes[i].first = a;
+            a_rev->next = a->head->first;
+            a->head->first = a_rev;
+        }
+    }
+    arc_last = arcs + (size_t) 2*first_edge[node_num];
+}
+
 /***********************************************************************/
 
 /*
@@ -409,7 +540,18 @@ TPL void CP_GRAPH::process_sink_orphan(node *i)
 
 /***********************************************************************/
 
-TPL void CP_GRAPH::maxflow(index_t comp_size, const index_t *comp_nodes)
+TPL void CP_GRAPH::maxflow(index_t comp_size, const index_t *comp_nodes,
+    Maxflow_engine engine)
+{
+    switch (engine){
+    case MAXFLOW_IBFS: maxflow_ibfs(comp_size, comp_nodes); break;
+    case MAXFLOW_PUSH_RELABEL:
+        maxflow_push_relabel(comp_size, comp_nodes); break;
+    default: maxflow_bk(comp_size, comp_nodes);
+    }
+}
+
+TPL void CP_GRAPH::maxflow_bk(index_t comp_size, const index_t *comp_nodes)
 {
 	node *i, *j, *current_node = nullptr;
 	arc *a;
@@ -536,6 +678,603 @@ TPL void CP_GRAPH::maxflow(index_t comp_size, const index_t *comp_nodes)
 
 /***********************************************************************/
 
+/*
+	Incremental breadth-first search (Goldberg, Hed, Kaplan, Tarjan & Werneck,
+	2011).
+	Both search trees are grown by whole layers: the label DIST of a node is
+	its distance to the terminal along the tree, always equal to the label of
+	its parent plus one; the nodes of the current layer of a tree are listed
+	in buckets by labels, and a pass over them builds the next layer, the
+	tree with the smaller current layer being grown first; nodes are scanned
+	by increasing labels, so that a residual arc within a tree never goes up
+	more than one layer. When a residual arc reaches the other tree, flow is
+	augmented along the path, and orphans are adopted by increasing labels:
+	an orphan first looks for a parent in the layer just below its own,
+	which is then known to be rooted at the terminal; failing that, its
+	children become orphans, and it is relabeled after the neighbor with
+	lowest label, which becomes its parent unless it is itself an orphan, in
+	which case the search is done again at the new label; if the new label is
+	beyond the layers built so far, the orphan becomes free.
+	Nodes of both trees which have already been scanned never have residual
+	arcs toward free nodes; when a node is freed, its neighbors in the trees
+	which have such arcs are thus listed again for scanning. Hence, when the
+	current layer of a tree is empty, no augmenting path remains; the source
+	side of the cut is then retrieved as the set of nodes reachable from the
+	source in the residual graph, as for the other engines.
+*/
+
+TPL inline void CP_GRAPH::set_orphan_bucket(node *i)
+{
+	nodeptr *np;
+	if (i->DIST >= orphan_bucket_size)
+	{
+		/* labels are usually bounded by the number of nodes; grow buckets */
+		index_t size = orphan_bucket_size;
+		orphan_bucket_size = 2*i->DIST;
+		orphan_bucket = (nodeptr**) realloc(orphan_bucket,
+			sizeof(nodeptr*)*orphan_bucket_size);
+		if (!orphan_bucket) {
+			cerr << "Boykov & Kolmogorov graph: not enough memory." << endl;
+			exit(EXIT_FAILURE);
+		}
+		for (; size<orphan_bucket_size; size++) orphan_bucket[size] = nullptr;
+	}
+	i -> parent = ORPHAN;
+	np = nodeptr_block -> New();
+	np -> ptr = i;
+	np -> next = orphan_bucket[i->DIST];
+	orphan_bucket[i->DIST] = np;
+	if (i->DIST < orphan_bucket_first) orphan_bucket_first = i -> DIST;
+	if (i->DIST > orphan_bucket_last) orphan_bucket_last = i -> DIST;
+}
+
+TPL inline void CP_GRAPH::set_layer(node *i)
+{
+	nodeptr *np;
+	const int t = i -> is_sink;
+	if (i->DIST >= scan_bucket_size[t])
+	{
+		index_t size = scan_bucket_size[t];
+		scan_bucket_size[t] = 2*i->DIST;
+		scan_bucket[t] = (nodeptr**) realloc(scan_bucket[t],
+			sizeof(nodeptr*)*scan_bucket_size[t]);
+		if (!scan_bucket[t]) {
+			cerr << "Boykov & Kolmogorov graph: not enough memory." << endl;
+			exit(EXIT_FAILURE);
+		}
+		for (; size<scan_bucket_size[t]; size++) scan_bucket[t][size] = nullptr;
+	}
+	np = nodeptr_block -> New();
+	np -> ptr = i;
+	np -> next = scan_bucket[t][i->DIST];
+	scan_bucket[t][i->DIST] = np;
+	if (i->DIST > layer_dist[t])
+	{
+		next_num[t]++;
+	}
+	else
+	{
+		scan_num[t]++;
+		if (i->DIST < scan_first[t]) scan_first[t] = i -> DIST;
+	}
+}
+
+TPL void CP_GRAPH::process_ibfs_orphan(node *i)
+{
+	node *j;
+	arc *a0, *a0_min = nullptr, *a;
+	const bool sink = i -> is_sink;
+	const index_t d = i -> DIST;
+	index_t d_min = INFINITE_D;
+
+	/* trying to find a new parent in the layer below */
+	for (a0=i->first; a0; a0=a0->next)
+	if ((sink ? a0->r_cap : a0->sister->r_cap) > ZERO)
+	{
+		j = a0 -> head;
+		if (j->is_sink == sink && (a=j->parent) && a!=ORPHAN &&
+		    j->DIST == d - 1)
+		{
+			i -> parent = a0;
+			return;
+		}
+	}
+
+	/* relabel; children become orphans first, so that they cannot be taken
+	 * as parent */
+	for (a0=i->first; a0; a0=a0->next)
+	{
+		/* negative value indicate active edge in the cut-pursuit sense,
+		 * and thus a0 link to another component */
+		if (a0->r_cap < ZERO){ continue; }
+
+		j = a0 -> head;
+		if (j->is_sink == sink && (a=j->parent) && a!=TERMINAL &&
+		    a!=ORPHAN && a->head==i)
+		{
+			set_orphan_bucket(j); // children have higher labels
+		}
+	}
+	/* orphans not processed yet have labels at least d, which can only
+	 * increase, and are thus lower bounds on their final labels */
+	bool min_orphan = false;
+	for (a0=i->first; a0; a0=a0->next)
+	if ((sink ? a0->r_cap : a0->sister->r_cap) > ZERO)
+	{
+		j = a0 -> head;
+		if (j->is_sink == sink && j->parent &&
+		    (j->DIST < d_min || (j->DIST == d_min && min_orphan)))
+		{
+			a0_min = a0;
+			d_min = j -> DIST;
+			min_orphan = j->parent == ORPHAN;
+		}
+	}
+
+	/* labels cannot go beyond the layer being built */
+	const index_t d_max = layer_dist[sink] + (growing == (int) sink);
+	if (a0_min && d_min < d_max)
+	{
+		i -> DIST = d_min + 1;
+		if (i->DIST >= layer_dist[sink]) set_layer(i); // not scanned yet
+		if (min_orphan)
+		{	/* look for a parent again once orphans below are processed */
+			set_orphan_bucket(i);
+		}
+		else
+		{
+			i -> parent = a0_min;
+		}
+	}
+	else
+	{
+		/* i becomes free; nodes of both trees with a residual arc toward i
+		 * must be scanned again */
+		i -> parent = nullptr;
+		for (a0=i->first; a0; a0=a0->next)
+		{
+			j = a0 -> head;
+			if (j->parent &&
+			    (j->is_sink ? a0->r_cap : a0->sister->r_cap) > ZERO)
+			{
+				set_layer(j);
+			}
+		}
+	}
+}
+
+TPL void CP_GRAPH::maxflow_ibfs(index_t comp_size, const index_t *comp_nodes)
+{
+	node *i, *j;
+	arc *a;
+	nodeptr *np;
+	index_t ii;
+	const index_t iimax = comp_size ? comp_size : node_num;
+
+	if (!nodeptr_block)
+	{
+		nodeptr_block = new DBlock<nodeptr>(NODEPTR_BLOCK_SIZE);
+	}
+
+	/* labels are usually at most the number of nodes in a tree */
+	orphan_bucket_size = iimax + 2;
+	orphan_bucket = (nodeptr**) malloc(sizeof(nodeptr*)*orphan_bucket_size);
+	node **queue = (node**) malloc(sizeof(node*)*iimax);
+	if (!orphan_bucket || !queue) {
+		cerr << "Boykov & Kolmogorov graph: not enough memory." << endl;
+		exit(EXIT_FAILURE);
+	}
+	for (index_t d=0; d<orphan_bucket_size; d++) orphan_bucket[d] = nullptr;
+	orphan_first = orphan_last = nullptr;
+
+	/* the first layers are the nodes linked to the terminals */
+	for (int t=0; t<2; t++)
+	{
+		layer_dist[t] = 1;
+		scan_num[t] = next_num[t] = 0;
+		scan_first[t] = 1;
+		scan_bucket_size[t] = 4;
+		scan_bucket[t] = (nodeptr**) malloc(sizeof(nodeptr*)*4);
+		if (!scan_bucket[t]) {
+			cerr << "Boykov & Kolmogorov graph: not enough memory." << endl;
+			exit(EXIT_FAILURE);
+		}
+		for (index_t d=0; d<4; d++) scan_bucket[t][d] = nullptr;
+	}
+	growing = -1;
+	for (ii=0; ii<iimax; ii++)
+	{
+		i = (comp_nodes) ? (nodes + comp_nodes[ii]) : (nodes + ii);
+		i -> next = nullptr;
+		if (i->tr_cap != ZERO)
+		{
+			i -> is_sink = i->tr_cap < ZERO;
+			i -> parent = TERMINAL;
+			i -> DIST = 1;
+			set_layer(i);
+		}
+		else
+		{
+			i -> parent = nullptr;
+		}
+	}
+
+	// main loop
+	while ( 1 )
+	{
+		/* grow the tree with the smaller current layer; if it is empty, the
+		 * tree cannot grow anymore, and no augmenting path remains */
+		const int t = scan_num[1] < scan_num[0];
+		if (!scan_num[t]) break;
+		growing = t;
+
+		/* nodes are scanned by increasing labels, so that labels are exact
+		 * distances along residual arcs within the tree; nodes listed again
+		 * for scanning can have labels lower than the current layer */
+		while (scan_num[t])
+		{
+			while (!scan_bucket[t][scan_first[t]]) scan_first[t]++;
+			np = scan_bucket[t][scan_first[t]];
+			scan_bucket[t][scan_first[t]] = np -> next;
+			scan_num[t]--;
+			i = np -> ptr;
+			nodeptr_block -> Delete(np);
+
+			/* scan i as long as it stays in the layers built so far */
+			a = i -> first;
+			while (a && i->parent && i->is_sink == t &&
+			       i->DIST <= layer_dist[t])
+			{
+				if ((t ? a->sister->r_cap : a->r_cap) > ZERO)
+				{
+					j = a -> head;
+					if (!j->parent)
+					{
+						j -> is_sink = t;
+						j -> parent = a -> sister;
+						j -> DIST = i -> DIST + 1;
+						set_layer(j);
+					}
+					else if (j->is_sink != t)
+					{
+						augment(t ? a->sister : a);
+
+						/* move orphans of the augmenting path into buckets */
+						orphan_bucket_first = INFINITE_D;
+						orphan_bucket_last = 0;
+						while ((np=orphan_first))
+						{
+							orphan_first = np -> next;
+							j = np -> ptr;
+							nodeptr_block -> Delete(np);
+							set_orphan_bucket(j);
+						}
+						orphan_last = nullptr;
+
+						/* adoption, by increasing labels */
+						for (index_t d=orphan_bucket_first;
+						     d<=orphan_bucket_last; d++)
+						{
+							while ((np=orphan_bucket[d]))
+							{
+								orphan_bucket[d] = np -> next;
+								j = np -> ptr;
+								nodeptr_block -> Delete(np);
+								process_ibfs_orphan(j);
+							}
+						}
+						/* adoption end */
+
+						/* nodes with lower labels might have been listed
+						 * again, they must be scanned first */
+						if (scan_first[t] < i->DIST && i->parent &&
+						    i->is_sink == t){ set_layer(i); break; }
+
+						continue; // the arc might still be residual
+					}
+				}
+				a = a -> next;
+			}
+		}
+
+		/* the next layer becomes the current one */
+		layer_dist[t]++;
+		scan_num[t] = next_num[t];
+		next_num[t] = 0;
+		scan_first[t] = layer_dist[t];
+		growing = -1;
+	}
+
+	/* source side: reachable from the source in the residual graph */
+	index_t q_first = 0, q_last = 0;
+	for (ii=0; ii<iimax; ii++)
+	{
+		i = (comp_nodes) ? (nodes + comp_nodes[ii]) : (nodes + ii);
+		if (i->tr_cap > ZERO)
+		{
+			i -> is_sink = false;
+			i -> parent = TERMINAL;
+			queue[q_last++] = i;
+		}
+		else
+		{
+			i -> parent = nullptr;
+		}
+	}
+	while (q_first < q_last)
+	{
+		i = queue[q_first++];
+		for (a=i->first; a; a=a->next)
+		if (a->r_cap > ZERO)
+		{
+			j = a -> head;
+			if (!j->parent)
+			{
+				j -> is_sink = false;
+				j -> parent = TERMINAL;
+				queue[q_last++] = j;
+			}
+		}
+	}
+
+	free(queue);
+	free(orphan_bucket);
+	free(scan_bucket[0]);
+	free(scan_bucket[1]);
+	{
+		delete nodeptr_block; 
+		nodeptr_block = nullptr; 
+	}
+}
+
+/***********************************************************************/
+
+/*
+	Highest-label push-relabel.
+	Only the first phase is performed, computing a maximum preflow: the
+	excess of a node is its positive terminal residual capacity tr_cap, and
+	when flow reaches a node with negative tr_cap, it is directly pushed to
+	the sink. The labels are lower bounds on the distance to the sink in the
+	residual graph; nodes with label greater than the number of nodes cannot
+	reach it and are discarded, as well as nodes above a label that no node
+	holds anymore (gap heuristic). The cut is then retrieved as the set of
+	nodes reachable in the residual graph from nodes with remaining excess,
+	which is the source side of the same minimum cut as the other engines.
+*/
+
+TPL inline void CP_GRAPH::set_label(node *i, index_t d)
+{
+	index_t ii = i -> TS;
+	label_next[ii] = label_first[d];
+	label_prev[ii] = INFINITE_D;
+	if (label_first[d] != INFINITE_D) label_prev[label_first[d]] = ii;
+	label_first[d] = ii;
+	i -> DIST = d;
+}
+
+TPL inline void CP_GRAPH::unset_label(node *i)
+{
+	index_t ii = i -> TS;
+	index_t prev = label_prev[ii], next = label_next[ii];
+	if (prev != INFINITE_D) label_next[prev] = next;
+	else                    label_first[i->DIST] = next;
+	if (next != INFINITE_D) label_prev[next] = prev;
+}
+
+TPL void CP_GRAPH::global_relabel(index_t comp_size, const index_t *comp_nodes,
+	node **queue, index_t &highest, index_t &max_label)
+{
+	node *i, *j;
+	arc *a;
+	const index_t dead = comp_size + 1;
+	index_t ii, q_first = 0, q_last = 0;
+
+	for (ii=0; ii<=comp_size; ii++)
+	{
+		active_bucket[ii] = nullptr;
+		label_first[ii] = INFINITE_D;
+	}
+
+	for (ii=0; ii<comp_size; ii++)
+	{
+		i = (comp_nodes) ? (nodes + comp_nodes[ii]) : (nodes + ii);
+		if (i->tr_cap < ZERO)
+		{
+			set_label(i, 1);
+			queue[q_last++] = i;
+		}
+		else
+		{
+			i -> DIST = dead;
+		}
+	}
+
+	/* reverse breadth-first search from the sink */
+	while (q_first < q_last)
+	{
+		i = queue[q_first++];
+		for (a=i->first; a; a=a->next)
+		if (a->sister->r_cap > ZERO)
+		{
+			j = a -> head;
+			if (j->DIST == dead)
+			{
+				set_label(j, i->DIST + 1);
+				queue[q_last++] = j;
+			}
+		}
+	}
+	max_label = q_last ? queue[q_last - 1]->DIST : 0;
+
+	/* rebuild buckets of active nodes */
+	highest = 0;
+	for (ii=0; ii<comp_size; ii++)
+	{
+		i = (comp_nodes) ? (nodes + comp_nodes[ii]) : (nodes + ii);
+		i -> parent = i -> first; /* current arc */
+		if (i->tr_cap > ZERO && i->DIST < dead)
+		{
+			i -> next = active_bucket[i->DIST];
+			active_bucket[i->DIST] = i;
+			if (i->DIST > highest) highest = i -> DIST;
+		}
+	}
+}
+
+TPL void CP_GRAPH::maxflow_push_relabel(index_t comp_size,
+	const index_t *comp_nodes)
+{
+	node *i, *j;
+	arc *a;
+	real_t delta;
+	index_t ii, d, highest, max_label;
+	const index_t iimax = comp_size ? comp_size : node_num;
+	const index_t dead = iimax + 1;
+	/* global relabeling is performed after a linear amount of work */
+	size_t work = 0;
+	const size_t work_max = 12*(size_t) iimax + (arc_last - arcs)/2;
+
+	node **queue = (node**) malloc(sizeof(node*)*iimax);
+	active_bucket = (node**) malloc(sizeof(node*)*(iimax + 1));
+	label_first = (index_t*) malloc(sizeof(index_t)*(iimax + 1));
+	label_next = (index_t*) malloc(sizeof(index_t)*iimax);
+	label_prev = (index_t*) malloc(sizeof(index_t)*iimax);
+	if (!queue || !active_bucket || !label_first || !label_next ||
+		!label_prev) {
+		cerr << "Boykov & Kolmogorov graph: not enough memory." << endl;
+		exit(EXIT_FAILURE);
+	}
+
+	/* positions in the component, for the lists of nodes by label */
+	for (ii=0; ii<iimax; ii++)
+	{
+		i = (comp_nodes) ? (nodes + comp_nodes[ii]) : (nodes + ii);
+		i -> TS = ii;
+	}
+
+	global_relabel(iimax, comp_nodes, queue, highest, max_label);
+
+	while (highest > 0)
+	{
+		if (!(i=active_bucket[highest])) { highest--; continue; }
+		active_bucket[highest] = i -> next;
+		if (i->DIST != highest) continue; // discarded by a gap
+
+		/* discharge i */
+		while (i->tr_cap > ZERO)
+		{
+			/* push along admissible arcs */
+			for (a=i->parent; a; a=a->next)
+			if (a->r_cap > ZERO && a->head->DIST + 1 == i->DIST)
+			{
+				j = a -> head;
+				delta = a->r_cap < i->tr_cap ? a->r_cap : i->tr_cap;
+				a -> r_cap -= delta;
+				a -> sister -> r_cap += delta;
+				i -> tr_cap -= delta;
+				if (j->tr_cap > ZERO)
+				{
+					j -> tr_cap += delta;
+				}
+				else if ((j->tr_cap += delta) > ZERO)
+				{
+					/* j becomes active, its label is less than highest */
+					j -> next = active_bucket[j->DIST];
+					active_bucket[j->DIST] = j;
+				}
+				if (!(i->tr_cap > ZERO)) break;
+			}
+			i -> parent = a;
+			if (a) break; // i is not active anymore
+
+			/* relabel */
+			d = dead;
+			for (a=i->first; a; a=a->next)
+			{
+				if (a->r_cap > ZERO && a->head->DIST < d)
+				{
+					d = a -> head -> DIST;
+				}
+				work++;
+			}
+			work += 12;
+			unset_label(i);
+			if (label_first[i->DIST] == INFINITE_D)
+			{
+				/* gap: nodes with higher labels cannot reach the sink */
+				for (index_t gap=i->DIST+1; gap<=max_label; gap++)
+				{
+					for (ii=label_first[gap]; ii!=INFINITE_D; ii=label_next[ii])
+					{
+						j = (comp_nodes) ? (nodes + comp_nodes[ii])
+						                 : (nodes + ii);
+						j -> DIST = dead;
+					}
+					label_first[gap] = INFINITE_D;
+				}
+				max_label = i -> DIST - 1;
+				i -> DIST = dead;
+				if (highest > max_label) highest = max_label;
+				break;
+			}
+			if (d + 1 >= dead) { i -> DIST = dead; break; }
+			set_label(i, d + 1);
+			i -> parent = i -> first;
+			if (i->DIST > max_label) max_label = i -> DIST;
+			if (i->DIST > highest) highest = i -> DIST;
+
+			if (work > work_max)
+			{
+				/* labels might be loose, compute exact ones */
+				work = 0;
+				global_relabel(iimax, comp_nodes, queue, highest, max_label);
+				break;
+			}
+		}
+	}
+
+	/* source side: reachable from nodes with remaining excess */
+	index_t q_first = 0, q_last = 0;
+	for (ii=0; ii<iimax; ii++)
+	{
+		i = (comp_nodes) ? (nodes + comp_nodes[ii]) : (nodes + ii);
+		i -> next = nullptr;
+		if (i->tr_cap > ZERO)
+		{
+			i -> is_sink = false;
+			i -> parent = TERMINAL;
+			queue[q_last++] = i;
+		}
+		else
+		{
+			i -> parent = nullptr;
+		}
+	}
+	while (q_first < q_last)
+	{
+		i = queue[q_first++];
+		for (a=i->first; a; a=a->next)
+		if (a->r_cap > ZERO)
+		{
+			j = a -> head;
+			if (!j->parent)
+			{
+				j -> is_sink = false;
+				j -> parent = TERMINAL;
+				queue[q_last++] = j;
+			}
+		}
+	}
+
+	free(queue);
+	free(active_bucket);
+	free(label_first);
+	free(label_next);
+	free(label_prev);
+}
+
+/***********************************************************************/
+
 
 /* instantiate for compilation */
 template class Cp_graph<float, uint32_t, uint16_t>;
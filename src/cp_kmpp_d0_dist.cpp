@@ -10,6 +10,9 @@
 #define HALF ((real_t) 0.5)
 #define INF_REAL (std::numeric_limits<real_t>::infinity())
 #define VERT_WEIGHTS_(v) (vert_weights ? vert_weights[(v)] : ONE)
+#define Y_(vd) (Y ? Y[(vd)] : quantized_Y[(vd)])
+#define DIST_TO_Y_(Xv, v) (Y ? distance((Xv), Y + D*(v)) : \
+    distance((Xv), quantized_Y + D*(v)))
 
 #define TPL template <typename real_t, typename index_t, typename comp_t>
 #define CP_D0_DIST Cp_d0_dist<real_t, index_t, comp_t>
@@ -17,7 +20,7 @@
 using namespace std;
 
 TPL CP_D0_DIST::Cp_d0_dist(index_t V, index_t E, const index_t* first_edge,
-    const index_t* adj_vertices, const real_t* Y, size_t D) :
+    Adj_vertices<index_t> adj_vertices, const real_t* Y, size_t D) :
     Cp_d0<real_t, index_t, comp_t>(V, E, first_edge, adj_vertices, D), Y(Y)
 {
     vert_weights = coor_weights = nullptr;
@@ -42,7 +45,7 @@ TPL void CP_D0_DIST::set_loss(real_t loss, const real_t* Y,
     }
     if (loss == ZERO){ loss = eps; } // avoid singularities
     this->loss = loss;
-    if (Y){ this->Y = Y; }
+    if (Y){ this->Y = Y; quantized_Y = Quantized_array<real_t>(); }
     this->vert_weights = vert_weights;
     this->coor_weights = coor_weights; 
     /* recompute the constant dist(Y, Y) if necessary */
@@ -51,12 +54,20 @@ TPL void CP_D0_DIST::set_loss(real_t loss, const real_t* Y,
         #pragma omp parallel for schedule(static) NUM_THREADS(V*D, V) \
             reduction(+:fYY)
         for (index_t v = 0; v < V; v++){
-            const real_t* Yv = Y + D*v;
-            fYY += VERT_WEIGHTS_(v)*distance(Yv, Yv);
+            fYY += VERT_WEIGHTS_(v)*(this->Y ?
+                distance(this->Y + D*v, this->Y + D*v) :
+                distance(quantized_Y + D*v, quantized_Y + D*v));
         }
     }
 }
 
+TPL void CP_D0_DIST::set_quantized_observations(Quantized_array<real_t> Y)
+{
+    this->Y = nullptr;
+    quantized_Y = Y;
+    set_loss(loss, nullptr, vert_weights, coor_weights); // recompute fYY
+}
+
 TPL void CP_D0_DIST::set_kmpp_param(int kmpp_init_num, int kmpp_iter_num)
 {
     this->kmpp_init_num = kmpp_init_num;
@@ -64,7 +75,10 @@ TPL void CP_D0_DIST::set_kmpp_param(int kmpp_init_num, int kmpp_iter_num)
 }
 
 TPL real_t CP_D0_DIST::fv(index_t v, const real_t* Xv)
-{ return VERT_WEIGHTS_(v)*distance(Y + D*v, Xv); }
+{
+    return VERT_WEIGHTS_(v)*(Y ? distance(Y + D*v, Xv) :
+        distance(quantized_Y + D*v, Xv));
+}
 
 TPL real_t CP_D0_DIST::compute_f()
 {
@@ -86,8 +100,9 @@ TPL void CP_D0_DIST::solve_reduced_problem()
         for (index_t i = first_vertex[rv]; i < first_vertex[rv + 1]; i++){
             index_t v = comp_list[i];
             comp_weights[rv] += VERT_WEIGHTS_(v);
-            const real_t* Yv = Y + D*v;
-            for (size_t d = 0; d < D; d++){ rXv[d] += VERT_WEIGHTS_(v)*Yv[d]; }
+            for (size_t d = 0; d < D; d++){
+                rXv[d] += VERT_WEIGHTS_(v)*Y_(D*v + d);
+            }
         }
         if (comp_weights[rv]){
             for (size_t d = 0; d < D; d++){ rXv[d] /= comp_weights[rv]; }
@@ -95,11 +110,9 @@ TPL void CP_D0_DIST::solve_reduced_problem()
     }
 }
 
-TPL void CP_D0_DIST::init_split_values(comp_t rv, real_t* altX,
-    comp_t* label_assign)
+TPL void CP_D0_DIST::init_split_values(index_t comp_size,
+    const index_t* comp_vertices, real_t* altX, comp_t* label_assign)
 {
-    index_t comp_size = first_vertex[rv + 1] - first_vertex[rv];
-
     /* distance map and random device for k-means++ */
     real_t* nearest_dist = (real_t*) malloc_check(sizeof(real_t)*comp_size);
     default_random_engine rand_gen; // default seed also enough for our purpose
@@ -123,10 +136,10 @@ TPL void CP_D0_DIST::init_split_values(comp_t rv, real_t* altX,
                 rand_i = unif_distr(rand_gen);
             }else{
                 for (index_t i = 0; i < comp_size; i++){
-                    index_t v = comp_list[first_vertex[rv] + i];
+                    index_t v = comp_vertices[i];
                     nearest_dist[i] = INF_REAL;
                     for (comp_t l = 0; l < k; l++){
-                        real_t dist = distance(centroids + D*l, Y + D*v);
+                        real_t dist = DIST_TO_Y_(centroids + D*l, v);
                         if (loss != QUADRATIC){ dist -= bottom_dist[l]; }
                         if (dist < nearest_dist[i]){ nearest_dist[i] = dist; }
                     }
@@ -136,21 +149,20 @@ TPL void CP_D0_DIST::init_split_values(comp_t rv, real_t* altX,
                     nearest_dist + comp_size);
                 rand_i = dist_distr(rand_gen);
             }
-            index_t rand_v = comp_list[first_vertex[rv] + rand_i];
-            const real_t* Yv = Y + D*rand_v;
+            index_t rand_v = comp_vertices[rand_i];
             real_t* Ck = centroids + D*k;
-            for (size_t d = 0; d < D; d++){ Ck[d] = Yv[d]; }
+            for (size_t d = 0; d < D; d++){ Ck[d] = Y_(D*rand_v + d); }
             if (loss != QUADRATIC){ bottom_dist[k] = distance(Ck, Ck); }
         } // end for k
 
         /**  k-means  **/
         for (int kmpp_iter = 0; kmpp_iter < kmpp_iter_num; kmpp_iter++){
             /* assign clusters to centroids */
-            for (index_t i = first_vertex[rv]; i < first_vertex[rv + 1]; i++){
-                index_t v = comp_list[i];
+            for (index_t i = 0; i < comp_size; i++){
+                index_t v = comp_vertices[i];
                 real_t min_dist = INF_REAL;
                 for (comp_t k = 0; k < K; k++){
-                    real_t dist = distance(centroids + D*k, Y + D*v);
+                    real_t dist = DIST_TO_Y_(centroids + D*k, v);
                     if (dist < min_dist){
                         min_dist = dist;
                         label_assign[v] = k;
@@ -158,21 +170,22 @@ TPL void CP_D0_DIST::init_split_values(comp_t rv, real_t* altX,
                 }
             }
             /* update centroids of clusters */
-            update_split_values(rv, centroids, label_assign);
+            update_split_values(comp_size, comp_vertices, centroids,
+                label_assign);
         }
 
         /**  compare resulting sum of distances and keep the best one  **/
         real_t sum_dist = ZERO;
-        for (index_t i = first_vertex[rv]; i < first_vertex[rv + 1]; i++){
-            index_t v = comp_list[i];
+        for (index_t i = 0; i < comp_size; i++){
+            index_t v = comp_vertices[i];
             comp_t k = label_assign[v];
-            sum_dist += VERT_WEIGHTS_(v)*distance(centroids + D*k, Y + D*v);
+            sum_dist += VERT_WEIGHTS_(v)*DIST_TO_Y_(centroids + D*k, v);
         }
         if (sum_dist < min_sum_dist){
             min_sum_dist = sum_dist;
             for (size_t dk = 0; dk < D*K; dk++){ altX[dk] = centroids[dk]; }
-            for (index_t i = first_vertex[rv]; i < first_vertex[rv + 1]; i++){
-                index_t v = comp_list[i];
+            for (index_t i = 0; i < comp_size; i++){
+                index_t v = comp_vertices[i];
                 set_tmp_comp_assign(v, label_assign[v]);
             }
         }
@@ -184,14 +197,14 @@ TPL void CP_D0_DIST::init_split_values(comp_t rv, real_t* altX,
     free(nearest_dist);
 
     /**  copy best label assignment  **/
-    for (index_t i = first_vertex[rv]; i < first_vertex[rv + 1]; i++){
-        index_t v = comp_list[i];
+    for (index_t i = 0; i < comp_size; i++){
+        index_t v = comp_vertices[i];
         label_assign[v] = get_tmp_comp_assign(v);
     }
 }
 
-TPL void CP_D0_DIST::update_split_values(comp_t rv, real_t* altX,
-    comp_t* label_assign)
+TPL void CP_D0_DIST::update_split_values(index_t comp_size,
+    const index_t* comp_vertices, real_t* altX, comp_t* label_assign)
 {
     real_t* total_weights = (real_t*) malloc_check(sizeof(real_t)*K);
     for (comp_t k = 0; k < K; k++){
@@ -199,13 +212,14 @@ TPL void CP_D0_DIST::update_split_values(comp_t rv, real_t* altX,
         real_t* altXk = altX + D*k;
         for (size_t d = 0; d < D; d++){ altXk[d] = ZERO; }
     }
-    for (index_t i = first_vertex[rv]; i < first_vertex[rv + 1]; i++){
-        index_t v = comp_list[i];
+    for (index_t i = 0; i < comp_size; i++){
+        index_t v = comp_vertices[i];
         comp_t k = label_assign[v];
         total_weights[k] += VERT_WEIGHTS_(v);
-        const real_t* Yv = Y + D*v;
         real_t* altXk = altX + D*k;
-        for (size_t d = 0; d < D; d++){ altXk[d] += VERT_WEIGHTS_(v)*Yv[d]; }
+        for (size_t d = 0; d < D; d++){
+            altXk[d] += VERT_WEIGHTS_(v)*Y_(D*v + d);
+        }
     }
     for (comp_t k = 0; k < K; k++){
         real_t* altXk = altX + D*k;
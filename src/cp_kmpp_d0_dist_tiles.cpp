@@ -0,0 +1,352 @@
+/*=============================================================================
+ * Out-of-core cut-pursuit with separable distance and contour length, by
+ * tiles stitched together
+ *===========================================================================*/
+#include <future>
+#include <algorithm>
+#include "../include/cp_kmpp_d0_dist_tiles.hpp"
+
+#define ZERO ((real_t) 0.0)
+#define ONE ((real_t) 1.0)
+
+#define TPL template <typename real_t, typename index_t, typename comp_t>
+#define CP_TILES Cp_d0_dist_tiles<real_t, index_t, comp_t>
+
+using namespace std;
+
+TPL CP_TILES::Tile::Tile() : V(0), E(0), core_V(0), first_edge(nullptr),
+    adj_vertices(nullptr), Y(nullptr), vert_weights(nullptr),
+    edge_weights(nullptr), global_index(nullptr){}
+
+TPL CP_TILES::Cp_d0_dist_tiles(size_t tile_num, size_t D)
+    : tile_num(tile_num), D(D)
+{
+    loss = QUADRATIC;
+    coor_weights = nullptr;
+    homo_edge_weight = ONE;
+    verbose = false;
+
+    comp_num = comp_cap = edge_num = edge_cap = seam_num = seam_cap = 0;
+    comp_weights = comp_sums = nullptr;
+    comp_edges = nullptr;
+    seam_vertices = nullptr;
+
+    rV = 0;
+    stitched = nullptr;
+    values = nullptr;
+}
+
+TPL CP_TILES::~Cp_d0_dist_tiles()
+{
+    free(comp_weights); free(comp_sums); free(comp_edges);
+    free(seam_vertices); free(stitched); free(values);
+}
+
+TPL void CP_TILES::set_loss(real_t loss, const real_t* coor_weights)
+{
+    if (loss < ZERO || loss > ONE){
+        cerr << "Cut-pursuit d0 distance tiles: loss parameter should be "
+            "between 0 and 1 (" << loss << " given)." << endl;
+        exit(EXIT_FAILURE);
+    }
+    this->loss = loss;
+    this->coor_weights = coor_weights;
+}
+
+TPL void CP_TILES::set_edge_weights(real_t homo_edge_weight)
+{ this->homo_edge_weight = homo_edge_weight; }
+
+TPL void CP_TILES::set_verbose(bool verbose){ this->verbose = verbose; }
+
+TPL void* CP_TILES::realloc_check(void* ptr, size_t size)
+{
+    ptr = realloc(ptr, size ? size : 1);
+    if (!ptr){
+        cerr << "Cut-pursuit d0 distance tiles: not enough memory." << endl;
+        exit(EXIT_FAILURE);
+    }
+    return ptr;
+}
+
+TPL void CP_TILES::free_tile(Tile& tile)
+{
+    free(tile.first_edge); free(tile.adj_vertices); free(tile.Y);
+    free(tile.vert_weights); free(tile.edge_weights); free(tile.global_index);
+    tile = Tile();
+}
+
+TPL uint64_t CP_TILES::solve()
+{
+    comp_num = edge_num = seam_num = 0;
+
+    /* the next tile is loaded while the current one is solved */
+    Tile tiles[2];
+    if (tile_num){ load_tile(0, tiles[0]); }
+    for (size_t t = 0; t < tile_num; t++){
+        Tile& next = tiles[(t + 1) % 2];
+        future<void> loading;
+        if (t + 1 < tile_num){
+            loading = async(launch::async, [this, t, &next]()
+                { load_tile(t + 1, next); });
+        }
+
+        solve_tile(t, tiles[t % 2]);
+        free_tile(tiles[t % 2]);
+
+        if (loading.valid()){ loading.get(); }
+    }
+
+    stitch();
+
+    return rV;
+}
+
+TPL void CP_TILES::solve_tile(size_t t, Tile& tile)
+{
+    const index_t V = tile.V, core_V = tile.core_V;
+    const index_t* first_edge = tile.first_edge;
+    const index_t* adj_vertices = tile.adj_vertices;
+    const uint64_t* global_index = tile.global_index;
+
+    if (verbose){
+        cout << "Tile " << t + 1 << " (out of " << tile_num << "), " << core_V
+            << " core vertices, " << V - core_V << " halo vertices... "
+            << flush;
+    }
+
+    /**  solve over the whole tile  **/
+    Cp_d0_dist<real_t, index_t, comp_t>* cp =
+        new Cp_d0_dist<real_t, index_t, comp_t>(V, tile.E, first_edge,
+            adj_vertices, tile.Y, D);
+    cp->set_loss(loss, nullptr, tile.vert_weights, coor_weights);
+    cp->set_edge_weights(tile.edge_weights, homo_edge_weight);
+    cp->set_cp_param(ZERO, 10, 0);
+    configure(*cp);
+    cp->cut_pursuit();
+    comp_t* comp_assign;
+    cp->get_components(&comp_assign);
+
+    /**  components over the core, which might be disconnected without the
+     **  halo; connected components by union-find along core edges, the root
+     **  of each being the vertex with lowest index  **/
+    index_t* root = (index_t*) realloc_check(nullptr, sizeof(index_t)*core_V);
+    for (index_t u = 0; u < core_V; u++){ root[u] = u; }
+    /* an edge between core vertices originates from a core vertex */
+    for (index_t u = 0; u < core_V; u++){
+        for (index_t e = first_edge[u]; e < first_edge[u + 1]; e++){
+            index_t v = adj_vertices[e];
+            if (v >= core_V || comp_assign[u] != comp_assign[v]){ continue; }
+            index_t ru = u, rv = v;
+            while (root[ru] != ru){ ru = root[ru] = root[root[ru]]; }
+            while (root[rv] != rv){ rv = root[rv] = root[root[rv]]; }
+            if (ru < rv){ root[rv] = ru; }else{ root[ru] = rv; }
+        }
+    }
+
+    uint64_t* comp = (uint64_t*) realloc_check(nullptr,
+        sizeof(uint64_t)*core_V);
+    uint64_t first_comp = comp_num;
+    for (index_t u = 0; u < core_V; u++){
+        index_t ru = u;
+        while (root[ru] != ru){ ru = root[ru] = root[root[ru]]; }
+        /* roots are the lowest indices, thus already labeled */
+        comp[u] = ru == u ? comp_num++ : comp[ru];
+    }
+    free(root);
+
+    delete cp;
+
+    /**  total weights and weighted sums of observations  **/
+    if (comp_num > comp_cap){
+        comp_cap = grow(comp_cap, comp_num);
+        comp_weights = (real_t*) realloc_check(comp_weights,
+            sizeof(real_t)*comp_cap);
+        comp_sums = (real_t*) realloc_check(comp_sums,
+            sizeof(real_t)*D*comp_cap);
+    }
+    for (uint64_t c = first_comp; c < comp_num; c++){
+        comp_weights[c] = ZERO;
+        for (size_t d = 0; d < D; d++){ comp_sums[D*c + d] = ZERO; }
+    }
+    for (index_t u = 0; u < core_V; u++){
+        real_t w = tile.vert_weights ? tile.vert_weights[u] : ONE;
+        comp_weights[comp[u]] += w;
+        for (size_t d = 0; d < D; d++){
+            comp_sums[D*comp[u] + d] += w*tile.Y[D*u + d];
+        }
+    }
+
+    /**  edges between components; edges across a seam are recorded by the
+     **  tile whose core contains the end with lowest identifier  **/
+    for (index_t u = 0; u < V; u++){
+        for (index_t e = first_edge[u]; e < first_edge[u + 1]; e++){
+            index_t v = adj_vertices[e];
+            if (u >= core_V && v >= core_V){ continue; }
+            if (u < core_V && v < core_V && comp[u] == comp[v]){ continue; }
+
+            if (edge_num == edge_cap){
+                edge_cap = grow(edge_cap, edge_num + 1);
+                comp_edges = (Comp_edge*) realloc_check(comp_edges,
+                    sizeof(Comp_edge)*edge_cap);
+            }
+            Comp_edge& edge = comp_edges[edge_num];
+            edge.weight = tile.edge_weights ? tile.edge_weights[e] :
+                homo_edge_weight;
+
+            if (u < core_V && v < core_V){
+                edge.u = comp[u]; edge.v = comp[v]; edge.seam = false;
+                edge_num++;
+                continue;
+            }
+
+            index_t core = u < core_V ? u : v, halo = u < core_V ? v : u;
+            if (seam_num == seam_cap){
+                seam_cap = grow(seam_cap, seam_num + 1);
+                seam_vertices = (Seam_vertex*) realloc_check(seam_vertices,
+                    sizeof(Seam_vertex)*seam_cap);
+            }
+            seam_vertices[seam_num].vertex = global_index[core];
+            seam_vertices[seam_num].comp = comp[core];
+            seam_num++;
+            if (global_index[core] < global_index[halo]){
+                edge.u = comp[core]; edge.v = global_index[halo];
+                edge.seam = true;
+                edge_num++;
+            }
+        }
+    }
+
+    store_tile(t, tile, comp);
+    free(comp);
+
+    if (verbose){
+        cout << comp_num - first_comp << " component(s)." << endl;
+    }
+}
+
+TPL void CP_TILES::stitch()
+{
+    free(stitched); free(values);
+    stitched = nullptr; values = nullptr;
+    rV = 0;
+    if (!comp_num){ return; }
+
+    if (comp_num > (uint64_t) numeric_limits<comp_t>::max() ||
+        edge_num > (uint64_t) numeric_limits<index_t>::max()){
+        cerr << "Cut-pursuit d0 distance tiles: index_t and comp_t must be "
+            "able to represent the number of components over all tiles ("
+            << comp_num << ") and of edges between them." << endl;
+        exit(EXIT_FAILURE);
+    }
+
+    if (verbose){
+        cout << "Stitch " << comp_num << " component(s)... " << flush;
+    }
+
+    /**  retrieve the components of the ends of edges across seams  **/
+    sort(seam_vertices, seam_vertices + seam_num,
+        [](const Seam_vertex& a, const Seam_vertex& b)
+        { return a.vertex < b.vertex; });
+    for (uint64_t i = 0; i < edge_num; i++){
+        Comp_edge& edge = comp_edges[i];
+        if (!edge.seam){ continue; }
+        Seam_vertex* seam_vertex = lower_bound(seam_vertices,
+            seam_vertices + seam_num, edge.v,
+            [](const Seam_vertex& a, uint64_t vertex)
+            { return a.vertex < vertex; });
+        if (seam_vertex == seam_vertices + seam_num ||
+            seam_vertex->vertex != edge.v){
+            cerr << "Cut-pursuit d0 distance tiles: vertex " << edge.v <<
+                " is adjacent to another core, but not to the halo of its "
+                "own tile; the halo of each tile must contain all vertices "
+                "adjacent to its core." << endl;
+            exit(EXIT_FAILURE);
+        }
+        edge.v = seam_vertex->comp;
+    }
+    free(seam_vertices); seam_vertices = nullptr; seam_num = seam_cap = 0;
+
+    /**  sum up the weights of the edges between the same components  **/
+    for (uint64_t i = 0; i < edge_num; i++){
+        Comp_edge& edge = comp_edges[i];
+        if (edge.u > edge.v){ swap(edge.u, edge.v); }
+    }
+    sort(comp_edges, comp_edges + edge_num,
+        [](const Comp_edge& a, const Comp_edge& b)
+        { return a.u < b.u || (a.u == b.u && a.v < b.v); });
+    uint64_t rE = 0;
+    for (uint64_t i = 0; i < edge_num; i++){
+        if (rE && comp_edges[rE - 1].u == comp_edges[i].u &&
+            comp_edges[rE - 1].v == comp_edges[i].v){
+            comp_edges[rE - 1].weight += comp_edges[i].weight;
+        }else{
+            comp_edges[rE++] = comp_edges[i];
+        }
+    }
+
+    /**  graph of the components, with mean observations  **/
+    index_t* first_edge = (index_t*) realloc_check(nullptr,
+        sizeof(index_t)*(comp_num + 1));
+    index_t* adj_vertices = (index_t*) realloc_check(nullptr,
+        sizeof(index_t)*rE);
+    real_t* edge_weights = (real_t*) realloc_check(nullptr,
+        sizeof(real_t)*rE);
+    for (uint64_t c = 0; c <= comp_num; c++){ first_edge[c] = 0; }
+    for (uint64_t re = 0; re < rE; re++){
+        first_edge[comp_edges[re].u + 1]++;
+        adj_vertices[re] = comp_edges[re].v;
+        edge_weights[re] = comp_edges[re].weight;
+    }
+    for (uint64_t c = 0; c < comp_num; c++){
+        first_edge[c + 1] += first_edge[c];
+    }
+    free(comp_edges); comp_edges = nullptr; edge_num = edge_cap = 0;
+
+    for (uint64_t c = 0; c < comp_num; c++){
+        if (comp_weights[c] > ZERO){
+            for (size_t d = 0; d < D; d++){
+                comp_sums[D*c + d] /= comp_weights[c];
+            }
+        }
+    }
+
+    /**  merge step only, starting from the components of the tiles  **/
+    Cp_d0_dist<real_t, index_t, comp_t>* cp =
+        new Cp_d0_dist<real_t, index_t, comp_t>(comp_num, rE, first_edge,
+            adj_vertices, comp_sums, D);
+    cp->set_loss(loss, nullptr, comp_weights, coor_weights);
+    cp->set_edge_weights(edge_weights);
+    comp_t* comp_assign = (comp_t*) realloc_check(nullptr,
+        sizeof(comp_t)*comp_num);
+    for (uint64_t c = 0; c < comp_num; c++){ comp_assign[c] = c; }
+    cp->set_components(comp_num, comp_assign); // free()'d by cp
+    cp->set_cp_param(ZERO, 0, 0);
+    cp->cut_pursuit();
+
+    rV = cp->get_components(&comp_assign);
+    stitched = (uint64_t*) realloc_check(nullptr, sizeof(uint64_t)*comp_num);
+    for (uint64_t c = 0; c < comp_num; c++){ stitched[c] = comp_assign[c]; }
+    real_t* rX = cp->get_reduced_values();
+    values = (real_t*) realloc_check(nullptr, sizeof(real_t)*D*rV);
+    for (size_t i = 0; i < D*rV; i++){ values[i] = rX[i]; }
+
+    delete cp;
+    free(first_edge); free(adj_vertices); free(edge_weights);
+    free(comp_weights); free(comp_sums);
+    comp_weights = comp_sums = nullptr; comp_cap = 0;
+
+    if (verbose){ cout << rV << " component(s)." << endl; }
+}
+
+TPL uint64_t CP_TILES::get_components(uint64_t** stitched, real_t** values)
+{
+    if (stitched){ *stitched = this->stitched; }
+    if (values){ *values = this->values; }
+    return comp_num;
+}
+
+/**  instantiate for compilation  **/
+template class Cp_d0_dist_tiles<float, uint32_t, uint16_t>;
+template class Cp_d0_dist_tiles<double, uint32_t, uint16_t>;
+template class Cp_d0_dist_tiles<float, uint32_t, uint32_t>;
+template class Cp_d0_dist_tiles<double, uint32_t, uint32_t>;
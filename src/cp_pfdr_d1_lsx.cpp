@@ -6,13 +6,19 @@
 #include "../include/omp_num_threads.hpp"
 #include "../include/matrix_tools.hpp"
 #include "../include/pfdr_d1_lsx.hpp"
+#include "../include/pd_d1_lsx.hpp"
+#include "../include/proj_simplex.hpp"
 
 #define ZERO ((real_t) 0.0)
 #define ONE ((real_t) 1.0)
 #define HALF ((real_t) 0.5)
 #define INF_REAL (std::numeric_limits<real_t>::infinity())
-#define EDGE_WEIGHTS_(e) (edge_weights ? edge_weights[(e)] : homo_edge_weight)
+/* certificates flag saturation only when tight enough, see certify() */
+#define TIGHT_GAP_FACTOR ((real_t) 10.0)
+#define EDGE_WEIGHTS_(e) (edge_weights ? edge_weights[(e)] : \
+    quantized_edge_weights ? quantized_edge_weights[(e)] : homo_edge_weight)
 #define LOSS_WEIGHTS_(v) (loss_weights ? loss_weights[(v)] : ONE)
+#define Y_(vd) (Y ? Y[(vd)] : quantized_Y[(vd)])
 #define COOR_WEIGHTS_(d) (coor_weights ? coor_weights[(d)] : ONE)
 
 #define TPL template <typename real_t, typename index_t, typename comp_t>
@@ -21,7 +27,7 @@
 using namespace std;
 
 TPL CP_D1_LSX::Cp_d1_lsx(index_t V, index_t E, const index_t* first_edge,
-    const index_t* adj_vertices, size_t D, const real_t* Y) :
+    Adj_vertices<index_t> adj_vertices, size_t D, const real_t* Y) :
     Cp_d1<real_t, index_t, comp_t>(V, E, first_edge, adj_vertices, D, D11),
     Y(Y)
 {
@@ -36,6 +42,7 @@ TPL CP_D1_LSX::Cp_d1_lsx(index_t V, index_t E, const index_t* first_edge,
 
     pfdr_rho = 1.0; pfdr_cond_min = 1e-2; pfdr_dif_rcd = 0.0;
     pfdr_dif_tol = 1e-3*dif_tol; pfdr_it = pfdr_it_max = 1e4;
+    pfdr_mixed = false; pfdr_refine_it_max = 100;
 
     /* with a separable loss, components are only coupled by total variation
      * and it makes sense to consider nonevolving components as saturated */
@@ -51,10 +58,16 @@ TPL void CP_D1_LSX::set_loss(real_t loss, const real_t* Y,
         exit(EXIT_FAILURE);
     }
     this->loss = loss;
-    if (Y){ this->Y = Y; }
+    if (Y){ this->Y = Y; quantized_Y = Quantized_array<real_t>(); }
     this->loss_weights = loss_weights; 
 }
 
+TPL void CP_D1_LSX::set_quantized_observations(Quantized_array<real_t> Y)
+{
+    this->Y = nullptr;
+    quantized_Y = Y;
+}
+
 TPL void CP_D1_LSX::set_pfdr_param(real_t rho, real_t cond_min, real_t dif_rcd,
     int it_max, real_t dif_tol)
 {
@@ -65,8 +78,16 @@ TPL void CP_D1_LSX::set_pfdr_param(real_t rho, real_t cond_min, real_t dif_rcd,
     this->pfdr_dif_tol = dif_tol;
 }
 
+TPL void CP_D1_LSX::set_pfdr_mixed_precision(bool mixed, int refine_it_max)
+{
+    this->pfdr_mixed = mixed;
+    this->pfdr_refine_it_max = refine_it_max;
+}
+
 TPL void CP_D1_LSX::solve_reduced_problem()
 {
+    schedule_reduced(pfdr_dif_tol, pfdr_it_max);
+
     if (rV == 1){ /**  single connected component  **/
 
         #pragma omp parallel for schedule(static) NUM_THREADS(D*V, D)
@@ -74,7 +95,7 @@ TPL void CP_D1_LSX::solve_reduced_problem()
             rX[d] = ZERO;
             size_t vd = d;
             for (index_t v = 0; v < V; v++){
-                rX[d] += LOSS_WEIGHTS_(v)*Y[vd];
+                rX[d] += LOSS_WEIGHTS_(v)*Y_(vd);
                 vd += D;
             }
         }
@@ -102,85 +123,310 @@ TPL void CP_D1_LSX::solve_reduced_problem()
         real_t* rY = (real_t*) malloc_check(sizeof(real_t)*D*rV);
         real_t* reduced_loss_weights =
             (real_t*) malloc_check(sizeof(real_t)*rV);
-        #pragma omp parallel for schedule(dynamic) NUM_THREADS(V, rV)
+        /* if there are less components than threads, the remaining threads
+         * help within large components, see Cp::get_task_num() */
+        #pragma omp parallel for schedule(dynamic) NUM_THREADS(D*V)
         for (comp_t rv = 0; rv < rV; rv++){
+            const index_t comp_size = first_vertex[rv + 1] - first_vertex[rv];
+            const index_t* comp_vertices = comp_list + first_vertex[rv];
             real_t *rYv = rY + rv*D;
             for (size_t d = 0; d < D; d++){ rYv[d] = ZERO; }
             reduced_loss_weights[rv] = ZERO;
-            for (index_t i = first_vertex[rv]; i < first_vertex[rv + 1]; i++){
-                index_t v = comp_list[i];
-                const real_t *Yv = Y + v*D;
+            index_t task_num = get_task_num(comp_size, D);
+            component_tasks(task_num, comp_size,
+                [&](index_t first, index_t last)
+            {
+            /* sum directly if there is only one task */
+            real_t* sum = task_num > 1 ?
+                (real_t*) malloc_check(sizeof(real_t)*(D + 1)) : nullptr;
+            real_t* sum_Y = sum ? sum : rYv;
+            real_t& sum_w = sum ? sum[D] : reduced_loss_weights[rv];
+            if (sum){ for (size_t d = 0; d <= D; d++){ sum[d] = ZERO; } }
+            for (index_t i = first; i < last; i++){
+                index_t v = comp_vertices[i];
+                size_t vd = v*D;
+                for (size_t d = 0; d < D; d++, vd++){
+                    sum_Y[d] += LOSS_WEIGHTS_(v)*Y_(vd);
+                }
+                sum_w += LOSS_WEIGHTS_(v);
+            }
+            if (sum){
                 for (size_t d = 0; d < D; d++){
-                    rYv[d] += LOSS_WEIGHTS_(v)*Yv[d];
+                    #pragma omp atomic
+                    rYv[d] += sum[d];
                 }
-                reduced_loss_weights[rv] += LOSS_WEIGHTS_(v);
+                #pragma omp atomic
+                reduced_loss_weights[rv] += sum[D];
+                free(sum);
             }
+            });
             for (size_t d = 0; d < D; d++){
                 rYv[d] /= reduced_loss_weights[rv];
             }
         }
 
-        Pfdr_d1_lsx<real_t, comp_t> *pfdr = new Pfdr_d1_lsx<real_t, comp_t>(
-                rV, rE, reduced_edges, loss, D, rY, coor_weights);
+        pfdr_it = 0;
+        comp_t *rcomp_list, *first_rcomp_vertex, *rcomp_edges;
+        real_t *rcomp_edge_weights;
+        size_t *first_rcomp_edge;
+        comp_t rcomp_num = independent_reduced_solves ?
+            compute_reduced_components(rcomp_list, first_rcomp_vertex,
+                rcomp_edges, rcomp_edge_weights, first_rcomp_edge) : 1;
+
+        if (rcomp_num > 1){ /**  independent subproblems  **/
+            if (verbose){
+                cout << "\t" << rcomp_num << " independent reduced problems"
+                    << endl;
+            }
+            comp_t large_size = large_reduced_component_size(rcomp_num);
+            /* large components one after the other, each in parallel */
+            for (comp_t rc = 0; rc < rcomp_num; rc++){
+                comp_t rcomp_size = first_rcomp_vertex[rc + 1] -
+                    first_rcomp_vertex[rc];
+                if (rcomp_size <= large_size){ continue; }
+                int it = solve_reduced_component(rcomp_size,
+                    rcomp_list + first_rcomp_vertex[rc],
+                    first_rcomp_edge[rc + 1] - first_rcomp_edge[rc],
+                    rcomp_edges + 2*first_rcomp_edge[rc],
+                    rcomp_edge_weights + first_rcomp_edge[rc],
+                    rY, reduced_loss_weights);
+                if (it > pfdr_it){ pfdr_it = it; }
+            }
+            /* the other ones in parallel */
+            int par_it = 0;
+            #pragma omp parallel for schedule(dynamic) \
+                NUM_THREADS(D*rV*pfdr_it_max, rcomp_num) reduction(max:par_it)
+            for (comp_t rc = 0; rc < rcomp_num; rc++){
+                comp_t rcomp_size = first_rcomp_vertex[rc + 1] -
+                    first_rcomp_vertex[rc];
+                if (rcomp_size > large_size){ continue; }
+                int it = solve_reduced_component(rcomp_size,
+                    rcomp_list + first_rcomp_vertex[rc],
+                    first_rcomp_edge[rc + 1] - first_rcomp_edge[rc],
+                    rcomp_edges + 2*first_rcomp_edge[rc],
+                    rcomp_edge_weights + first_rcomp_edge[rc],
+                    rY, reduced_loss_weights);
+                if (it > par_it){ par_it = it; }
+            }
+            if (par_it > pfdr_it){ pfdr_it = par_it; }
+
+            free(rcomp_list); free(first_rcomp_vertex); free(rcomp_edges);
+            free(rcomp_edge_weights); free(first_rcomp_edge);
+        }else{
+            if (independent_reduced_solves){
+                free(rcomp_list); free(first_rcomp_vertex); free(rcomp_edges);
+                free(rcomp_edge_weights); free(first_rcomp_edge);
+            }
+            pfdr_it = solve_reduced_iterative(rV, rE, reduced_edges,
+                reduced_edge_weights, rY, reduced_loss_weights, rX, verbose);
+        }
+
+        free(rY); free(reduced_loss_weights);
+    }
 
-        pfdr->set_edge_weights(reduced_edge_weights);
-        pfdr->set_loss(reduced_loss_weights);
-        pfdr->set_conditioning_param(pfdr_cond_min, pfdr_dif_rcd);
-        pfdr->set_relaxation(pfdr_rho);
-        pfdr->set_algo_param(pfdr_dif_tol, pfdr_it_max, verbose);
-        pfdr->set_iterate(rX);
-        pfdr->initialize_iterate();
+    if (!reduced_decrease()){ solve_reduced_problem(); }
+}
 
-        pfdr_it = pfdr->precond_proximal_splitting();
+TPL int CP_D1_LSX::solve_reduced_pfdr(comp_t rV, size_t rE,
+    const comp_t* reduced_edges, const real_t* reduced_edge_weights,
+    const real_t* rY, const real_t* reduced_loss_weights, real_t* rX,
+    int verbose)
+{
+    real_t* Z = nullptr; // auxiliary variables for warm restart
+    int it = 0;
+
+    if (pfdr_mixed && sizeof(real_t) > sizeof(float)){
+    /**  iterate in single precision, refine in double precision  **/
+        float *rY_f = nullptr, *reduced_loss_weights_f = nullptr,
+            *coor_weights_f = nullptr, *edge_weights_f = nullptr;
+        convert_array(rY_f, rY, D*rV);
+        convert_array(reduced_loss_weights_f, reduced_loss_weights, rV);
+        convert_array(coor_weights_f, coor_weights, D);
+        convert_array(edge_weights_f, reduced_edge_weights, rE);
+
+        Pfdr_d1_lsx<float, comp_t> *pfdr_f =
+            new Pfdr_d1_lsx<float, comp_t>(rV, rE, reduced_edges, loss, D,
+                rY_f, coor_weights_f);
+
+        pfdr_f->set_edge_weights(edge_weights_f);
+        pfdr_f->set_loss(reduced_loss_weights_f);
+        pfdr_f->set_conditioning_param(pfdr_cond_min, pfdr_dif_rcd);
+        pfdr_f->set_relaxation(pfdr_rho);
+        pfdr_f->set_cancel_flag(get_cancel_flag());
+        /* single precision cannot resolve much smaller evolutions */
+        pfdr_f->set_algo_param(max(reduced_dif_tol(pfdr_dif_tol),
+            (real_t) (1e2*numeric_limits<float>::epsilon())),
+            reduced_it_max(pfdr_it_max), verbose);
+        pfdr_f->initialize_iterate();
+
+        it = pfdr_f->precond_proximal_splitting();
+
+        convert_array(rX, pfdr_f->get_iterate(), D*rV);
+        convert_array(Z, pfdr_f->get_auxiliary(), 2*rE*D);
+        delete pfdr_f;
+
+        free(rY_f); free(reduced_loss_weights_f); free(coor_weights_f);
+        free(edge_weights_f);
+    }
 
-        pfdr->set_iterate(nullptr); // prevent rX to be free()'d at deletion
-        delete pfdr;
+    Pfdr_d1_lsx<real_t, comp_t> *pfdr = new Pfdr_d1_lsx<real_t, comp_t>(
+            rV, rE, reduced_edges, loss, D, rY, coor_weights);
 
-        free(rY); free(reduced_loss_weights);
+    pfdr->set_edge_weights(reduced_edge_weights);
+    pfdr->set_loss(reduced_loss_weights);
+    pfdr->set_conditioning_param(pfdr_cond_min, pfdr_dif_rcd);
+    pfdr->set_relaxation(pfdr_rho);
+    pfdr->set_cancel_flag(get_cancel_flag());
+    pfdr->set_algo_param(reduced_dif_tol(pfdr_dif_tol),
+        reduced_it_max(Z ? pfdr_refine_it_max : pfdr_it_max), verbose);
+    pfdr->set_iterate(rX);
+    if (Z){ pfdr->set_auxiliary(Z); } // warm restart, Z free()'d by pfdr
+    else{ pfdr->initialize_iterate(); }
+
+    it += pfdr->precond_proximal_splitting();
+
+    pfdr->set_iterate(nullptr); // prevent rX to be free()'d at deletion
+    delete pfdr;
+
+    return it;
+}
+
+TPL int CP_D1_LSX::solve_reduced_pd(comp_t rV, size_t rE,
+    const comp_t* reduced_edges, const real_t* reduced_edge_weights,
+    const real_t* rY, const real_t* reduced_loss_weights, real_t* rX,
+    int verbose)
+{
+    Pd_d1_lsx<real_t, comp_t> *pd = new Pd_d1_lsx<real_t, comp_t>(rV, rE,
+        reduced_edges, loss, D, rY, coor_weights);
+
+    pd->set_edge_weights(reduced_edge_weights);
+    pd->set_loss(reduced_loss_weights);
+    pd->set_dual_scale(pd_dual_scale);
+    pd->set_cancel_flag(get_cancel_flag());
+    pd->set_algo_param(reduced_dif_tol(pfdr_dif_tol),
+        reduced_it_max(pfdr_it_max), verbose);
+    pd->set_iterate(rX);
+    pd->initialize_iterate();
+
+    int it = pd->precond_proximal_splitting();
+
+    pd->set_iterate(nullptr); // prevent rX to be free()'d at deletion
+    delete pd;
+
+    return it;
+}
+
+TPL int CP_D1_LSX::solve_reduced_iterative(comp_t rV, size_t rE,
+    const comp_t* reduced_edges, const real_t* reduced_edge_weights,
+    const real_t* rY, const real_t* reduced_loss_weights, real_t* rX,
+    int verbose)
+{
+    /* the curvature is uniform only for the quadratic loss; the linear loss
+     * has none, and the smoothed Kullback-Leibler one is only bounded */
+    if (use_primal_dual(rV, rE, reduced_edges, reduced_edge_weights,
+            loss == QUADRATIC ? reduced_loss_weights : nullptr)){
+        return solve_reduced_pd(rV, rE, reduced_edges, reduced_edge_weights,
+            rY, reduced_loss_weights, rX, verbose);
+    }else{
+        return solve_reduced_pfdr(rV, rE, reduced_edges,
+            reduced_edge_weights, rY, reduced_loss_weights, rX, verbose);
     }
 }
 
-TPL index_t CP_D1_LSX::split()
+TPL int CP_D1_LSX::solve_reduced_component(comp_t rcomp_size,
+    const comp_t* rcomp_vertices, size_t rcomp_E, const comp_t* rcomp_edges,
+    const real_t* rcomp_edge_weights, const real_t* rY,
+    const real_t* reduced_loss_weights)
 {
-    index_t activation = 0;
-    real_t* grad = (real_t*) malloc_check(sizeof(real_t)*D*V);
+    if (rcomp_size == 1){ /**  closed form, as for a single component  **/
+        const real_t* rYv = rY + D*rcomp_vertices[0];
+        real_t* rXv = rX + D*rcomp_vertices[0];
+        if (loss == LINEAR){ /* optimum at simplex corner */
+            size_t idx = 0;
+            for (size_t d = 1; d < D; d++){
+                if (rYv[d] > rYv[idx]){ idx = d; }
+            }
+            for (size_t d = 0; d < D; d++){ rXv[d] = d == idx ? ONE : ZERO; }
+        }else{ /* optimum at barycenter */
+            for (size_t d = 0; d < D; d++){ rXv[d] = rYv[d]; }
+        }
+        return 0;
+    }
+
+    real_t *rcomp_Y = nullptr, *rcomp_loss_weights = nullptr;
+    gather_array(rcomp_Y, rY, rcomp_vertices, rcomp_size, D);
+    gather_array(rcomp_loss_weights, reduced_loss_weights, rcomp_vertices,
+        rcomp_size);
+    real_t* rcomp_X = (real_t*) malloc_check(sizeof(real_t)*D*rcomp_size);
+
+    int it = solve_reduced_iterative(rcomp_size, rcomp_E, rcomp_edges,
+        rcomp_edge_weights, rcomp_Y, rcomp_loss_weights, rcomp_X, 0);
+
+    for (comp_t i = 0; i < rcomp_size; i++){
+        real_t* rXv = rX + D*rcomp_vertices[i];
+        for (size_t d = 0; d < D; d++){ rXv[d] = rcomp_X[D*i + d]; }
+    }
+
+    free(rcomp_Y); free(rcomp_loss_weights); free(rcomp_X);
+    return it;
+}
+
+TPL void CP_D1_LSX::compute_gradient(real_t* grad, bool skip_saturated)
+{
+    /* vertices where the gradient is computed, all of them if not listed in
+     * the temporary components list */
+    const bool listed = skip_saturated && saturation_count;
+    const index_t num = listed ? list_unsaturated_vertices() : V;
 
-    /**  gradient of differentiable part  **/ 
     const real_t c = (ONE - loss), q = loss/D, r = q/c; // useful for KLs
-    #pragma omp parallel for schedule(static) NUM_THREADS(V*D + 2*E*D, V)
-    for (index_t v = 0; v < V; v++){
-        /* loss term */
+    #pragma omp parallel for schedule(static) \
+        NUM_THREADS(((uintmax_t) 2*E*num/V + num)*D, num)
+    for (index_t i = 0; i < num; i++){
+        index_t v = listed ? get_tmp_comp_list(i) : i;
+        real_t *gradv = grad + v*D;
+        const real_t *rXv = rX + comp_assign[v]*D;
+
+        /**  gradient of differentiable part, loss term  **/ 
         size_t vd = v*D;
-        size_t rvd = comp_assign[v]*D;
         for (size_t d = 0; d < D; d++){
             if (loss == LINEAR){ /* linear loss, grad = - w Y */
-                grad[vd] = -LOSS_WEIGHTS_(v)*Y[vd];
+                gradv[d] = -LOSS_WEIGHTS_(v)*Y_(vd);
             }else if (loss == QUADRATIC){ /* quadratic loss, grad = w(X - Y) */
-                grad[vd] = LOSS_WEIGHTS_(v)*(rX[rvd] - Y[vd]);
+                gradv[d] = LOSS_WEIGHTS_(v)*(rXv[d] - Y_(vd));
             }else{ /* dKLs/dx_k = -(1-s)(s/D + (1-s)y_k)/(s/D + (1-s)x_k) */
-                grad[vd] = -LOSS_WEIGHTS_(v)*(q + c*Y[vd])/(r + rX[rvd]);
+                gradv[d] = -LOSS_WEIGHTS_(v)*(q + c*Y_(vd))/(r + rXv[d]);
             }
-            vd++; rvd++;
+            vd++;
         }
-        /* differentiable d1 contribution */ 
-        real_t *gradv = grad + v*D;
-        real_t *rXv = rX + comp_assign[v]*D;
-        for (index_t e = first_edge[v]; e < first_edge[v + 1]; e++){
-            if (is_active(e)){
-                index_t u = adj_vertices[e];
-                real_t *rXu = rX + comp_assign[u]*D;
-                real_t *gradu = grad + u*D;
-                for (size_t d = 0; d < D; d++){
-                    real_t grad_d1 = (rXv[d] - rXu[d] > eps ?
-                        EDGE_WEIGHTS_(e) : -EDGE_WEIGHTS_(e))*COOR_WEIGHTS_(d);
-                    gradv[d] += grad_d1;
-                    gradu[d] -= grad_d1;
-                    /* equality of _some_ coordinates constitutes a source of
-                     * nondifferentiability; this is actually not taken into
-                     * account, see below */
-                }
+
+        /**  differentiable d1 contribution, along the active edges involving
+         **  v in either direction, so that no concurrent update occurs  **/ 
+        incident_edges(v, [&](index_t e, index_t u, bool forward){
+            if (!is_active(e)){ return; }
+            const real_t *rXu = rX + comp_assign[u]*D;
+            for (size_t d = 0; d < D; d++){
+                /* sign given along the edge direction, as it matters within
+                 * eps */
+                real_t grad_d1 = ((forward ? rXv[d] - rXu[d] :
+                    rXu[d] - rXv[d]) > eps ? EDGE_WEIGHTS_(e) :
+                    -EDGE_WEIGHTS_(e))*COOR_WEIGHTS_(d);
+                gradv[d] += forward ? grad_d1 : -grad_d1;
+                /* equality of _some_ coordinates constitutes a source of
+                 * nondifferentiability; this is actually not taken into
+                 * account, see below */
             }
-        }
+        });
+    }
+}
+
+TPL index_t CP_D1_LSX::split()
+{
+    index_t activation = 0;
+    real_t* grad = certified_grad; // see Cp_d1::certified_grad
+    certified_grad = nullptr;
+    if (!grad){
+        grad = (real_t*) malloc_check(sizeof(real_t)*D*V);
+        compute_gradient(grad, true);
     }
 
     /**  directions are searched in the set \prod_v Dv, where for each vertex,
@@ -192,16 +438,22 @@ TPL index_t CP_D1_LSX::split()
     /* best ascent coordinates stored temporarily in array 'comp_assign' */
     comp_t* best_d = comp_assign;
 
-    /**  set capacities and compute min cuts in parallel along components  **/
-    #pragma omp parallel NUM_THREADS((D - 1)*(2*V + 5*E), rV)
+    /**  set capacities and compute min cuts in parallel along components;
+     **  if there are less components than threads, the remaining threads
+     **  help within large components, see Cp::get_task_num()  **/
+    #pragma omp parallel NUM_THREADS((D - 1)*(2*V + 5*E), V, OMP_GRAPH)
     {
 
-    Cp_graph<real_t, index_t, comp_t>* Gpar = get_parallel_flow_graph();
+    Flow_graph* Gpar = get_parallel_flow_graph();
 
     #pragma omp for schedule(dynamic) reduction(+:activation)
     for (comp_t rv = 0; rv < rV; rv++){
-        if (is_saturated(rv)){ continue; }
+        if (is_saturated(rv) || is_cancelled()){ continue; }
         index_t rv_activation = 0;
+        const index_t comp_size = first_vertex[rv + 1] - first_vertex[rv];
+        const index_t* comp_vertices = comp_list + first_vertex[rv];
+        const index_t task_num = get_task_num(comp_size, 2*D);
+        Maxflow_engine engine = get_maxflow_engine(rv);
 
         /* find coordinate with maximum value */
         comp_t dmv = 0;
@@ -213,9 +465,12 @@ TPL index_t CP_D1_LSX::split()
 
         /* initialize best ascent coordinate at the coordinate with maximum
          * value, corresponding to a null descent direction (1dmv - 1dmv) */
-        for (index_t i = first_vertex[rv]; i < first_vertex[rv + 1]; i++){
-            best_d[comp_list[i]] = dmv;
+        component_tasks(task_num, comp_size, [&](index_t first, index_t last)
+        {
+        for (index_t i = first; i < last; i++){
+            best_d[comp_vertices[i]] = dmv;
         }
+        });
 
         /* iterate over all D - 1 alternative ascent coordinates */
         for (comp_t d_alt = 1; d_alt < D; d_alt++){
@@ -224,12 +479,16 @@ TPL index_t CP_D1_LSX::split()
             comp_t d = d_alt == dmv ? 0 : d_alt;
 
             /* set the source/sink capacities */
-            for (index_t i = first_vertex[rv]; i < first_vertex[rv + 1]; i++){
-                index_t v = comp_list[i];
+            component_tasks(task_num, comp_size,
+                [&](index_t first, index_t last)
+            {
+            for (index_t i = first; i < last; i++){
+                index_t v = comp_vertices[i];
                 real_t* gradv = grad + v*D;
                 /* unary cost for changing current dir_v to 1d - 1dmv */
                 set_term_capacities(v, gradv[d] - gradv[best_d[v]]);
             }
+            });
 
             /* set d1 edge capacities within each component;
              * strictly speaking, active edges should not be directly ignored,
@@ -239,12 +498,14 @@ TPL index_t CP_D1_LSX::split()
              * are somewhat cumbersome to compute, and more importantly max
              * flows cannot be easily computed in parallel, since the
              * components would not be independent anymore;
-             * we thus stick with the current heuristic for now */
+             * we thus stick with the current heuristic for now;
+             * capacities of both ends of each edge are modified, so this is
+             * not split into concurrent tasks */
             for (index_t i = first_vertex[rv]; i < first_vertex[rv + 1]; i++){
                 index_t u = comp_list[i];
                 for (index_t e = first_edge[u]; e < first_edge[u + 1]; e++){
                     if (is_active(e)){ continue; }
-                    index_t v = adj_vertices[e];
+                    index_t v = adj_vertex(e);
                     /* horizontal and source/sink capacities are modified 
                      * according to Kolmogorov & Zabih (2004); in their
                      * notations, functional E(u,v) is decomposed as
@@ -279,34 +540,46 @@ TPL index_t CP_D1_LSX::split()
             }
 
             /* find min cut and update best ascent coordinates accordingly */
-            Gpar->maxflow(first_vertex[rv + 1] - first_vertex[rv],
-                comp_list + first_vertex[rv]);
+            compute_maxflow(Gpar, comp_size, comp_vertices, engine);
             
-            for (index_t i = first_vertex[rv]; i < first_vertex[rv + 1]; i++){
-                index_t v = comp_list[i];
+            component_tasks(task_num, comp_size,
+                [&](index_t first, index_t last)
+            {
+            for (index_t i = first; i < last; i++){
+                index_t v = comp_vertices[i];
                 if (is_sink(v)){ best_d[v] = d; }
             }
+            });
 
         } // end for d_alt
 
         /* activate edges correspondingly */
-        for (index_t i = first_vertex[rv]; i < first_vertex[rv + 1]; i++){
-            index_t v = comp_list[i];
+        component_tasks(task_num, comp_size, [&](index_t first, index_t last)
+        {
+        index_t task_activation = 0;
+        for (index_t i = first; i < last; i++){
+            index_t v = comp_vertices[i];
             for (index_t e = first_edge[v]; e < first_edge[v + 1]; e++){
-                if (!is_active(e) && best_d[v] != best_d[adj_vertices[e]]){
+                if (!is_active(e) && best_d[v] != best_d[adj_vertex(e)]){
                     set_active(e);
-                    rv_activation++;
+                    task_activation++;
                 }
             }
         }
+        #pragma omp atomic
+        rv_activation += task_activation;
+        });
 
         set_saturation(rv, rv_activation == 0);
         activation += rv_activation;
 
         /* reconstruct comp_assign */
-        for (index_t i = first_vertex[rv]; i < first_vertex[rv + 1]; i++){
-            comp_assign[comp_list[i]] = rv;
+        component_tasks(task_num, comp_size, [&](index_t first, index_t last)
+        {
+        for (index_t i = first; i < last; i++){
+            comp_assign[comp_vertices[i]] = rv;
         }
+        });
 
     } // end for rv
 
@@ -348,6 +621,109 @@ TPL real_t CP_D1_LSX::compute_evolution(bool compute_dif)
     return compute_dif ? dif/V : INF_REAL;
 }
 
+TPL real_t CP_D1_LSX::certify()
+{
+    real_t* grad = (real_t*) malloc_check(sizeof(real_t)*D*V);
+    compute_gradient(grad);
+
+    /**  the gradient is routed across the components, up to the normal
+     **  cone of the simplex, that is to say up to a uniform shift, taken as
+     **  the mean over positive coordinates, and up to nonnegative values over
+     **  zero coordinates  **/
+    real_t* out_min = (real_t*) malloc_check(sizeof(real_t)*D*V);
+    real_t* out_max = (real_t*) malloc_check(sizeof(real_t)*D*V);
+    #pragma omp parallel for schedule(static) NUM_THREADS(V*D, V)
+    for (index_t v = 0; v < V; v++){
+        const real_t* rXv = rX + comp_assign[v]*D;
+        const real_t* gradv = grad + v*D;
+        real_t mean = ZERO;
+        size_t pos = 0;
+        for (size_t d = 0; d < D; d++){
+            if (rXv[d] > ZERO){ mean += gradv[d]; pos++; }
+        }
+        if (pos){ mean /= pos; }
+        for (size_t d = 0; d < D; d++){
+            out_max[v*D + d] = gradv[d] - mean;
+            out_min[v*D + d] = rXv[d] > ZERO ? gradv[d] - mean : -INF_REAL;
+        }
+    }
+
+    compute_dual_flows(out_min, out_max);
+
+    /**  contribution of each vertex; the dual variable is the opposite of
+     **  the divergence of the flows, to which the gradient of the loss is
+     **  removed  **/
+    real_t* vert_gap = out_min; // reuse storage
+    real_t total_gap = ZERO;
+    #pragma omp parallel NUM_THREADS(V*D + 2*E*D, V)
+    {
+    real_t* z = loss == QUADRATIC ?
+        (real_t*) malloc_check(sizeof(real_t)*2*D) : nullptr;
+
+    #pragma omp for schedule(static) reduction(+:total_gap)
+    for (index_t v = 0; v < V; v++){
+        const real_t* rXv = rX + comp_assign[v]*D;
+        const real_t* gradv = grad + v*D;
+        real_t* tv = out_max + v*D; // reuse storage
+        for (size_t d = 0; d < D; d++){
+            tv[d] = dual_flows[v*D + d] - gradv[d];
+        }
+        real_t gap;
+        const real_t w = LOSS_WEIGHTS_(v);
+        if (loss == QUADRATIC && w > ZERO){
+            /* exact conjugate, gap is w/2(||x - z||^2 - ||P(z) - z||^2),
+             * with z = x + tv/w and P the projection on the simplex */
+            real_t* pz = z + D;
+            real_t t2 = ZERO, p2 = ZERO;
+            for (size_t d = 0; d < D; d++){
+                z[d] = pz[d] = rXv[d] + tv[d]/w;
+                t2 += tv[d]*tv[d];
+            }
+            proj_simplex<real_t>(pz, D);
+            for (size_t d = 0; d < D; d++){
+                p2 += (pz[d] - z[d])*(pz[d] - z[d]);
+            }
+            gap = HALF*(t2/w - w*p2);
+        }else{
+            /* linear functional over the simplex, the support function of
+             * which is the maximum coordinate */
+            real_t max = -INF_REAL, prod = ZERO;
+            for (size_t d = 0; d < D; d++){
+                if (tv[d] > max){ max = tv[d]; }
+                prod += rXv[d]*tv[d];
+            }
+            gap = max - prod;
+        }
+        /* along active edges, almost equal coordinates have a subgradient
+         * which might not match their differences */
+        for (index_t e = first_edge[v]; e < first_edge[v + 1]; e++){
+            if (!is_active(e)){ continue; }
+            const real_t* rXu = rX + comp_assign[adj_vertex(e)]*D;
+            for (size_t d = 0; d < D; d++){
+                real_t dif = abs(rXv[d] - rXu[d]);
+                if (dif <= eps || is_tied(v, e, d)){
+                    gap += 2.0*EDGE_WEIGHTS_(e)*COOR_WEIGHTS_(d)*dif;
+                }
+            }
+        }
+        vert_gap[v] = gap > ZERO ? gap : ZERO;
+        total_gap += vert_gap[v];
+    }
+
+    free(z);
+
+    } // end parallel region
+    free(out_max);
+    free(certified_grad);
+    certified_grad = grad;
+
+    /* see the declaration of certify() */
+    real_t gap = certify_components(vert_gap,
+        total_gap <= TIGHT_GAP_FACTOR*gap_tol);
+    free(vert_gap);
+    return gap;
+}
+
 TPL real_t CP_D1_LSX::compute_objective()
 /* unfortunately, at this point one does not have access to the reduced objects
  * computed in the routine solve_reduced_problem() */
@@ -359,9 +735,9 @@ TPL real_t CP_D1_LSX::compute_objective()
             reduction(+:obj)
         for (index_t v = 0; v < V; v++){
             real_t* rXv = rX + comp_assign[v]*D;
-            const real_t* Yv = Y + v*D;
+            const size_t vD = v*D;
             real_t prod = ZERO;
-            for (size_t d = 0; d < D; d++){ prod += rXv[d]*Yv[d]; }
+            for (size_t d = 0; d < D; d++){ prod += rXv[d]*Y_(vD + d); }
             obj -= LOSS_WEIGHTS_(v)*prod;
         }
     }else if (loss == QUADRATIC){
@@ -369,10 +745,10 @@ TPL real_t CP_D1_LSX::compute_objective()
             reduction(+:obj)
         for (index_t v = 0; v < V; v++){
             real_t* rXv = rX + comp_assign[v]*D;
-            const real_t* Yv = Y + v*D;
+            const size_t vD = v*D;
             real_t dif2 = ZERO;
             for (size_t d = 0; d < D; d++){
-                dif2 += (rXv[d] - Yv[d])*(rXv[d] - Yv[d]);
+                dif2 += (rXv[d] - Y_(vD + d))*(rXv[d] - Y_(vD + d));
             }
             obj += LOSS_WEIGHTS_(v)*dif2;
         }
@@ -384,10 +760,10 @@ TPL real_t CP_D1_LSX::compute_objective()
             reduction(+:obj) 
         for (index_t v = 0; v < V; v++){
             real_t* rXv = rX + comp_assign[v]*D;
-            const real_t* Yv = Y + v*D;
+            const size_t vD = v*D;
             real_t KLs = ZERO;
             for (size_t d = 0; d < D; d++){
-                real_t ys = q + c*Yv[d];
+                real_t ys = q + c*Y_(vD + d);
                 KLs += ys*log(ys/(q + c*rXv[d]));
             }
             obj += LOSS_WEIGHTS_(v)*KLs;
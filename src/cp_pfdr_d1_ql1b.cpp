@@ -2,16 +2,20 @@
  * Hugo Raguet 2018
  *===========================================================================*/
 #include <cmath>
+#include <random>
 #include "../include/cp_pfdr_d1_ql1b.hpp"
 #include "../include/omp_num_threads.hpp"
 #include "../include/matrix_tools.hpp"
 #include "../include/pfdr_d1_ql1b.hpp"
+#include "../include/pd_d1_ql1b.hpp"
+#include "../include/ssnal_d1_ql1b.hpp"
 #include "../include/wth_element.hpp"
 
 #define ZERO ((real_t) 0.0)
 #define ONE ((real_t) 1.0)
 #define HALF ((real_t) 0.5)
-#define EDGE_WEIGHTS_(e) (edge_weights ? edge_weights[(e)] : homo_edge_weight)
+#define EDGE_WEIGHTS_(e) (edge_weights ? edge_weights[(e)] : \
+    quantized_edge_weights ? quantized_edge_weights[(e)] : homo_edge_weight)
 #define L1_WEIGHTS_(v) (l1_weights ? l1_weights[(v)] : homo_l1_weight)
 #define Y_(n) (Y ? Y[(n)] : (real_t) 0.0)
 #define Yl1_(v) (Yl1 ? Yl1[(v)] : (real_t) 0.0)
@@ -22,13 +26,15 @@
 using namespace std;
 
 TPL CP_D1_QL1B::Cp_d1_ql1b(index_t V, index_t E, const index_t* first_edge,
-    const index_t* adj_vertices)
+    Adj_vertices<index_t> adj_vertices)
     : Cp_d1<real_t, index_t, comp_t>(V, E, first_edge, adj_vertices)
 {
     /* ensure handling of infinite values (negation, comparisons) is safe */
     static_assert(numeric_limits<real_t>::is_iec559,
         "Cut-pursuit d1 quadratic l1 bounds: real_t must satisfy IEEE 754.");
     Y = Yl1 = A = R = nullptr;
+    compressed_A = compressed_Y = nullptr;
+    quadratic_offset = ZERO;
     N = DIAG_ATA;
     a = ONE;
     l1_weights = nullptr; homo_l1_weight = ZERO;
@@ -37,6 +43,10 @@ TPL CP_D1_QL1B::Cp_d1_ql1b(index_t V, index_t E, const index_t* first_edge,
 
     pfdr_rho = 1.0; pfdr_cond_min = 1e-3; pfdr_dif_rcd = 0.0;
     pfdr_dif_tol = 1e-3*dif_tol; pfdr_it = pfdr_it_max = 1e4;
+    pfdr_mixed = false; pfdr_refine_it_max = 100;
+    mixed_Y = mixed_rA = nullptr;
+    exact_max_size = 200; exact_dif_tol = 1e-10; exact_it_max = 100;
+    exact_direct = false;
 
     /* it makes sense to consider nonevolving components as saturated;
      * beware of coupling when using complicated operator A though,
@@ -44,7 +54,8 @@ TPL CP_D1_QL1B::Cp_d1_ql1b(index_t V, index_t E, const index_t* first_edge,
     monitor_evolution = true;
 }
 
-TPL CP_D1_QL1B::~Cp_d1_ql1b(){ free(R); }
+TPL CP_D1_QL1B::~Cp_d1_ql1b()
+{ free(R); free(compressed_A); free(compressed_Y); free(mixed_Y); }
 
 TPL void CP_D1_QL1B::set_quadratic(const real_t* Y, size_t N, const real_t* A,
     real_t a)
@@ -55,6 +66,232 @@ TPL void CP_D1_QL1B::set_quadratic(const real_t* Y, size_t N, const real_t* A,
     free(R);
     R = IS_ATA(N) ? nullptr : (real_t*) malloc_check(sizeof(real_t)*N);
     this->Y = Y; this->N = N; this->A = A; this->a = a;
+    free(compressed_A); free(compressed_Y);
+    compressed_A = compressed_Y = nullptr;
+    free(mixed_Y); mixed_Y = nullptr;
+    quadratic_offset = ZERO;
+    check_gap_certificates();
+}
+
+TPL real_t CP_D1_QL1B::compress_quadratic(size_t sketch_size, real_t dist_tol)
+{
+    if (IS_ATA(N)){
+        cerr << "Cut-pursuit graph d1 quadratic l1 bounds: compression "
+            "requires a matrix in direct form (positive N), see "
+            "set_quadratic()." << endl;
+        exit(EXIT_FAILURE);
+    }
+    if (!sketch_size){
+        precompute_gram();
+        return ZERO;
+    }
+    return compute_sketch(sketch_size, dist_tol);
+}
+
+TPL void CP_D1_QL1B::set_compressed(real_t* cA, real_t* cY, size_t N)
+{
+    /* the previous compressed arrays might be the ones compressed again */
+    free(compressed_A); free(compressed_Y);
+    A = compressed_A = cA;
+    Y = compressed_Y = cY;
+    this->N = N;
+    free(R);
+    R = IS_ATA(N) ? nullptr : (real_t*) malloc_check(sizeof(real_t)*N);
+    free(mixed_Y); mixed_Y = nullptr;
+    check_gap_certificates();
+}
+
+TPL void CP_D1_QL1B::precompute_gram()
+{
+    real_t* AA = (real_t*) malloc_check(sizeof(real_t)*V*V);
+
+    /* fill lower triangular part of A^t A */
+    #pragma omp parallel for schedule(dynamic) NUM_THREADS(N*V*V/2, V)
+    for (index_t u = 0; u < V; u++){
+        const real_t *Au = A + N*u; // u-th column of A
+        real_t *AAu = AA + (size_t) V*u; // u-th column of A^t A
+        for (index_t v = u; v < V; v++){
+            const real_t *Av = A + N*v; // v-th column of A
+            AAu[v] = ZERO;
+            for (size_t n = 0; n < N; n++){ AAu[v] += Au[n]*Av[n]; }
+        }
+    }
+    /* fill upper triangular part */
+    #pragma omp parallel for schedule(dynamic) NUM_THREADS(V*V/2, V)
+    for (index_t u = 1; u < V; u++){
+        real_t *AAu = AA + (size_t) V*u;
+        size_t i = u;
+        for (index_t v = 0; v < u; v++){
+            AAu[v] = AA[i];
+            i += V;
+        }
+    }
+
+    real_t* AY = nullptr;
+    real_t YY = ZERO;
+    if (Y){ /* correlation with observation Y, and constant 1/2||Y||^2 */
+        AY = (real_t*) malloc_check(sizeof(real_t)*V);
+        #pragma omp parallel for schedule(static) NUM_THREADS(V*N, V)
+        for (index_t v = 0; v < V; v++){
+            const real_t *Av = A + N*v;
+            AY[v] = ZERO;
+            for (size_t n = 0; n < N; n++){ AY[v] += Av[n]*Y[n]; }
+        }
+        #pragma omp parallel for reduction(+:YY) schedule(static) \
+            NUM_THREADS(N)
+        for (size_t n = 0; n < N; n++){ YY += Y[n]*Y[n]; }
+    }
+
+    set_compressed(AA, AY, FULL_ATA);
+    quadratic_offset = HALF*YY;
+
+    if (verbose){
+        cout << "Cut-pursuit graph d1 quadratic l1 bounds: precomputed "
+            "A^t A." << endl;
+    }
+}
+
+TPL real_t CP_D1_QL1B::compute_sketch(size_t sketch_size, real_t dist_tol)
+{
+    size_t m = sketch_size;
+    if (m >= N){ return ZERO; } // nothing to compress
+
+    /**  probe residuals r = Y - A x, the first with x zero  **/
+    const int probe_num = 4;
+    real_t* probe_X = (real_t*) malloc_check(sizeof(real_t)*V*probe_num);
+    default_random_engine rand_gen; // default seed also enough for our purpose
+    normal_distribution<real_t> norm_distr;
+    for (index_t v = 0; v < V; v++){ probe_X[v] = ZERO; }
+    for (size_t i = V; i < (size_t) V*probe_num; i++){
+        probe_X[i] = norm_distr(rand_gen);
+    }
+
+    real_t* probe_R = (real_t*) malloc_check(sizeof(real_t)*N*probe_num);
+    /* run along blocks of observations, so that each block of the probe
+     * residuals stays in cache while reading the corresponding rows of A */
+    const size_t block_size = 1024;
+    const size_t block_num = (N - 1)/block_size + 1;
+    #pragma omp parallel for schedule(static) \
+        NUM_THREADS(N*V*probe_num, block_num)
+    for (size_t b = 0; b < block_num; b++){
+        const size_t first = b*block_size;
+        const size_t last = first + block_size < N ? first + block_size : N;
+        for (int p = 0; p < probe_num; p++){
+            real_t *Rp = probe_R + N*p;
+            for (size_t n = first; n < last; n++){ Rp[n] = Y_(n); }
+        }
+        for (index_t v = 0; v < V; v++){
+            const real_t *Av = A + N*v;
+            for (int p = 1; p < probe_num; p++){
+                const real_t Xpv = probe_X[(size_t) V*p + v];
+                real_t *Rp = probe_R + N*p;
+                for (size_t n = first; n < last; n++){ Rp[n] -= Av[n]*Xpv; }
+            }
+        }
+    }
+    free(probe_X);
+
+    /* the distortion is measured on the gradient of the quadratic part at
+     * the probes, -A^t r, which drives the splits; unlike the norms of the
+     * residuals, it accounts for the distortion of the range of A */
+    real_t* probe_G = (real_t*) malloc_check(sizeof(real_t)*V*probe_num);
+    #pragma omp parallel for schedule(static) NUM_THREADS(N*V*probe_num, V)
+    for (index_t v = 0; v < V; v++){
+        const real_t *Av = A + N*v;
+        for (int p = 0; p < probe_num; p++){
+            const real_t *Rp = probe_R + N*p;
+            real_t AvRp = ZERO;
+            for (size_t n = 0; n < N; n++){ AvRp += Av[n]*Rp[n]; }
+            probe_G[(size_t) V*p + v] = AvRp;
+        }
+    }
+    real_t probe_norms[probe_num];
+    for (int p = 0; p < probe_num; p++){
+        const real_t *Gp = probe_G + (size_t) V*p;
+        probe_norms[p] = ZERO;
+        for (index_t v = 0; v < V; v++){ probe_norms[p] += Gp[v]*Gp[v]; }
+    }
+
+    /**  draw the sketch, doubling its size until the distortion is small
+     **  enough; each row of A is sent to row (hash >> 1) of S A, with a
+     **  negative sign if (hash & 1)  **/
+    size_t* hash = (size_t*) malloc_check(sizeof(size_t)*N);
+    real_t* sketch_R = (real_t*) malloc_check(sizeof(real_t)*N*probe_num);
+    real_t *SA, *SY;
+    real_t distortion;
+    while (true){
+        uniform_int_distribution<size_t> unif_distr(0, 2*m - 1);
+        for (size_t n = 0; n < N; n++){ hash[n] = unif_distr(rand_gen); }
+
+        /* compute S A and S Y */
+        SA = (real_t*) malloc_check(sizeof(real_t)*m*V);
+        #pragma omp parallel for schedule(static) NUM_THREADS(N*V, V)
+        for (index_t v = 0; v < V; v++){
+            const real_t *Av = A + N*v;
+            real_t *SAv = SA + m*v;
+            for (size_t i = 0; i < m; i++){ SAv[i] = ZERO; }
+            for (size_t n = 0; n < N; n++){
+                if (hash[n] & 1){ SAv[hash[n] >> 1] -= Av[n]; }
+                else{ SAv[hash[n] >> 1] += Av[n]; }
+            }
+        }
+        /* S Y and the sketched probe residuals S r, one column each, the
+         * last one being S Y */
+        SY = Y ? (real_t*) malloc_check(sizeof(real_t)*m) : nullptr;
+        #pragma omp parallel for schedule(static) \
+            NUM_THREADS(N*(probe_num + 1), probe_num + 1)
+        for (int p = 0; p <= probe_num; p++){
+            if (p == probe_num && !Y){ continue; }
+            const real_t *Rp = p < probe_num ? probe_R + N*p : Y;
+            real_t *SRp = p < probe_num ? sketch_R + m*p : SY;
+            for (size_t i = 0; i < m; i++){ SRp[i] = ZERO; }
+            for (size_t n = 0; n < N; n++){
+                if (hash[n] & 1){ SRp[hash[n] >> 1] -= Rp[n]; }
+                else{ SRp[hash[n] >> 1] += Rp[n]; }
+            }
+        }
+
+        /* relative error of the sketched gradients (S A)^t S r */
+        real_t probe_errors[probe_num];
+        for (int p = 0; p < probe_num; p++){ probe_errors[p] = ZERO; }
+        #pragma omp parallel for schedule(static) \
+            NUM_THREADS(m*V*probe_num, V) \
+            reduction(+:probe_errors[:probe_num])
+        for (index_t v = 0; v < V; v++){
+            const real_t *SAv = SA + m*v;
+            for (int p = 0; p < probe_num; p++){
+                const real_t *SRp = sketch_R + m*p;
+                real_t dif = -probe_G[(size_t) V*p + v];
+                for (size_t i = 0; i < m; i++){ dif += SAv[i]*SRp[i]; }
+                probe_errors[p] += dif*dif;
+            }
+        }
+        distortion = ZERO;
+        for (int p = 0; p < probe_num; p++){
+            if (probe_norms[p] == ZERO){ continue; }
+            real_t dist = sqrt(probe_errors[p]/probe_norms[p]);
+            if (dist > distortion){ distortion = dist; }
+        }
+
+        if (verbose){
+            cout << "Cut-pursuit graph d1 quadratic l1 bounds: sketch of "
+                "size " << m << ", estimated distortion " << distortion
+                << "." << endl;
+        }
+        if (dist_tol <= ZERO || distortion <= dist_tol){ break; }
+        free(SA); free(SY);
+        SA = SY = nullptr;
+        m *= 2;
+        if (m >= N){ break; }
+    }
+    free(probe_R); free(probe_G); free(sketch_R); free(hash);
+
+    if (!SA){ return ZERO; } // leave uncompressed
+
+    set_compressed(SA, SY, m);
+    quadratic_offset = ZERO;
+
+    return distortion;
 }
 
 TPL void CP_D1_QL1B::set_l1(const real_t* l1_weights, real_t homo_l1_weight,
@@ -80,6 +317,31 @@ TPL void CP_D1_QL1B::set_bounds(const real_t* low_bnd, real_t homo_low_bnd,
     }
     this->low_bnd = low_bnd; this->homo_low_bnd = homo_low_bnd;
     this->upp_bnd = upp_bnd; this->homo_upp_bnd = homo_upp_bnd;
+    check_gap_certificates();
+}
+
+TPL void CP_D1_QL1B::set_gap_tol(real_t gap_tol)
+{
+    Cp_d1<real_t, index_t, comp_t>::set_gap_tol(gap_tol);
+    check_gap_certificates();
+}
+
+TPL void CP_D1_QL1B::check_gap_certificates()
+{
+    if (gap_tol == ZERO){ return; }
+    for (index_t v = 0; v < V; v++){
+        /* see certify() */
+        real_t alpha = N != DIAG_ATA ? ZERO : A ? A[v] : a ? ONE : ZERO;
+        if (alpha > ZERO){ continue; }
+        if (isinf(low_bnd ? low_bnd[v] : homo_low_bnd) ||
+            isinf(upp_bnd ? upp_bnd[v] : homo_upp_bnd)){
+            cerr << "Cut-pursuit graph d1 quadratic l1 bounds: duality gap "
+                "certificates require, on each vertex, either a positive "
+                "diagonal of A^t A or finite bounds (not the case on vertex "
+                << v << "), see set_gap_tol()." << endl;
+            exit(EXIT_FAILURE);
+        }
+    }
 }
 
 TPL void CP_D1_QL1B::set_pfdr_param(real_t rho, real_t cond_min,
@@ -92,11 +354,35 @@ TPL void CP_D1_QL1B::set_pfdr_param(real_t rho, real_t cond_min,
     this->pfdr_dif_tol = dif_tol;
 }
 
+TPL void CP_D1_QL1B::set_pfdr_mixed_precision(bool mixed, int refine_it_max)
+{
+    this->pfdr_mixed = mixed;
+    this->pfdr_refine_it_max = refine_it_max;
+    if (!mixed){ free(mixed_Y); mixed_Y = nullptr; }
+}
+
+TPL void CP_D1_QL1B::set_exact_reduced(comp_t max_size, real_t dif_tol,
+    int it_max, bool direct)
+{
+    if (dif_tol < ZERO || it_max < 0){
+        cerr << "Cut-pursuit graph d1 quadratic l1 bounds: exact reduced "
+            "solver tolerance and maximum number of iterations should be "
+            "nonnegative (" << dif_tol << " and " << it_max << ")." << endl;
+        exit(EXIT_FAILURE);
+    }
+    exact_max_size = max_size;
+    exact_dif_tol = dif_tol;
+    exact_it_max = it_max;
+    exact_direct = direct;
+}
+
 TPL void CP_D1_QL1B::solve_reduced_problem()
 /* NOTA: if Yl1 is not constant, this solves only an approximation, replacing
  * the weighted sum of distances to Yl1 by the distance to the weighted median
  * of Yl1 */
 {
+    schedule_reduced(pfdr_dif_tol, pfdr_it_max);
+
     /**  compute reduced matrix  **/
     real_t *rY, *rA, *rAA; // reduced observations, matrix, etc.
     rY = rA = rAA = nullptr;
@@ -108,8 +394,13 @@ TPL void CP_D1_QL1B::solve_reduced_problem()
      * with premultiplication: N rV^2 + rV^2 i operations
      *     + compute symmetrized reduced matrix: N rV^2
      *     + one matrix-vector mult. per pfdr iter. : rV^2 i
-     * conclusion: premultiplication if rV < (2 N i)/(N + i) */
-    size_t rN = !IS_ATA(N) && rV < (2*N*pfdr_it)/(N + pfdr_it) ? FULL_ATA : N;
+     * conclusion: premultiplication if rV < (2 N i)/(N + i);
+     * if the exact solver is enabled for direct form, small enough reduced
+     * problems are also premultiplied for it, the number of iterations i
+     * being then meaningless anyway */
+    size_t rN = !IS_ATA(N) && ((exact_direct && exact_max_size &&
+        rV <= exact_max_size) || rV < (2*N*pfdr_it)/(N + pfdr_it)) ?
+        FULL_ATA : N;
 
     if (IS_ATA(rN)){ /* reduced problem premultiplied by rA^t */
         if (Y){ rY = (real_t*) malloc_check(sizeof(real_t)*rV); }
@@ -125,14 +416,30 @@ TPL void CP_D1_QL1B::solve_reduced_problem()
     if (!IS_ATA(N)){ /* direct matricial main problem */
         rA = (real_t*) malloc_check(sizeof(real_t)*N*rV);
         for (size_t i = 0; i < N*rV; i++){ rA[i] = ZERO; }
-        #pragma omp parallel for schedule(dynamic) NUM_THREADS(N*V, rV)
+        if (pfdr_mixed && sizeof(real_t) > sizeof(float) && !IS_ATA(rN) &&
+            rV > 1){
+            /* single precision copies, see solve_reduced_pfdr() */
+            if (!mixed_Y){ convert_array(mixed_Y, Y, N); }
+            mixed_rA = (float*) malloc_check(sizeof(float)*N*rV);
+        }
+        /* if there are less components than threads, the remaining threads
+         * help along the observations, see Cp::get_task_num() */
+        #pragma omp parallel for schedule(dynamic) NUM_THREADS(N*V)
         for (comp_t rv = 0; rv < rV; rv++){
             real_t *rAv = rA + N*rv; // rv-th column of rA
+            component_tasks(get_task_num(N, first_vertex[rv + 1] -
+                first_vertex[rv]), N, [&](index_t first, index_t last)
+            {
             /* run along the component rv */
             for (index_t i = first_vertex[rv]; i < first_vertex[rv + 1]; i++){
                 const real_t *Av = A + N*comp_list[i];
-                for (size_t n = 0; n < N; n++){ rAv[n] += Av[n]; }
+                for (size_t n = first; n < last; n++){ rAv[n] += Av[n]; }
+            }
+            if (mixed_rA){
+                float *rAv_f = mixed_rA + N*rv;
+                for (size_t n = first; n < last; n++){ rAv_f[n] = rAv[n]; }
             }
+            });
         }
         if (rN == FULL_ATA){
             /* fill upper triangular part of rA^t rA */
@@ -161,14 +468,24 @@ TPL void CP_D1_QL1B::solve_reduced_problem()
         }
     }else{ /* main problem premultiplied by A^t */
         if (Y){ /* recall that observation Y is actually A^t Y */
-            #pragma omp parallel for schedule(dynamic) NUM_THREADS(V, rV)
+            /* if there are less components than threads, the remaining
+             * threads help within large components, see Cp::get_task_num() */
+            #pragma omp parallel for schedule(dynamic) NUM_THREADS(V)
             for (comp_t rv = 0; rv < rV; rv++){
+                const index_t comp_size = first_vertex[rv + 1] -
+                    first_vertex[rv];
+                const index_t* comp_vertices = comp_list + first_vertex[rv];
                 rY[rv] = ZERO;
-                /* run along the component rv */
-                for (index_t i = first_vertex[rv]; i < first_vertex[rv + 1];
-                    i++){
-                    rY[rv] += Y[comp_list[i]];
+                component_tasks(get_task_num(comp_size), comp_size,
+                    [&](index_t first, index_t last)
+                {
+                real_t sum = ZERO;
+                for (index_t i = first; i < last; i++){
+                    sum += Y[comp_vertices[i]];
                 }
+                #pragma omp atomic
+                rY[rv] += sum;
+                });
             }
         }
         if (N == FULL_ATA){ /* full matrix */
@@ -191,14 +508,22 @@ TPL void CP_D1_QL1B::solve_reduced_problem()
                 }
             }
         }else if (A){ /* diagonal matrix */
-            #pragma omp parallel for schedule(dynamic) NUM_THREADS(V, rV)
+            #pragma omp parallel for schedule(dynamic) NUM_THREADS(V)
             for (comp_t rv = 0; rv < rV; rv++){
+                const index_t comp_size = first_vertex[rv + 1] -
+                    first_vertex[rv];
+                const index_t* comp_vertices = comp_list + first_vertex[rv];
                 rAA[rv] = ZERO;
-                /* run along the component rv */
-                for (index_t i = first_vertex[rv]; i < first_vertex[rv + 1];
-                    i++){
-                    rAA[rv] += A[comp_list[i]];
+                component_tasks(get_task_num(comp_size), comp_size,
+                    [&](index_t first, index_t last)
+                {
+                real_t sum = ZERO;
+                for (index_t i = first; i < last; i++){
+                    sum += A[comp_vertices[i]];
                 }
+                #pragma omp atomic
+                rAA[rv] += sum;
+                });
             }
         }else if (a){ /* identity */
             #pragma omp parallel for schedule(static) NUM_THREADS(rV)
@@ -281,7 +606,6 @@ TPL void CP_D1_QL1B::solve_reduced_problem()
                     }
                 }
             }
-            real_t *rupp_bnd = nullptr;
             if (upp_bnd){
                 rupp_bnd[rv] = INF_REAL;
                 /* run along the component rv */
@@ -297,39 +621,72 @@ TPL void CP_D1_QL1B::solve_reduced_problem()
 
     if (rV == 1){ /**  single connected component  **/
 
-        /* solution of least-square + l1 */
-        real_t wl1 = rl1_weights ? *rl1_weights : ZERO;
-        real_t yl1 = rYl1 ? *rYl1 : ZERO;
-        if (*rY - wl1 > (*rAA)*yl1){ *rX = (*rY - wl1)/(*rAA); }
-        else if (*rY + wl1 < (*rAA)*yl1){ *rX = (*rY + wl1)/(*rAA); }
-        else{ *rX = yl1; }
-
-        /* aggregated lower bounds and proj */
-        real_t low = low_bnd ? *rlow_bnd : homo_low_bnd;
-        real_t upp = upp_bnd ? *rupp_bnd : homo_upp_bnd;
-        if (*rX < low){ *rX = low; }
-        if (*rX > upp){ *rX = upp; }
+        *rX = solve_reduced_vertex(rY ? *rY : ZERO, *rAA,
+            rl1_weights ? *rl1_weights : ZERO, rYl1 ? *rYl1 : ZERO,
+            low_bnd ? *rlow_bnd : homo_low_bnd,
+            upp_bnd ? *rupp_bnd : homo_upp_bnd);
 
     }else{ /**  preconditioned forward-Douglas-Rachford  **/
 
-        Pfdr_d1_ql1b<real_t, comp_t> *pfdr =
-            new Pfdr_d1_ql1b<real_t, comp_t>(rV, rE, reduced_edges);
-
-        pfdr->set_edge_weights(reduced_edge_weights);
-        if (IS_ATA(rN)){ pfdr->set_quadratic(rY, rN, rAA, a); }
-        else{ pfdr->set_quadratic(Y, N, rA); }
-        pfdr->set_l1(rl1_weights, ZERO, rYl1);
-        pfdr->set_bounds(rlow_bnd, homo_low_bnd, rupp_bnd, homo_upp_bnd);
-        pfdr->set_conditioning_param(pfdr_cond_min, pfdr_dif_rcd);
-        pfdr->set_relaxation(pfdr_rho);
-        pfdr->set_algo_param(pfdr_dif_tol, pfdr_it_max, verbose);
-        pfdr->set_iterate(rX);
-        pfdr->initialize_iterate();
+        /* with diagonal A^t A, the reduced problem decomposes along the
+         * connected components of the reduced graph */
+        pfdr_it = 0;
+        comp_t *rcomp_list, *first_rcomp_vertex, *rcomp_edges;
+        real_t *rcomp_edge_weights;
+        size_t *first_rcomp_edge;
+        comp_t rcomp_num = independent_reduced_solves && rN == DIAG_ATA &&
+            rAA ? compute_reduced_components(rcomp_list, first_rcomp_vertex,
+                rcomp_edges, rcomp_edge_weights, first_rcomp_edge) : 1;
 
-        pfdr_it = pfdr->precond_proximal_splitting();
+        if (rcomp_num > 1){ /**  independent subproblems  **/
+            if (verbose){
+                cout << "\t" << rcomp_num << " independent reduced problems"
+                    << endl;
+            }
+            comp_t large_size = large_reduced_component_size(rcomp_num);
+            /* large components one after the other, each in parallel */
+            for (comp_t rc = 0; rc < rcomp_num; rc++){
+                comp_t rcomp_size = first_rcomp_vertex[rc + 1] -
+                    first_rcomp_vertex[rc];
+                if (rcomp_size <= large_size){ continue; }
+                int it = solve_reduced_component(rcomp_size,
+                    rcomp_list + first_rcomp_vertex[rc],
+                    first_rcomp_edge[rc + 1] - first_rcomp_edge[rc],
+                    rcomp_edges + 2*first_rcomp_edge[rc],
+                    rcomp_edge_weights + first_rcomp_edge[rc],
+                    rY, rAA, rl1_weights, rYl1, rlow_bnd, rupp_bnd);
+                if (it > pfdr_it){ pfdr_it = it; }
+            }
+            /* the other ones in parallel */
+            int par_it = 0;
+            #pragma omp parallel for schedule(dynamic) \
+                NUM_THREADS(rV*pfdr_it_max, rcomp_num) reduction(max:par_it)
+            for (comp_t rc = 0; rc < rcomp_num; rc++){
+                comp_t rcomp_size = first_rcomp_vertex[rc + 1] -
+                    first_rcomp_vertex[rc];
+                if (rcomp_size > large_size){ continue; }
+                int it = solve_reduced_component(rcomp_size,
+                    rcomp_list + first_rcomp_vertex[rc],
+                    first_rcomp_edge[rc + 1] - first_rcomp_edge[rc],
+                    rcomp_edges + 2*first_rcomp_edge[rc],
+                    rcomp_edge_weights + first_rcomp_edge[rc],
+                    rY, rAA, rl1_weights, rYl1, rlow_bnd, rupp_bnd);
+                if (it > par_it){ par_it = it; }
+            }
+            if (par_it > pfdr_it){ pfdr_it = par_it; }
 
-        pfdr->set_iterate(nullptr); // prevent rX to be free()'d
-        delete pfdr;
+            free(rcomp_list); free(first_rcomp_vertex); free(rcomp_edges);
+            free(rcomp_edge_weights); free(first_rcomp_edge);
+        }else{
+            if (rcomp_num == 1 && independent_reduced_solves &&
+                rN == DIAG_ATA && rAA){
+                free(rcomp_list); free(first_rcomp_vertex); free(rcomp_edges);
+                free(rcomp_edge_weights); free(first_rcomp_edge);
+            }
+            pfdr_it = solve_reduced_iterative(rV, rE, reduced_edges,
+                reduced_edge_weights, rN, rY, rAA, rA, rl1_weights, rYl1,
+                rlow_bnd, rupp_bnd, rX, verbose);
+        }
 
     }
 
@@ -347,68 +704,296 @@ TPL void CP_D1_QL1B::solve_reduced_problem()
 
     free(rY); free(rA); free(rAA); free(rYl1);
     free(rl1_weights); free(rlow_bnd); free(rupp_bnd);
+    free(mixed_rA); mixed_rA = nullptr;
+
+    if (!reduced_decrease()){ solve_reduced_problem(); }
 }
 
-TPL index_t CP_D1_QL1B::split()
+TPL real_t CP_D1_QL1B::solve_reduced_vertex(real_t rY, real_t rAA,
+    real_t rl1_weight, real_t rYl1, real_t rlow_bnd, real_t rupp_bnd)
 {
-    index_t activation = 0;
-    real_t* grad = (real_t*) malloc_check(sizeof(real_t)*V);
-    for (index_t v = 0; v < V; v++){ grad[v] = ZERO; }
+    /* solution of least-square + l1 */
+    real_t rX;
+    if (rY - rl1_weight > rAA*rYl1){ rX = (rY - rl1_weight)/rAA; }
+    else if (rY + rl1_weight < rAA*rYl1){ rX = (rY + rl1_weight)/rAA; }
+    else{ rX = rYl1; }
+
+    /* aggregated bounds and proj */
+    if (rX < rlow_bnd){ rX = rlow_bnd; }
+    if (rX > rupp_bnd){ rX = rupp_bnd; }
+    return rX;
+}
+
+TPL int CP_D1_QL1B::solve_reduced_pfdr(comp_t rV, size_t rE,
+    const comp_t* reduced_edges, const real_t* reduced_edge_weights,
+    size_t rN, const real_t* rY, const real_t* rAA, const real_t* rA,
+    const real_t* rl1_weights, const real_t* rYl1, const real_t* rlow_bnd,
+    const real_t* rupp_bnd, real_t* rX, int verbose)
+{
+    real_t* Z = nullptr; // auxiliary variables for warm restart
+    int it = 0;
+
+    if (pfdr_mixed && sizeof(real_t) > sizeof(float)){
+    /**  iterate in single precision, refine in double precision  **/
+        float *rY_f = nullptr, *rAA_f = nullptr, *rl1_weights_f = nullptr,
+            *rYl1_f = nullptr, *rlow_bnd_f = nullptr, *rupp_bnd_f = nullptr,
+            *edge_weights_f = nullptr;
+        convert_array(edge_weights_f, reduced_edge_weights, rE);
+        if (IS_ATA(rN)){
+            convert_array(rY_f, rY, rV);
+            convert_array(rAA_f, rAA, rN == FULL_ATA ? (size_t) rV*rV :
+                rV);
+        } /* otherwise, copies built in solve_reduced_problem() */
+        convert_array(rl1_weights_f, rl1_weights, rV);
+        convert_array(rYl1_f, rYl1, rV);
+        convert_array(rlow_bnd_f, rlow_bnd, rV);
+        convert_array(rupp_bnd_f, rupp_bnd, rV);
+
+        Pfdr_d1_ql1b<float, comp_t> *pfdr_f =
+            new Pfdr_d1_ql1b<float, comp_t>(rV, rE, reduced_edges);
+
+        pfdr_f->set_edge_weights(edge_weights_f);
+        if (IS_ATA(rN)){ pfdr_f->set_quadratic(rY_f, rN, rAA_f, a); }
+        else{ pfdr_f->set_quadratic(mixed_Y, N, mixed_rA); }
+        pfdr_f->set_l1(rl1_weights_f, 0.0f, rYl1_f);
+        pfdr_f->set_bounds(rlow_bnd_f, homo_low_bnd, rupp_bnd_f,
+            homo_upp_bnd);
+        pfdr_f->set_conditioning_param(pfdr_cond_min, pfdr_dif_rcd);
+        pfdr_f->set_relaxation(pfdr_rho);
+        pfdr_f->set_cancel_flag(get_cancel_flag());
+        /* single precision cannot resolve much smaller evolutions */
+        pfdr_f->set_algo_param(max(reduced_dif_tol(pfdr_dif_tol),
+            (real_t) (1e2*numeric_limits<float>::epsilon())),
+            reduced_it_max(pfdr_it_max), verbose);
+        pfdr_f->initialize_iterate();
+
+        it = pfdr_f->precond_proximal_splitting();
+
+        convert_array(rX, pfdr_f->get_iterate(), rV);
+        convert_array(Z, pfdr_f->get_auxiliary(), 2*rE);
+        delete pfdr_f;
+
+        free(rY_f); free(rAA_f);
+        free(rl1_weights_f); free(rYl1_f); free(rlow_bnd_f);
+        free(rupp_bnd_f); free(edge_weights_f);
+    }
+
+    Pfdr_d1_ql1b<real_t, comp_t> *pfdr =
+        new Pfdr_d1_ql1b<real_t, comp_t>(rV, rE, reduced_edges);
+
+    pfdr->set_edge_weights(reduced_edge_weights);
+    if (IS_ATA(rN)){ pfdr->set_quadratic(rY, rN, rAA, a); }
+    else{ pfdr->set_quadratic(Y, N, rA); }
+    pfdr->set_l1(rl1_weights, ZERO, rYl1);
+    pfdr->set_bounds(rlow_bnd, homo_low_bnd, rupp_bnd, homo_upp_bnd);
+    pfdr->set_conditioning_param(pfdr_cond_min, pfdr_dif_rcd);
+    pfdr->set_relaxation(pfdr_rho);
+    pfdr->set_cancel_flag(get_cancel_flag());
+    pfdr->set_algo_param(reduced_dif_tol(pfdr_dif_tol),
+        reduced_it_max(Z ? pfdr_refine_it_max : pfdr_it_max), verbose);
+    pfdr->set_iterate(rX);
+    if (Z){ pfdr->set_auxiliary(Z); } // warm restart, Z free()'d by pfdr
+    else{ pfdr->initialize_iterate(); }
+
+    it += pfdr->precond_proximal_splitting();
+
+    pfdr->set_iterate(nullptr); // prevent rX to be free()'d
+    delete pfdr;
+
+    return it;
+}
+
+TPL int CP_D1_QL1B::solve_reduced_pd(comp_t rV, size_t rE,
+    const comp_t* reduced_edges, const real_t* reduced_edge_weights,
+    size_t rN, const real_t* rY, const real_t* rAA, const real_t* rA,
+    const real_t* rl1_weights, const real_t* rYl1, const real_t* rlow_bnd,
+    const real_t* rupp_bnd, real_t* rX, int verbose)
+{
+    Pd_d1_ql1b<real_t, comp_t> *pd =
+        new Pd_d1_ql1b<real_t, comp_t>(rV, rE, reduced_edges);
+
+    pd->set_edge_weights(reduced_edge_weights);
+    if (IS_ATA(rN)){ pd->set_quadratic(rY, rN, rAA, a); }
+    else{ pd->set_quadratic(Y, N, rA); }
+    pd->set_l1(rl1_weights, ZERO, rYl1);
+    pd->set_bounds(rlow_bnd, homo_low_bnd, rupp_bnd, homo_upp_bnd);
+    pd->set_dual_scale(pd_dual_scale);
+    pd->set_cancel_flag(get_cancel_flag());
+    pd->set_algo_param(reduced_dif_tol(pfdr_dif_tol),
+        reduced_it_max(pfdr_it_max), verbose);
+    pd->set_iterate(rX);
+    pd->initialize_iterate();
+
+    int it = pd->precond_proximal_splitting();
+
+    pd->set_iterate(nullptr); // prevent rX to be free()'d
+    delete pd;
+
+    return it;
+}
+
+TPL int CP_D1_QL1B::solve_reduced_exact(comp_t rV, size_t rE,
+    const comp_t* reduced_edges, const real_t* reduced_edge_weights,
+    size_t rN, const real_t* rY, const real_t* rAA,
+    const real_t* rl1_weights, const real_t* rYl1, const real_t* rlow_bnd,
+    const real_t* rupp_bnd, real_t* rX, int verbose)
+{
+    Ssnal_d1_ql1b<real_t, comp_t> *ssnal =
+        new Ssnal_d1_ql1b<real_t, comp_t>(rV, rE, reduced_edges);
+
+    ssnal->set_edge_weights(reduced_edge_weights);
+    ssnal->set_quadratic(rY, rN, rAA);
+    ssnal->set_l1(rl1_weights, ZERO, rYl1);
+    ssnal->set_bounds(rlow_bnd, homo_low_bnd, rupp_bnd, homo_upp_bnd);
+    ssnal->set_cancel_flag(get_cancel_flag());
+    /* cannot be more precise than the numeric type */
+    ssnal->set_algo_param(max(exact_dif_tol,
+        (real_t) (1e2*numeric_limits<real_t>::epsilon())), exact_it_max,
+        verbose);
+    ssnal->set_iterate(rX);
+    ssnal->initialize_iterate();
+
+    int it = ssnal->solve();
+    if (!ssnal->is_converged()){ it = -1; }
+
+    ssnal->set_iterate(nullptr); // prevent rX to be free()'d
+    delete ssnal;
+
+    return it;
+}
+
+TPL int CP_D1_QL1B::solve_reduced_iterative(comp_t rV, size_t rE,
+    const comp_t* reduced_edges, const real_t* reduced_edge_weights,
+    size_t rN, const real_t* rY, const real_t* rAA, const real_t* rA,
+    const real_t* rl1_weights, const real_t* rYl1, const real_t* rlow_bnd,
+    const real_t* rupp_bnd, real_t* rX, int verbose)
+{
+    if (exact_max_size && rV <= exact_max_size && IS_ATA(rN) && rAA){
+        int it = solve_reduced_exact(rV, rE, reduced_edges,
+            reduced_edge_weights, rN, rY, rAA, rl1_weights, rYl1, rlow_bnd,
+            rupp_bnd, rX, verbose);
+        if (it >= 0){ return it; }
+    }
+    /* curvature of the quadratic part, only informative if diagonal */
+    if (use_primal_dual(rV, rE, reduced_edges, reduced_edge_weights,
+            rN == DIAG_ATA ? rAA : nullptr)){
+        return solve_reduced_pd(rV, rE, reduced_edges, reduced_edge_weights,
+            rN, rY, rAA, rA, rl1_weights, rYl1, rlow_bnd, rupp_bnd, rX,
+            verbose);
+    }else{
+        return solve_reduced_pfdr(rV, rE, reduced_edges,
+            reduced_edge_weights, rN, rY, rAA, rA, rl1_weights, rYl1,
+            rlow_bnd, rupp_bnd, rX, verbose);
+    }
+}
+
+TPL int CP_D1_QL1B::solve_reduced_component(comp_t rcomp_size,
+    const comp_t* rcomp_vertices, size_t rcomp_E, const comp_t* rcomp_edges,
+    const real_t* rcomp_edge_weights, const real_t* rY, const real_t* rAA,
+    const real_t* rl1_weights, const real_t* rYl1, const real_t* rlow_bnd,
+    const real_t* rupp_bnd)
+{
+    if (rcomp_size == 1){ /**  closed form, as for a single component  **/
+        comp_t rv = rcomp_vertices[0];
+        rX[rv] = solve_reduced_vertex(rY ? rY[rv] : ZERO, rAA[rv],
+            rl1_weights ? rl1_weights[rv] : ZERO, rYl1 ? rYl1[rv] : ZERO,
+            rlow_bnd ? rlow_bnd[rv] : homo_low_bnd,
+            rupp_bnd ? rupp_bnd[rv] : homo_upp_bnd);
+        return 0;
+    }
+
+    real_t *rcomp_Y = nullptr, *rcomp_AA = nullptr, *rcomp_l1_weights =
+        nullptr, *rcomp_Yl1 = nullptr, *rcomp_low_bnd = nullptr,
+        *rcomp_upp_bnd = nullptr;
+    gather_array(rcomp_Y, rY, rcomp_vertices, rcomp_size);
+    gather_array(rcomp_AA, rAA, rcomp_vertices, rcomp_size);
+    gather_array(rcomp_l1_weights, rl1_weights, rcomp_vertices, rcomp_size);
+    gather_array(rcomp_Yl1, rYl1, rcomp_vertices, rcomp_size);
+    gather_array(rcomp_low_bnd, rlow_bnd, rcomp_vertices, rcomp_size);
+    gather_array(rcomp_upp_bnd, rupp_bnd, rcomp_vertices, rcomp_size);
+    real_t* rcomp_X = (real_t*) malloc_check(sizeof(real_t)*rcomp_size);
+
+    int it = solve_reduced_iterative(rcomp_size, rcomp_E, rcomp_edges,
+        rcomp_edge_weights, DIAG_ATA, rcomp_Y, rcomp_AA, nullptr,
+        rcomp_l1_weights, rcomp_Yl1, rcomp_low_bnd, rcomp_upp_bnd, rcomp_X,
+        0);
+
+    for (comp_t i = 0; i < rcomp_size; i++){
+        rX[rcomp_vertices[i]] = rcomp_X[i];
+    }
+
+    free(rcomp_Y); free(rcomp_AA); free(rcomp_l1_weights); free(rcomp_Yl1);
+    free(rcomp_low_bnd); free(rcomp_upp_bnd); free(rcomp_X);
+    return it;
+}
+
+TPL void CP_D1_QL1B::compute_gradient(real_t* grad, bool skip_saturated)
+{
+    /* vertices where the gradient is computed, all of them if not listed in
+     * the temporary components list */
+    const bool listed = skip_saturated && saturation_count;
+    const index_t num = listed ? list_unsaturated_vertices() : V;
 
     /**  gradient of quadratic term  **/ 
     if (!IS_ATA(N)){ /* direct matricial case, grad = -(A^t) R */
-        #pragma omp parallel for schedule(static) NUM_THREADS(V*N, V)
-        for (index_t v = 0; v < V; v++){
+        #pragma omp parallel for schedule(static) NUM_THREADS(num*N, num)
+        for (index_t i = 0; i < num; i++){
+            index_t v = listed ? get_tmp_comp_list(i) : i;
             const real_t *Av = A + N*v;
+            grad[v] = ZERO;
             for (size_t n = 0; n < N; n++){ grad[v] -= Av[n]*R[n]; }
         }
     }else if (N == FULL_ATA){ /* grad = (A^t A)*X - A^t Y  */
-        #pragma omp parallel for schedule(static) NUM_THREADS(V*V, V)
-        for (index_t u = 0; u < V; u++){
+        #pragma omp parallel for schedule(static) NUM_THREADS(num*V, num)
+        for (index_t i = 0; i < num; i++){
+            index_t u = listed ? get_tmp_comp_list(i) : i;
             const real_t *Au = A + (size_t) V*u;
+            grad[u] = ZERO;
             for (comp_t rv = 0; rv < rV; rv++){
                 if (rX[rv] == ZERO){ continue; }
                 real_t aurv = ZERO; /* sum u-th row of (A^t A), rv-th comp */
                 /* run along the component rv */
-                for (index_t i = first_vertex[rv]; i < first_vertex[rv + 1];
-                    i++){
+                for (index_t j = first_vertex[rv]; j < first_vertex[rv + 1];
+                    j++){
                     /* can sum column wise, by symmetry */
-                    aurv += Au[comp_list[i]]; 
+                    aurv += Au[comp_list[j]]; 
                 }
                 grad[u] += aurv*rX[rv];
             }
             grad[u] -= Y_(u);
         }
-    }else if (A){ /* diagonal case, grad = (A^t A) X - A^t Y */
-        #pragma omp parallel for schedule(static) NUM_THREADS(V)
-        for (index_t v = 0; v < V; v++){
-            grad[v] = A[v]*rX[comp_assign[v]] - Y_(v);
-        }
-    }else if (a){ /* identity matrix */
-        #pragma omp parallel for schedule(static) NUM_THREADS(V)
-        for (index_t v = 0; v < V; v++){
-            grad[v] = rX[comp_assign[v]] - Y_(v);
+    }else{ /* diagonal case, grad = (A^t A) X - A^t Y */
+        #pragma omp parallel for schedule(static) NUM_THREADS(num)
+        for (index_t i = 0; i < num; i++){
+            index_t v = listed ? get_tmp_comp_list(i) : i;
+            grad[v] = A ? A[v]*rX[comp_assign[v]] - Y_(v) :
+                      a ? rX[comp_assign[v]] - Y_(v) : ZERO;
         }
     }
 
-    /**  differentiable d1 contribution to the gradient  **/ 
-    #pragma omp parallel for schedule(static) NUM_THREADS(E, V)
-    for (index_t u = 0; u < V; u++){
-        for (index_t e = first_edge[u]; e < first_edge[u + 1]; e++){
-            if (is_active(e)){
-                index_t v = adj_vertices[e];
-                real_t grad_d1 = rX[comp_assign[u]] > rX[comp_assign[v]] ?
-                    EDGE_WEIGHTS_(e) : -EDGE_WEIGHTS_(e);
-                grad[u] += grad_d1;
-                grad[v] -= grad_d1;
-            }
-        }
+    /**  differentiable d1 contribution to the gradient; each vertex scans
+     **  the active edges involving it in either direction, so that only the
+     **  listed vertices are visited and no concurrent update occurs  **/ 
+    #pragma omp parallel for schedule(static) \
+        NUM_THREADS((uintmax_t) 2*E*num/V, num)
+    for (index_t i = 0; i < num; i++){
+        index_t u = listed ? get_tmp_comp_list(i) : i;
+        const real_t rXu = rX[comp_assign[u]];
+        incident_edges(u, [&](index_t e, index_t v, bool forward){
+            if (!is_active(e)){ return; }
+            /* sign given along the edge direction, as it matters for ties */
+            const real_t rXv = rX[comp_assign[v]];
+            real_t grad_d1 = (forward ? rXu > rXv : rXv > rXu) ?
+                EDGE_WEIGHTS_(e) : -EDGE_WEIGHTS_(e);
+            grad[u] += forward ? grad_d1 : -grad_d1;
+        });
     }
 
     /**  differentiable l1 contribution  **/
     if (l1_weights || homo_l1_weight){
-        #pragma omp parallel for schedule(dynamic) NUM_THREADS(V, rV)
+        #pragma omp parallel for schedule(dynamic) NUM_THREADS(num, rV)
         for (comp_t rv = 0; rv < rV; rv++){
+            if (listed && is_saturated(rv)){ continue; }
             for (index_t i = first_vertex[rv]; i < first_vertex[rv + 1]; i++){
                 index_t v = comp_list[i];
                 if (rX[rv] > Yl1_(v)){ grad[v] += L1_WEIGHTS_(v); }
@@ -416,127 +1001,94 @@ TPL index_t CP_D1_QL1B::split()
             }
         }
     }
+}
+
+TPL index_t CP_D1_QL1B::split()
+{
+    index_t activation = 0;
+    real_t* grad = certified_grad; // see Cp_d1::certified_grad
+    certified_grad = nullptr;
+    if (!grad){
+        grad = (real_t*) malloc_check(sizeof(real_t)*V);
+        compute_gradient(grad, true);
+    }
+
+    /**  set capacities and compute min cuts in parallel along components;
+     **  if there are less components than threads, the remaining threads
+     **  help within large components, see Cp::get_task_num()  **/
+    const uintmax_t ops_per_vertex = 2 + 5*E/V;
+    const bool no_l1_bnd = !l1_weights && !homo_l1_weight && !low_bnd &&
+        !upp_bnd && homo_low_bnd == -INF_REAL && homo_upp_bnd == INF_REAL;
 
-    /**  set capacities and compute min cuts in parallel along components  **/
-    #pragma omp parallel NUM_THREADS(2*V + 5*E, rV)
+    #pragma omp parallel NUM_THREADS(2*V + 5*E, V, OMP_GRAPH)
     {
 
-    Cp_graph<real_t, index_t, comp_t>* Gpar = get_parallel_flow_graph();
+    Flow_graph* Gpar = get_parallel_flow_graph();
 
     #pragma omp for schedule(dynamic) reduction(+:activation)
     for (comp_t rv = 0; rv < rV; rv++){
-        if (is_saturated(rv)){ continue; }
+        if (is_saturated(rv) || is_cancelled()){ continue; }
         index_t rv_activation = 0;
+        const index_t comp_size = first_vertex[rv + 1] - first_vertex[rv];
+        const index_t* comp_vertices = comp_list + first_vertex[rv];
+        const index_t task_num = get_task_num(comp_size, ops_per_vertex);
+        Maxflow_engine engine = get_maxflow_engine(rv);
 
-        /**  first cut: directions +1_U  **/
+        /* cut in the direction +1_U (upward) or -1_U (downward) */
+        for (int upward = 1; upward >= 0; upward--){
 
-        /* set the source/sink capacities */
-        for (index_t i = first_vertex[rv]; i < first_vertex[rv + 1]; i++){
-            index_t v = comp_list[i];
-            set_term_capacities(v, grad[v]);
-        }
-        /* l1 contribution is positive at zero */
-        if (l1_weights || homo_l1_weight){ 
-            for (index_t i = first_vertex[rv]; i < first_vertex[rv + 1]; i++){
-                index_t v = comp_list[i];
-                if (rX[rv] == Yl1_(v)){
-                    add_term_capacities(v, L1_WEIGHTS_(v));
-                }
-            }
-        }
-        /* box constraint contribution is infinite at the upper bound */
-        if (upp_bnd){
-            for (index_t i = first_vertex[rv]; i < first_vertex[rv + 1]; i++){
-                index_t v = comp_list[i];
-                if (rX[rv] == upp_bnd[v]){ set_term_capacities(v, INF_REAL); }
-            }
-        }else if (homo_upp_bnd < INF_REAL && rX[rv] == homo_upp_bnd){
-            for (index_t i = first_vertex[rv]; i < first_vertex[rv + 1]; i++){
-                set_term_capacities(comp_list[i], INF_REAL);
-            }
-        }
-        /* set the d1 edge capacities */
-        for (index_t i = first_vertex[rv]; i < first_vertex[rv + 1]; i++){
-            index_t v = comp_list[i];
-            for (index_t e = first_edge[v]; e < first_edge[v + 1]; e++){
-                if (!is_active(e)){
-                    set_edge_capacities(e, EDGE_WEIGHTS_(e), EDGE_WEIGHTS_(e));
-                }
-            }
-        }
-        /* find min cut and activate edges correspondingly */
-        Gpar->maxflow(first_vertex[rv + 1] - first_vertex[rv],
-            comp_list + first_vertex[rv]);
-
-        for (index_t i = first_vertex[rv]; i < first_vertex[rv + 1]; i++){
-            index_t v = comp_list[i];
-            for (index_t e = first_edge[v]; e < first_edge[v + 1]; e++){
-                if (!is_active(e) && is_sink(v) != is_sink(adj_vertices[e])){
-                    set_active(e);
-                    rv_activation++;
-                }
-            }
-        }
-
-        /**  when no nondifferentiable part exists besides the total variation, 
-         **  only one cut is required, for direction 1_U - 1_Uc, and it is 
-         **  equivalent to the above cut  **/
-        if (!l1_weights && !homo_l1_weight && !low_bnd && !upp_bnd &&
-            homo_low_bnd == -INF_REAL && homo_upp_bnd == INF_REAL){
-            set_saturation(rv, rv_activation == 0);
-            activation += rv_activation;
-            continue;
-        }
+        /**  when no nondifferentiable part exists besides the total variation,
+         **  only one cut is required, for direction 1_U - 1_Uc, and it is
+         **  equivalent to the first cut  **/
+        if (!upward && no_l1_bnd){ break; }
 
-        /**  second cut: directions -1_U  **/
-        /* set the source/sink capacities */
-        for (index_t i = first_vertex[rv]; i < first_vertex[rv + 1]; i++){
-            index_t v = comp_list[i];
+        /* set the source/sink and d1 edge capacities */
+        component_tasks(task_num, comp_size, [&](index_t first, index_t last)
+        {
+        for (index_t i = first; i < last; i++){
+            index_t v = comp_vertices[i];
             set_term_capacities(v, grad[v]);
-        }
-        /* l1 contribution is negative at zero */
-        if (l1_weights || homo_l1_weight){
-            for (index_t i = first_vertex[rv]; i < first_vertex[rv + 1]; i++){
-                index_t v = comp_list[i];
-                if (rX[rv] == Yl1_(v)){
-                    add_term_capacities(v, -L1_WEIGHTS_(v));
-                }
+            /* l1 contribution is positive at zero upward, negative downward */
+            if ((l1_weights || homo_l1_weight) && rX[rv] == Yl1_(v)){
+                add_term_capacities(v, upward ? L1_WEIGHTS_(v) :
+                    -L1_WEIGHTS_(v));
             }
-        }
-        /* box constraint contribution is infinite at the lower bound */
-        if (low_bnd){
-            for (index_t i = first_vertex[rv]; i < first_vertex[rv + 1]; i++){
-                index_t v = comp_list[i];
-                if (rX[rv] == low_bnd[v]){ set_term_capacities(v, -INF_REAL); }
+            /* box constraint contribution is infinite at the upper bound
+             * upward, at the lower bound downward */
+            if (upward && rX[rv] == (upp_bnd ? upp_bnd[v] : homo_upp_bnd)){
+                set_term_capacities(v, INF_REAL);
+            }else if (!upward &&
+                rX[rv] == (low_bnd ? low_bnd[v] : homo_low_bnd)){
+                set_term_capacities(v, -INF_REAL);
             }
-        }else if (homo_low_bnd > -INF_REAL && rX[rv] == homo_low_bnd){
-            for (index_t i = first_vertex[rv]; i < first_vertex[rv + 1]; i++){
-                set_term_capacities(comp_list[i], -INF_REAL);
-            }
-        }
-        /* set the d1 edge capacities */
-        #pragma omp parallel for schedule(static) NUM_THREADS(E)
-        for (index_t i = first_vertex[rv]; i < first_vertex[rv + 1]; i++){
-            index_t v = comp_list[i];
             for (index_t e = first_edge[v]; e < first_edge[v + 1]; e++){
                 if (!is_active(e)){
                     set_edge_capacities(e, EDGE_WEIGHTS_(e), EDGE_WEIGHTS_(e));
                 }
             }
         }
+        });
+
         /* find min cut and activate edges correspondingly */
-        Gpar->maxflow(first_vertex[rv + 1] - first_vertex[rv],
-            comp_list + first_vertex[rv]);
+        compute_maxflow(Gpar, comp_size, comp_vertices, engine);
 
-        for (index_t i = first_vertex[rv]; i < first_vertex[rv + 1]; i++){
-            index_t v = comp_list[i];
+        component_tasks(task_num, comp_size, [&](index_t first, index_t last)
+        {
+        index_t task_activation = 0;
+        for (index_t i = first; i < last; i++){
+            index_t v = comp_vertices[i];
             for (index_t e = first_edge[v]; e < first_edge[v + 1]; e++){
-                if (!is_active(e) && is_sink(v) != is_sink(adj_vertices[e])){
+                if (!is_active(e) && is_sink(v) != is_sink(adj_vertex(e))){
                     set_active(e);
-                    rv_activation++;
+                    task_activation++;
                 }
             }
         }
+        #pragma omp atomic
+        rv_activation += task_activation;
+        });
+
+        } // end for upward
 
         set_saturation(rv, rv_activation == 0);
         activation += rv_activation;
@@ -588,6 +1140,90 @@ TPL real_t CP_D1_QL1B::compute_evolution(bool compute_dif)
     }
 }
 
+TPL real_t CP_D1_QL1B::vertex_gap(real_t x, real_t alpha, real_t p,
+    real_t l1_weight, real_t yl1, real_t low_bnd, real_t upp_bnd)
+{
+    /* minimizer of phi, soft-thresholding followed by clipping */
+    real_t x_min;
+    if (alpha > ZERO){
+        real_t t = p/alpha - yl1, thr = l1_weight/alpha;
+        x_min = yl1 + (t > thr ? t - thr : t < -thr ? t + thr : ZERO);
+    }else if (p > l1_weight){
+        x_min = upp_bnd;
+    }else if (p < -l1_weight){
+        x_min = low_bnd;
+    }else{
+        x_min = yl1;
+    }
+    if (x_min > upp_bnd){ x_min = upp_bnd; }
+    else if (x_min < low_bnd){ x_min = low_bnd; }
+    if (isinf(x_min)){ return INF_REAL; } // phi is unbounded below
+
+    real_t gap = (HALF*alpha*x - p)*x + l1_weight*abs(x - yl1)
+        - (HALF*alpha*x_min - p)*x_min - l1_weight*abs(x_min - yl1);
+    return gap > ZERO ? gap : ZERO;
+}
+
+TPL real_t CP_D1_QL1B::certify()
+{
+    real_t* grad = (real_t*) malloc_check(sizeof(real_t)*V);
+    compute_gradient(grad);
+
+    /**  the gradient is routed across the components, up to the
+     **  subdifferential of the l1 norm and of the box constraint; since the
+     **  l1 norm is differentiated only where the iterate differs from its
+     **  observation, its subdifferential is taken only there  **/
+    const bool l1 = l1_weights || homo_l1_weight;
+    real_t* out_min = (real_t*) malloc_check(sizeof(real_t)*V);
+    real_t* out_max = (real_t*) malloc_check(sizeof(real_t)*V);
+    #pragma omp parallel for schedule(static) NUM_THREADS(V)
+    for (index_t v = 0; v < V; v++){
+        real_t x = rX[comp_assign[v]];
+        out_min[v] = out_max[v] = grad[v];
+        if (l1 && x == Yl1_(v)){
+            out_min[v] -= L1_WEIGHTS_(v);
+            out_max[v] += L1_WEIGHTS_(v);
+        }
+        /* normal cones of the box constraint */
+        if (x == (low_bnd ? low_bnd[v] : homo_low_bnd)){
+            out_min[v] = -INF_REAL;
+        }
+        if (x == (upp_bnd ? upp_bnd[v] : homo_upp_bnd)){
+            out_max[v] = INF_REAL;
+        }
+    }
+
+    compute_dual_flows(out_min, out_max);
+    free(out_max);
+
+    /**  contribution of each vertex; the dual of the total variation along
+     **  active edges is its subgradient used in the gradient, so that the
+     **  contributions of the edges are zero  **/
+    real_t* vert_gap = out_min; // reuse storage
+    #pragma omp parallel for schedule(static) NUM_THREADS(V)
+    for (index_t v = 0; v < V; v++){
+        real_t x = rX[comp_assign[v]];
+        /* only the separable quadratic part is taken into account exactly,
+         * otherwise the gradient of the quadratic part is kept constant */
+        real_t alpha = N != DIAG_ATA ? ZERO : A ? A[v] : a ? ONE : ZERO;
+        real_t l1_weight = l1 ? L1_WEIGHTS_(v) : ZERO;
+        /* the dual variable is the opposite of the divergence of the flows;
+         * remove the gradient from the rest of the objective */
+        real_t p = alpha*x - grad[v] + dual_flows[v];
+        if (x > Yl1_(v)){ p += l1_weight; }
+        else if (x < Yl1_(v)){ p -= l1_weight; }
+        vert_gap[v] = vertex_gap(x, alpha, p, l1_weight, Yl1_(v),
+            low_bnd ? low_bnd[v] : homo_low_bnd,
+            upp_bnd ? upp_bnd[v] : homo_upp_bnd);
+    }
+    free(certified_grad);
+    certified_grad = grad;
+
+    real_t gap = certify_components(vert_gap);
+    free(vert_gap);
+    return gap;
+}
+
 TPL real_t CP_D1_QL1B::compute_objective()
 /* unfortunately, at this point one does not have access to the reduced objects
  * computed in the routine solve_reduced_problem() */
@@ -631,6 +1267,7 @@ TPL real_t CP_D1_QL1B::compute_objective()
             }
             obj += rX[ru]*(sumrAAuvXv - rAYu);
         }
+        obj += quadratic_offset;
     }else if (A || a){ /* diagonal matrix */
         #pragma omp parallel for reduction(+:obj) schedule(dynamic) \
             NUM_THREADS(V, rV)
@@ -7,7 +7,8 @@
 #define ZERO ((real_t) 0.0)
 #define ONE ((real_t) 1.0)
 #define INF_REAL (std::numeric_limits<real_t>::infinity())
-#define EDGE_WEIGHTS_(e) (edge_weights ? edge_weights[(e)] : homo_edge_weight)
+#define EDGE_WEIGHTS_(e) (edge_weights ? edge_weights[(e)] : \
+    quantized_edge_weights ? quantized_edge_weights[(e)] : homo_edge_weight)
 /* avoid overflows */
 #define rVp1 ((size_t) rV + 1)
 /* specific flags */
@@ -18,6 +19,13 @@
 /* maximum number of edges; no edge can have this identifier */
 #define NO_EDGE (std::numeric_limits<index_t>::max())
 
+/* min cuts over components up to this size are found by enumeration */
+#define ENUMERATION_MAX_SIZE 4
+
+/* components are gathered into a local flow graph only if the range of their
+ * vertex indices is at least this multiple of their size */
+#define GATHER_MIN_SPREAD 4
+
 #define TPL template <typename real_t, typename index_t, typename comp_t, \
     typename value_t>
 #define CP Cp<real_t, index_t, comp_t, value_t>
@@ -25,20 +33,30 @@
 using namespace std; 
 
 TPL CP::Cp(index_t V, index_t E, const index_t* first_edge,
-    const index_t* adj_vertices, size_t D)
-    : V(V), E(E), first_edge(first_edge), adj_vertices(adj_vertices), D(D)
+    Adj_vertices<index_t> adj_vertices, size_t D)
+    : V(V), E(E), first_edge(first_edge), D(D)
 {
     /* real type with infinity is handy */
     static_assert(numeric_limits<real_t>::has_infinity,
         "Cut-pursuit: real_t must be able to represent infinity.");
 
     /* construct graph */
-    G = new Cp_graph<real_t, index_t, comp_t>(V, E);
+    G = new Flow_graph(V, E);
     G->add_node(V);
     /* edges */
-    for (index_t v = 0; v < V; v++){
-        for (index_t e = first_edge[v]; e < first_edge[v + 1]; e++){
-            G->add_edge(v, adj_vertices[e], ZERO, ZERO);
+    if (adj_vertices.compressed){
+        typename Compressed_adjacency<index_t>::Decoder
+            decoder(*adj_vertices.compressed);
+        for (index_t v = 0; v < V; v++){
+            for (index_t e = first_edge[v]; e < first_edge[v + 1]; e++){
+                G->add_edge(v, decoder.next(), ZERO, ZERO);
+            }
+        }
+    }else{
+        for (index_t v = 0; v < V; v++){
+            for (index_t e = first_edge[v]; e < first_edge[v + 1]; e++){
+                G->add_edge(v, adj_vertices.array[e], ZERO, ZERO);
+            }
         }
     }
     /* source/sink edges does not need to be initialized */
@@ -53,12 +71,22 @@ TPL CP::Cp(index_t V, index_t E, const index_t* first_edge,
     reduced_edges = nullptr;
     elapsed_time = nullptr;
     objective_values = iterate_evolution = nullptr;
+    control = nullptr;
     rX = last_rX = nullptr;
+    pending_update = false;
+    exact_reduced = approx_reduced = false;
+    first_split = false;
+    last_activation = 0;
     
     it_max = 10; verbose = 1000;
-    dif_tol = ZERO;
+    dif_tol = gap_tol = ZERO;
     eps = numeric_limits<real_t>::epsilon();
     monitor_evolution = false;
+    balance_tol = 0.5;
+    maxflow_engine = MAXFLOW_BK;
+    maxflow_auto_min_size = 10000;
+    maxflow_auto_dense_degree = 16.0;
+    maxflow_gather_min_size = 0;
 }
 
 TPL CP::~Cp()
@@ -77,6 +105,13 @@ TPL void CP::set_edge_weights(const real_t* edge_weights,
 {
     this->edge_weights = edge_weights;
     this->homo_edge_weight = homo_edge_weight;
+    quantized_edge_weights = Quantized_array<real_t>();
+}
+
+TPL void CP::set_quantized_edge_weights(Quantized_array<real_t> edge_weights)
+{
+    this->edge_weights = nullptr;
+    quantized_edge_weights = edge_weights;
 }
 
 TPL void CP::set_monitoring_arrays(real_t* objective_values,
@@ -88,15 +123,24 @@ TPL void CP::set_monitoring_arrays(real_t* objective_values,
     if (iterate_evolution){ monitor_evolution = true; }
 }
 
-TPL void CP::set_components(comp_t rV, comp_t* comp_assign)
+TPL void CP::set_control(Cp_control* control){ this->control = control; }
+
+TPL void CP::set_components(comp_t rV, comp_t* comp_assign,
+    real_t balance_tol)
 {
     if (rV > 1 && !comp_assign){
         cerr << "Cut-pursuit: if an initial number of components greater than "
             "unity is given, components assignment must be provided." << endl;
         exit(EXIT_FAILURE);
     }
+    if (balance_tol < ZERO){
+        cerr << "Cut-pursuit: size balance tolerance of arbitrary components "
+            "must be nonnegative (" << balance_tol << " given)." << endl;
+        exit(EXIT_FAILURE);
+    }
     this->rV = rV;
     this->comp_assign = comp_assign;
+    this->balance_tol = balance_tol;
 }
 
 TPL void CP::set_cp_param(real_t dif_tol, int it_max, int verbose, real_t eps)
@@ -108,6 +152,15 @@ TPL void CP::set_cp_param(real_t dif_tol, int it_max, int verbose, real_t eps)
     this->eps = ZERO < dif_tol && dif_tol < eps ? dif_tol : eps;
 }
 
+TPL void CP::set_maxflow_param(Maxflow_engine maxflow_engine,
+    index_t auto_min_size, real_t auto_dense_degree, index_t gather_min_size)
+{
+    this->maxflow_engine = maxflow_engine;
+    maxflow_auto_min_size = auto_min_size;
+    maxflow_auto_dense_degree = auto_dense_degree;
+    maxflow_gather_min_size = gather_min_size;
+}
+
 TPL comp_t CP::get_components(comp_t** comp_assign, index_t** first_vertex,
     index_t** comp_list)
 {
@@ -132,11 +185,297 @@ TPL value_t* CP::get_reduced_values(){ return rX; }
 
 TPL void CP::set_reduced_values(value_t* rX){ this->rX = rX; }
 
+TPL void CP::add_vertices(index_t added_V, const index_t* first_edge,
+    const index_t* adj_vertices)
+{
+    if (first_edge[V] != E){
+        cerr << "Cut-pursuit: the forward-star structure of the extended "
+            "graph must coincide with the current one (first_edge[" << V
+            << "] = " << first_edge[V] << " given, " << E << " expected)."
+            << endl;
+        exit(EXIT_FAILURE);
+    }
+    const index_t new_V = V + added_V;
+    const index_t new_E = first_edge[new_V];
+
+    /**  extend the flow graph; new edges are not active  **/
+    G->reserve(new_V, new_E);
+    G->add_node(added_V);
+    for (index_t v = V; v < new_V; v++){
+        for (index_t e = first_edge[v]; e < first_edge[v + 1]; e++){
+            index_t w = adj_vertices[e - E];
+            if (w >= new_V){
+                cerr << "Cut-pursuit: new edge " << e << " ends at vertex "
+                    << w << ", but the extended graph has only " << new_V
+                    << " vertices." << endl;
+                exit(EXIT_FAILURE);
+            }
+            G->add_edge(v, w, ZERO, ZERO);
+        }
+    }
+
+    if (comp_assign){
+        comp_assign = (comp_t*) realloc_check(comp_assign,
+            sizeof(comp_t)*new_V);
+    }
+    if (comp_list){
+        comp_list = (index_t*) realloc_check(comp_list,
+            sizeof(index_t)*new_V);
+    }
+
+    if (first_vertex){ /**  components already computed  **/
+        /* edges with current vertices separate components; these
+         * components must be split again */
+        for (index_t v = V; v < new_V; v++){
+            for (index_t e = first_edge[v]; e < first_edge[v + 1]; e++){
+                index_t w = adj_vertex(e);
+                if (w < V){
+                    set_active(e);
+                    set_saturation(comp_assign[w], false);
+                }
+            }
+        }
+
+        /* new components are the connected components of the new vertices */
+        for (index_t v = V; v < new_V; v++){ comp_list[v] = v; }
+        index_t* first_local;
+        index_t local_num = compute_local_connected_components(rV, added_V,
+            comp_list + V, first_local);
+        if ((uintmax_t) rV + local_num > MAX_NUM_COMP){
+            cerr << "Cut-pursuit: number of components (" << (uintmax_t) rV
+                + local_num << ") greater than can be represented by comp_t ("
+                << MAX_NUM_COMP << ")" << endl;
+            exit(EXIT_FAILURE);
+        }
+        first_vertex = (index_t*) realloc_check(first_vertex,
+            sizeof(index_t)*(rVp1 + local_num));
+        for (index_t l = 0; l < local_num; l++){
+            comp_t rv = rV + l;
+            first_vertex[rv] = V + first_local[l];
+            for (index_t i = first_local[l]; i < first_local[l + 1]; i++){
+                comp_assign[comp_list[V + i]] = rv;
+            }
+            set_saturation(rv, false);
+        }
+        free(first_local);
+        rV += local_num;
+        first_vertex[rV] = new_V;
+
+        pending_update = true;
+    }else if (rV > 1){ /**  components given but not computed yet  **/
+        if (rV == MAX_NUM_COMP){
+            cerr << "Cut-pursuit: number of components greater than can be "
+                "represented by comp_t (" << MAX_NUM_COMP << ")" << endl;
+            exit(EXIT_FAILURE);
+        }
+        for (index_t v = V; v < new_V; v++){ comp_assign[v] = rV; }
+        rV++;
+    }
+
+    V = new_V;
+    E = new_E;
+    this->first_edge = first_edge;
+}
+
+TPL void CP::add_edges(const index_t* first_edge, const index_t* adj_vertices)
+{
+    for (index_t v = 0; v < V; v++){
+        if (first_edge[v + 1] - first_edge[v] <
+            this->first_edge[v + 1] - this->first_edge[v]){
+            cerr << "Cut-pursuit: the extended graph has less edges "
+                "originating from vertex " << v << " than the current one."
+                << endl;
+            exit(EXIT_FAILURE);
+        }
+    }
+    const index_t new_E = first_edge[V];
+    for (index_t v = 0; v < V; v++){
+        index_t first_new = first_edge[v] + this->first_edge[v + 1] -
+            this->first_edge[v];
+        for (index_t e = first_new; e < first_edge[v + 1]; e++){
+            if (adj_vertices[e] >= V){
+                cerr << "Cut-pursuit: new edge " << e << " ends at vertex "
+                    << adj_vertices[e] << ", but the graph has only " << V
+                    << " vertices." << endl;
+                exit(EXIT_FAILURE);
+            }
+        }
+    }
+
+    /**  renumber the edges in the flow graph; new edges are not active  **/
+    G->insert_edges(this->first_edge, first_edge, adj_vertices);
+
+    if (first_vertex){ /**  components already computed  **/
+        /* edges between components separate them; these components must be
+         * split again, and their values computed again */
+        for (index_t v = 0; v < V; v++){
+            index_t first_new = first_edge[v] + this->first_edge[v + 1] -
+                this->first_edge[v];
+            for (index_t e = first_new; e < first_edge[v + 1]; e++){
+                index_t w = adj_vertex(e);
+                if (comp_assign[v] != comp_assign[w]){
+                    set_active(e);
+                    set_saturation(comp_assign[v], false);
+                    set_saturation(comp_assign[w], false);
+                    pending_update = true;
+                }
+            }
+        }
+    }
+
+    E = new_E;
+    this->first_edge = first_edge;
+}
+
+TPL void CP::remove_edge(index_t e)
+{
+    index_t u = G->arcs[(size_t) 2*e + 1].head - G->nodes; // starting vertex
+    index_t w = adj_vertex(e);
+    if (!G->detach_edge(e)){ return; } // already removed
+    if (first_vertex){
+        set_saturation(comp_assign[u], false);
+        set_saturation(comp_assign[w], false);
+        pending_update = true;
+    }
+}
+
+TPL void CP::remove_edges(index_t num, const index_t* edges)
+{
+    for (index_t i = 0; i < num; i++){
+        if (edges[i] >= E){
+            cerr << "Cut-pursuit: cannot remove edge " << edges[i] << ", the "
+                "graph has only " << E << " edges." << endl;
+            exit(EXIT_FAILURE);
+        }
+        remove_edge(edges[i]);
+    }
+}
+
+TPL void CP::remove_vertices(index_t num, const index_t* vertices)
+{
+    if (!num){ return; }
+    for (index_t i = 0; i < num; i++){
+        index_t v = vertices[i];
+        if (v >= V){
+            cerr << "Cut-pursuit: cannot remove vertex " << v << ", the "
+                "graph has only " << V << " vertices." << endl;
+            exit(EXIT_FAILURE);
+        }
+        /* each removal detaches the first arc in the list of v */
+        while (G->nodes[v].first){
+            remove_edge((G->nodes[v].first - G->arcs)/2);
+        }
+    }
+
+    if (!first_vertex){ return; } // components not computed yet
+
+    /**  isolate the vertices in new components  **/
+    bool* is_removed = (bool*) malloc_check(sizeof(bool)*V);
+    for (index_t v = 0; v < V; v++){ is_removed[v] = false; }
+    for (index_t i = 0; i < num; i++){ is_removed[vertices[i]] = true; }
+
+    /* saturation is flagged on the first vertex of each component, which
+     * might change; components losing vertices are not saturated */
+    bool* saturation = (bool*) malloc_check(sizeof(bool)*rV);
+    for (comp_t rv = 0; rv < rV; rv++){ saturation[rv] = is_saturated(rv); }
+
+    /* remaining vertices are kept in order in each component list, the
+     * others are gathered in 'isolated' */
+    index_t* isolated = (index_t*) malloc_check(sizeof(index_t)*num);
+    index_t isolated_num = 0;
+    index_t i = 0, j = 0; // read and write positions in comp_list
+    for (comp_t rv = 0; rv < rV; rv++){
+        index_t comp_end = first_vertex[rv + 1];
+        index_t comp_isolated = isolated_num;
+        first_vertex[rv] = j;
+        for (; i < comp_end; i++){
+            index_t v = comp_list[i];
+            if (is_removed[v]){ isolated[isolated_num++] = v; }
+            else{ comp_list[j++] = v; }
+        }
+        if (isolated_num > comp_isolated){
+            saturation[rv] = false;
+            /* no other vertex left, the last one stays in the component */
+            if (j == first_vertex[rv]){
+                comp_list[j++] = isolated[--isolated_num];
+            }
+        }
+    }
+
+    if ((uintmax_t) rV + isolated_num > MAX_NUM_COMP){
+        cerr << "Cut-pursuit: number of components (" << (uintmax_t) rV
+            + isolated_num << ") greater than can be represented by comp_t ("
+            << MAX_NUM_COMP << ")" << endl;
+        exit(EXIT_FAILURE);
+    }
+    first_vertex = (index_t*) realloc_check(first_vertex,
+        sizeof(index_t)*(rVp1 + isolated_num));
+    for (index_t k = 0; k < isolated_num; k++){
+        comp_t rv = rV + k;
+        first_vertex[rv] = j;
+        comp_list[j++] = isolated[k];
+        comp_assign[isolated[k]] = rv;
+    }
+    first_vertex[rV + isolated_num] = V;
+    for (comp_t rv = 0; rv < rV; rv++){ set_saturation(rv, saturation[rv]); }
+    rV += isolated_num;
+    for (comp_t rv = rV - isolated_num; rv < rV; rv++){
+        set_saturation(rv, false);
+    }
+
+    free(is_removed);
+    free(saturation);
+    free(isolated);
+
+    pending_update = true;
+}
+
+TPL void CP::touch_vertices(index_t num, const index_t* vertices)
+{
+    if (!first_vertex){ return; } // components not computed yet
+    for (index_t i = 0; i < num; i++){
+        set_saturation(comp_assign[vertices[i]], false);
+    }
+    pending_update = true;
+}
+
+TPL index_t CP::list_unsaturated_vertices()
+{
+    index_t num = 0;
+    for (comp_t rv = 0; rv < rV; rv++){
+        if (is_saturated(rv)){ continue; }
+        for (index_t i = first_vertex[rv]; i < first_vertex[rv + 1]; i++){
+            set_tmp_comp_list(num++, comp_list[i]);
+        }
+    }
+    return num;
+}
+
+TPL void CP::update()
+{
+    /* removed edges might disconnect components; since splits only cut
+     * edges, the pieces must be separated here */
+    compute_connected_components();
+    /* previous reduced graph cannot be remapped */
+    last_rV = 0;
+    compute_reduced_graph();
+    free(rX);
+    rX = (value_t*) malloc_check(sizeof(value_t)*D*rV);
+    solve_reduced_problem();
+    /* no merge here: it would flag all components as not saturated, and the
+     * merge of the next iteration takes the updated problem into account */
+    saturation_count = 0;
+    for (comp_t rv = 0; rv < rV; rv++){
+        if (is_saturated(rv)){ saturation_count++; }
+    }
+    pending_update = false;
+}
+
 TPL int CP::cut_pursuit(bool init)
 {
     int it = 0;
     double timer = 0.0;
-    real_t dif = INF_REAL;
+    real_t dif = INF_REAL, gap = INF_REAL;
 
     chrono::steady_clock::time_point start;
     if (elapsed_time){ start = chrono::steady_clock::now(); }
@@ -144,12 +483,19 @@ TPL int CP::cut_pursuit(bool init)
         if (verbose){ cout << "Cut-pursuit initialization:" << endl; }
         initialize();
         if (objective_values){ objective_values[0] = compute_objective(); }
+    }else if (pending_update){
+        if (verbose){ cout << "Cut-pursuit update:" << endl; }
+        update();
+        if (objective_values){ objective_values[0] = compute_objective(); }
     }
+    if (gap_tol > ZERO){ gap = certify(); }
 
     while (true){
         if (elapsed_time){ elapsed_time[it] = timer = monitor_time(start); }
-        if (verbose){ print_progress(it, dif, timer); }
-        if (it == it_max || dif <= dif_tol){ break; }
+        if (verbose){ print_progress(it, dif, gap, timer); }
+        if (control){ report_progress(it); }
+        if (it == it_max || dif <= dif_tol || gap <= gap_tol ||
+            is_cancelled()){ break; }
 
         if (verbose){
             cout << "Cut-pursuit iteration " << it + 1 << " (max. " << it_max
@@ -157,14 +503,21 @@ TPL int CP::cut_pursuit(bool init)
         }
 
         if (verbose){ cout << "\tSplit... " << flush; }
+        first_split = it == 0;
         index_t activation = split();
+        first_split = false;
+        last_activation = activation;
         if (verbose){
             cout << activation << " new activated edge(s)." << endl;
         }
 
         if (!activation){ /* do not recompute reduced problem */
+            /* split interrupted, components are not all saturated */
+            if (is_cancelled()){ break; }
             saturation_count = rV;
-            if (dif_tol > ZERO || iterate_evolution){
+            /* with certificates, no cut means that the remaining gap is due
+             * to the reduced problem only, and iterating is useless */
+            if (dif_tol > ZERO || gap_tol > ZERO || iterate_evolution){
                 dif = ZERO;
                 if (iterate_evolution){ iterate_evolution[it] = dif; }
             }
@@ -185,10 +538,9 @@ TPL int CP::cut_pursuit(bool init)
                 last_rX = (value_t*) malloc_check(sizeof(value_t)*D*rV);
                 for (size_t i = 0; i < D*rV; i++){ last_rX[i] = rX[i]; }
             }
-            /* reduced graph and components will be updated */
+            /* components and reduced graph will be updated; the previous
+             * reduced graph is used for the latter */
             free(rX); rX = nullptr;
-            free(reduced_edges); reduced_edges = nullptr;
-            free(reduced_edge_weights); reduced_edge_weights = nullptr;
         }
 
         if (verbose){ cout << "\tCompute connected components... " << flush; }
@@ -204,7 +556,10 @@ TPL int CP::cut_pursuit(bool init)
 
         if (verbose){ cout << "\tSolve reduced problem: " << endl; }
         rX = (value_t*) malloc_check(sizeof(value_t)*D*rV);
+        exact_reduced = it + 1 == it_max;
+        approx_reduced = false;
         solve_reduced_problem();
+        exact_reduced = false;
 
         if (verbose){ cout << "\tMerge... " << flush; }
         index_t deactivation = merge();
@@ -218,11 +573,24 @@ TPL int CP::cut_pursuit(bool init)
             free(last_rX); last_rX = nullptr;
         }
 
+        if (gap_tol > ZERO){ gap = certify(); }
+
         it++;
 
         if (objective_values){ objective_values[it] = compute_objective(); }
     } /* endwhile true */
 
+    if (approx_reduced && !is_cancelled()){
+        if (verbose){
+            cout << "Cut-pursuit final accurate reduced problem: " << endl;
+        }
+        exact_reduced = true;
+        approx_reduced = false;
+        solve_reduced_problem();
+        exact_reduced = false;
+        if (objective_values){ objective_values[it] = compute_objective(); }
+    }
+
     return it;
 }
 
@@ -234,13 +602,26 @@ TPL double CP::monitor_time(chrono::steady_clock::time_point start)
                / static_cast<double>(steady_clock::period::den);
 }
 
-TPL void CP::print_progress(int it, real_t dif, double timer)
+TPL void CP::report_progress(int it)
+{
+    control->objective = objective_values ? objective_values[it] :
+        compute_objective();
+    control->components = rV;
+    control->iteration = it;
+}
+
+TPL void CP::print_progress(int it, real_t dif, real_t gap, double timer)
 {
     if (it && (dif_tol > ZERO || iterate_evolution)){
         cout.precision(2);
         cout << scientific << "\trelative iterate evolution " << dif
             << " (tol. " << dif_tol << ")\n";
     }
+    if (gap_tol > ZERO){
+        cout.precision(2);
+        cout << scientific << "\tduality gap " << gap << " (tol. "
+            << gap_tol << ")\n";
+    }
     cout << "\t" << rV << " connected component(s), " << saturation_count <<
         " saturated, and at most " << rE << " reduced edge(s).\n";
     if (timer > 0.0){
@@ -250,6 +631,8 @@ TPL void CP::print_progress(int it, real_t dif, double timer)
     cout << endl;
 }
 
+TPL real_t CP::certify(){ return INF_REAL; }
+
 TPL void CP::single_connected_component()
 {
     for (index_t v = 0; v < V; v++){ comp_assign[v] = 0; }
@@ -259,82 +642,110 @@ TPL void CP::single_connected_component()
     for (index_t v = 0; v < V; v++){ comp_list[v] = v; }
 }
 
-TPL void CP::new_arbitrary_connected_component(comp_t& rv, index_t& comp_size)
-{
-    if (rv == rV){
-        rV = (size_t) 2*rV < MAX_NUM_COMP ? (size_t) 2*rV : MAX_NUM_COMP;
-        first_vertex = (index_t*) realloc_check(first_vertex,
-            sizeof(index_t)*rVp1);
-    }
-    first_vertex[rv + 1] = first_vertex[rv] + comp_size;
-    set_saturation(rv, false);
-    rv++; comp_size = 0;
-    if (rv == MAX_NUM_COMP){
-        cerr << "Cut-pursuit: number of components greater than can be "
-            "represented by comp_t (" << MAX_NUM_COMP << ")." << endl;
-        exit(EXIT_FAILURE);
-    }
-}
-
 TPL void CP::arbitrary_connected_components()
 {
-    index_t max_comp_size = V/rV + 1;
-    free(first_vertex);
-    first_vertex = (index_t*) malloc_check(sizeof(index_t)*rVp1);
-
     /* cleanup assigned components */
     for (index_t v = 0; v < V; v++){ comp_assign[v] = NOT_ASSIGNED; }
 
-    index_t comp_size = 0;
-    comp_t rv = 0; // identify and count components
-    first_vertex[0] = 0;
-    index_t i = 0, j = 0; // indices in connected components list
+    if (rV > V){ rV = V; } // ensure distinct seeds
+    comp_t seed_num; // actual number of threads, set in parallel region
+    index_t max_comp_size;
+    /* number of components which grew at each round; the parity of rounds
+     * alternates the counters, so that one can be reset while the other is
+     * being read */
+    comp_t grown[2] = {1, 0};
+
+    #pragma omp parallel NUM_THREADS(E, rV, OMP_GRAPH)
+    {
+    const comp_t rv = omp_get_thread_num();
+    const comp_t num_thrds = omp_get_num_threads();
+    index_t max_size = (1.0 + balance_tol)*V/num_thrds + 1;
+    if (max_size > V){ max_size = V; }
+    #pragma omp single nowait
+    { seed_num = num_thrds; max_comp_size = max_size; }
+
+    /* the component is its own breadth-first search queue: vertices between
+     * 'i' and 'j' are the current frontier, the next one is put after 'j' */
+    index_t* queue = (index_t*) malloc_check(sizeof(index_t)*max_size);
+    index_t i = 0, j = 1;
+    queue[0] = (uintmax_t) V*rv/num_thrds; // spread seeds
+    comp_assign[queue[0]] = rv;
+    #pragma omp barrier
+
+    for (int round = 0; grown[round & 1]; round++){
+        /**  claim unassigned neighbors of the frontier; concurrent claims
+         **  of a same vertex might occur, the last one prevails  **/
+        index_t k = j;
+        for (; i < j; i++){
+            index_t v = queue[i];
+            for (arc* a = G->nodes[v].first; a && k < max_size; a = a->next){
+                index_t w = a->head - G->nodes;
+                comp_t rw;
+                #pragma omp atomic read
+                rw = comp_assign[w];
+                if (rw != NOT_ASSIGNED){ continue; }
+                #pragma omp atomic write
+                comp_assign[w] = rv;
+                queue[k++] = w;
+            }
+        }
+        if (rv == 0){ grown[(round + 1) & 1] = 0; }
+        #pragma omp barrier
+
+        /**  keep only successful claims, each vertex has a unique owner  **/
+        for (index_t l = j; l < k; l++){
+            if (comp_assign[queue[l]] == rv){ queue[j++] = queue[l]; }
+        }
+        if (i < j && j < max_size){
+            #pragma omp atomic
+            grown[(round + 1) & 1]++;
+        }
+        #pragma omp barrier
+    }
+
+    free(queue);
+    } // end parallel region
+
+    /**  group remaining vertices sequentially, searching only through
+     **  unassigned vertices; comp_list is used as queue  **/
+    index_t rVtmp = seed_num;
+    index_t i = 0, j = 0;
     for (index_t u = 0; u < V; u++){
         if (comp_assign[u] != NOT_ASSIGNED){ continue; }
-        /* new component starting at u */
+        if (rVtmp == MAX_NUM_COMP){
+            cerr << "Cut-pursuit: number of components greater than can be "
+                "represented by comp_t (" << MAX_NUM_COMP << ")." << endl;
+            exit(EXIT_FAILURE);
+        }
+        comp_t rv = rVtmp++;
+        index_t comp_size = 1;
         comp_assign[u] = rv;
-        comp_size++;
         comp_list[j++] = u;
         while (i < j){
             index_t v = comp_list[i++];
-            /* add neighbors to the connected component list */
             for (arc* a = G->nodes[v].first; a; a = a->next){
-                index_t w = a->head - G->nodes; // adjacent vertex
-                if (comp_assign[w] != NOT_ASSIGNED){
-                    if (comp_assign[w] != comp_assign[v]){ // might not be rv
-                        a->r_cap = a->sister->r_cap = ACTIVE_EDGE;
-                    }
-                    continue;
-                }
-                /* put in current connected component */
+                index_t w = a->head - G->nodes;
+                if (comp_assign[w] != NOT_ASSIGNED){ continue; }
                 comp_assign[w] = rv;
-                comp_size++;
                 comp_list[j++] = w;
-                if (comp_size == max_comp_size){ // change component
-                    new_arbitrary_connected_component(rv, comp_size);
-                }
+                if (++comp_size == max_comp_size){ i = j; break; }
             }
-        } // the current connected component cannot grow anymore
-        if (comp_size > 0){ // add the current component
-            new_arbitrary_connected_component(rv, comp_size);
         }
     }
-    /* update components lists and assignments */
-    if (rV > rv){
-        rV = rv;
-        first_vertex = (index_t*) realloc_check(first_vertex,
-            sizeof(index_t)*rVp1);
-    }
+
+    /* activate arcs between components, set components lists */
+    rV = rVtmp;
+    assign_connected_components();
 }
 
 TPL void CP::assign_connected_components()
 {
     /* activate arcs between components */
-    #pragma omp parallel for schedule(dynamic) NUM_THREADS(E, V)
+    #pragma omp parallel for schedule(dynamic) NUM_THREADS(E, V, OMP_GRAPH)
     for (index_t v = 0; v < V; v++){ /* will run along all edges */
         comp_t rv = comp_assign[v];
         for (index_t e = first_edge[v]; e < first_edge[v + 1]; e++){
-            if (rv != comp_assign[adj_vertices[e]]){ set_active(e); }
+            if (rv != comp_assign[adj_vertex(e)]){ set_active(e); }
         }
     }
 
@@ -360,11 +771,18 @@ TPL void CP::compute_connected_components()
     /* cleanup assigned components */
     for (index_t v = 0; v < V; v++){ comp_assign[v] = NOT_ASSIGNED; }
 
+    /* labels for processing large components with several threads, see
+     * get_task_num(); only possible if there are less components than
+     * threads */
+    index_t* label = rV < (uintmax_t) omp_get_max_threads() ?
+        (index_t*) malloc_check(sizeof(index_t)*V) : nullptr;
+
     comp_t saturation_par_count = 0; // auxiliary variable for parallel region
     index_t rVtmp = 0; // identify and count components, prevent overflow
     /* new connected components hierarchically derives from the previous ones,
      * we can thus compute them in parallel along previous components */
-    #pragma omp parallel for schedule(dynamic) NUM_THREADS(2*E, rV) \
+    #pragma omp parallel for schedule(dynamic) \
+        NUM_THREADS(2*E, V, OMP_GRAPH) \
         reduction(+:rVtmp, saturation_par_count)
     for (comp_t rv = 0; rv < rV; rv++){
         if (is_saturated(rv)){ // component stays the same
@@ -381,6 +799,12 @@ TPL void CP::compute_connected_components()
             rVtmp++;
             continue;
         }
+        index_t task_num = label ? get_task_num(first_vertex[rv + 1] -
+            first_vertex[rv], 2*E/V + 1) : 1;
+        if (task_num > 1){
+            rVtmp += label_connected_components(rv, task_num, label);
+            continue;
+        }
         index_t i, j, k;
         for (i = j = k = first_vertex[rv]; k < first_vertex[rv + 1]; k++){
             index_t u = comp_list[k];
@@ -405,6 +829,7 @@ TPL void CP::compute_connected_components()
         }
     }
     saturation_count = saturation_par_count;
+    free(label);
 
     if (rVtmp > MAX_NUM_COMP){
         cerr << "Cut-pursuit: number of components (" << rVtmp << ") greater "
@@ -430,9 +855,303 @@ TPL void CP::compute_connected_components()
     first_vertex[rV] = V;
 }
 
+TPL index_t CP::label_connected_components(comp_t rv, index_t task_num,
+    index_t* label)
+{
+    const index_t first = first_vertex[rv];
+    const index_t comp_size = first_vertex[rv + 1] - first;
+    const index_t* comp_vertices = comp_list + first;
+
+    /**  labels are positions in the component list; each label is the
+     **  position of a vertex of the same connected component, not greater
+     **  than the position of the labeled vertex; they can only decrease, and
+     **  the minimum over a connected component is thus a fixed point  **/
+    component_tasks(task_num, comp_size, [&](index_t i0, index_t i1)
+    { for (index_t i = i0; i < i1; i++){ label[comp_vertices[i]] = i; } });
+
+    /* lower the label of vertex v to l; concurrent updates might be lost,
+     * but a lost update is always detected again at the next round */
+    auto hook = [&](index_t v, index_t l)
+    {
+        index_t lv;
+        #pragma omp atomic read
+        lv = label[v];
+        if (l < lv){
+            #pragma omp atomic write
+            label[v] = l;
+        }
+    };
+
+    bool changed = true;
+    while (changed){
+        changed = false;
+
+        /**  hook labels across inactive edges, together with the vertex
+         **  represented by the greatest one  **/
+        component_tasks(task_num, comp_size, [&](index_t i0, index_t i1)
+        {
+            bool task_changed = false;
+            for (index_t i = i0; i < i1; i++){
+                index_t u = comp_vertices[i];
+                for (index_t e = first_edge[u]; e < first_edge[u + 1]; e++){
+                    if (is_active(e)){ continue; }
+                    index_t v = adj_vertex(e);
+                    index_t lu, lv;
+                    #pragma omp atomic read
+                    lu = label[u];
+                    #pragma omp atomic read
+                    lv = label[v];
+                    if (lu == lv){ continue; }
+                    if (lu < lv){
+                        hook(v, lu); hook(comp_vertices[lv], lu);
+                    }else{
+                        hook(u, lv); hook(comp_vertices[lu], lv);
+                    }
+                    task_changed = true;
+                }
+            }
+            if (task_changed){
+                #pragma omp atomic write
+                changed = true;
+            }
+        });
+
+        /**  pointer jumping  **/
+        component_tasks(task_num, comp_size, [&](index_t i0, index_t i1)
+        {
+            for (index_t i = i0; i < i1; i++){
+                index_t v = comp_vertices[i];
+                index_t l, ll;
+                #pragma omp atomic read
+                l = label[v];
+                while (true){
+                    #pragma omp atomic read
+                    ll = label[comp_vertices[l]];
+                    if (ll >= l){ break; }
+                    l = ll;
+                }
+                #pragma omp atomic write
+                label[v] = l;
+            }
+        });
+    }
+
+    /**  stable counting sort along the components; at this point each label
+     **  is the position of the first vertex of its connected component; this
+     **  is linear and memory friendly, thus kept sequential  **/
+    index_t* start = (index_t*) malloc_check(sizeof(index_t)*comp_size);
+    for (index_t i = 0; i < comp_size; i++){ start[i] = 0; }
+    for (index_t i = 0; i < comp_size; i++){ start[label[comp_vertices[i]]]++; }
+    index_t comp_num = 0, sum = 0;
+    for (index_t i = 0; i < comp_size; i++){
+        if (!start[i]){ continue; }
+        index_t count = start[i];
+        start[i] = sum;
+        sum += count;
+        comp_num++;
+    }
+    for (index_t i = 0; i < comp_size; i++){
+        index_t v = comp_vertices[i];
+        index_t l = label[v];
+        if (l == i){ // first vertex of a new component
+            comp_assign[v] = ASSIGNED_ROOT;
+            G->nodes[v].saturation = false;
+        }else{
+            comp_assign[v] = ASSIGNED;
+        }
+        set_tmp_comp_list(first + start[l]++, v);
+    }
+    free(start);
+
+    return comp_num;
+}
+
+TPL index_t CP::get_task_num(index_t item_num, uintmax_t ops_per_item)
+{
+    int team_size = omp_get_num_threads();
+    if ((uintmax_t) rV >= (uintmax_t) team_size){ return 1; }
+    return compute_num_threads(ops_per_item*item_num, team_size, OMP_GRAPH);
+}
+
+TPL void CP::compute_maxflow(Flow_graph* Gpar, index_t comp_size,
+    const index_t* comp_vertices, Maxflow_engine engine)
+{
+    if (comp_size <= ENUMERATION_MAX_SIZE){
+        enumerate_min_cut(comp_size, comp_vertices);
+        return;
+    }
+
+    bool gather = maxflow_gather_min_size &&
+        comp_size >= maxflow_gather_min_size;
+    if (gather){ /* gathering is useless if vertices are already close */
+        index_t min_v = comp_vertices[0], max_v = comp_vertices[0];
+        for (index_t i = 1; i < comp_size; i++){
+            if (comp_vertices[i] < min_v){ min_v = comp_vertices[i]; }
+            else if (comp_vertices[i] > max_v){ max_v = comp_vertices[i]; }
+        }
+        gather = (size_t) max_v - min_v >= (size_t) GATHER_MIN_SPREAD*comp_size;
+    }
+    if (!gather){
+        Gpar->maxflow(comp_size, comp_vertices, engine);
+        return;
+    }
+
+    /**  gather the component into a local flow graph  **/
+
+    /* local indices are stored in the timestamps of the main flow graph,
+     * which would be overwritten by a maximum flow computation anyway */
+    size_t comp_edges = 0;
+    for (index_t i = 0; i < comp_size; i++){
+        index_t v = comp_vertices[i];
+        G->nodes[v].TS = i;
+        for (index_t e = first_edge[v]; e < first_edge[v + 1]; e++){
+            /* removed edges loop on their starting vertex */
+            if (!is_active(e) && adj_vertex(e) != v){ comp_edges++; }
+        }
+    }
+
+    Flow_graph* Gloc = new Flow_graph(comp_size, comp_edges);
+    Gloc->add_node(comp_size);
+    /* vertices are processed in the order of the list and edges in
+     * forward-star order, so that arcs of each node are mostly consecutive */
+    for (index_t i = 0; i < comp_size; i++){
+        index_t v = comp_vertices[i];
+        Gloc->nodes[i].tr_cap = G->nodes[v].tr_cap;
+        for (index_t e = first_edge[v]; e < first_edge[v + 1]; e++){
+            if (is_active(e) || adj_vertex(e) == v){ continue; }
+            size_t a = (size_t) 2*e; // cast as size_t to avoid overflow
+            Gloc->add_edge(i, G->nodes[adj_vertex(e)].TS, G->arcs[a].r_cap,
+                G->arcs[a + 1].r_cap);
+        }
+    }
+
+    Gloc->maxflow(comp_size, nullptr, engine);
+
+    /**  scatter the cut back into the main flow graph  **/
+
+    /* any nonnull parent works for is_sink() */
+    for (index_t i = 0; i < comp_size; i++){
+        typename Flow_graph::node* n = G->nodes + comp_vertices[i];
+        if (Gloc->nodes[i].parent){
+            n->parent = G->terminal;
+            n->is_sink = Gloc->nodes[i].is_sink;
+        }else{
+            n->parent = nullptr;
+        }
+    }
+
+    delete Gloc;
+}
+
+TPL void CP::enumerate_min_cut(index_t comp_size,
+    const index_t* comp_vertices)
+{
+    typedef typename Flow_graph::node node;
+
+    /**  cost of each labeling, bit i set if i-th vertex is in the source  **/
+    const unsigned int label_num = 1 << comp_size;
+    flow_t cost[1 << ENUMERATION_MAX_SIZE];
+    for (unsigned int s = 0; s < label_num; s++){
+        cost[s] = 0.0;
+        for (index_t i = 0; i < comp_size; i++){
+            flow_t tr_cap = G->nodes[comp_vertices[i]].tr_cap;
+            if (s & (1 << i)){ /* in the source, cut arc node -> sink */
+                if (tr_cap < 0.0){ cost[s] -= tr_cap; }
+            }else{ /* in the sink, cut arc source -> node */
+                if (tr_cap > 0.0){ cost[s] += tr_cap; }
+            }
+        }
+    }
+    for (index_t i = 0; i < comp_size; i++){
+        index_t u = comp_vertices[i];
+        for (index_t e = first_edge[u]; e < first_edge[u + 1]; e++){
+            if (is_active(e)){ continue; }
+            index_t j = 0; // local index of the adjacent vertex
+            while (comp_vertices[j] != adj_vertex(e)){ j++; }
+            size_t a = (size_t) 2*e; // cast as size_t to avoid overflow
+            for (unsigned int s = 0; s < label_num; s++){
+                bool i_src = s & (1 << i), j_src = s & (1 << j);
+                if (i_src && !j_src){ cost[s] += G->arcs[a].r_cap; }
+                else if (j_src && !i_src){ cost[s] += G->arcs[a + 1].r_cap; }
+            }
+        }
+    }
+
+    /**  the cut found by maximum flow algorithms has the smallest source
+     **  side, which is the intersection of all min cut source sides  **/
+    unsigned int best = 0;
+    index_t best_src_num = 0;
+    for (unsigned int s = 1; s < label_num; s++){
+        index_t src_num = 0;
+        for (index_t i = 0; i < comp_size; i++){
+            if (s & (1 << i)){ src_num++; }
+        }
+        if (cost[s] < cost[best] ||
+            (cost[s] == cost[best] && src_num < best_src_num)){
+            best = s;
+            best_src_num = src_num;
+        }
+    }
+
+    /* flag in the main flow graph, any nonnull parent works for is_sink() */
+    for (index_t i = 0; i < comp_size; i++){
+        node* n = G->nodes + comp_vertices[i];
+        n->parent = G->terminal;
+        n->is_sink = !(best & (1 << i));
+    }
+}
+
+TPL index_t CP::compute_local_connected_components(comp_t rv,
+    index_t comp_size, index_t* comp_vertices, index_t*& first_local)
+{
+    index_t* local_list = (index_t*) malloc_check(sizeof(index_t)*comp_size);
+    first_local = (index_t*) malloc_check(sizeof(index_t)*(comp_size + 1));
+
+    /* cleanup assigned components */
+    for (index_t i = 0; i < comp_size; i++){
+        comp_assign[comp_vertices[i]] = NOT_ASSIGNED;
+    }
+
+    index_t local_count = 0;
+    index_t i, j, k;
+    for (i = j = k = 0; k < comp_size; k++){
+        index_t u = comp_vertices[k];
+        if (comp_assign[u] != NOT_ASSIGNED){ continue; }
+        comp_assign[u] = rv;
+        first_local[local_count++] = j;
+        local_list[j++] = u;
+        while (i < j){
+            index_t v = local_list[i++];
+            /* add neighbors to the connected component list */
+            for (arc* a = G->nodes[v].first; a; a = a->next){
+                if (a->r_cap != ACTIVE_EDGE){
+                    index_t w = a->head - G->nodes; // adjacent vertex
+                    if (comp_assign[w] != NOT_ASSIGNED){ continue; }
+                    comp_assign[w] = rv;
+                    local_list[j++] = w;
+                }
+            }
+        } /* the current connected component is complete */
+    }
+    first_local[local_count] = comp_size;
+
+    for (i = 0; i < comp_size; i++){ comp_vertices[i] = local_list[i]; }
+    free(local_list);
+    first_local = (index_t*) realloc_check(first_local,
+        sizeof(index_t)*(local_count + 1));
+
+    return local_count;
+}
+
 TPL void CP::compute_reduced_graph()
 /* this could actually be parallelized, but is it worth the pain? */
 {
+    if (rV > 1 && last_rV && saturation_count && reduced_edges &&
+        reduced_edge_weights){
+        update_reduced_graph();
+        return;
+    }
+
     free(reduced_edges);
     free(reduced_edge_weights);
 
@@ -521,6 +1240,137 @@ TPL void CP::compute_reduced_graph()
     }
 }
 
+TPL void CP::update_reduced_graph()
+{
+    /**  map the previous components which are unchanged  **/
+    comp_t* last_comp_map = (comp_t*) malloc_check(sizeof(comp_t)*last_rV);
+    for (comp_t last_rv = 0; last_rv < last_rV; last_rv++){
+        last_comp_map[last_rv] = NOT_ASSIGNED;
+    }
+    for (comp_t rv = 0; rv < rV; rv++){
+        if (is_saturated(rv)){
+            last_comp_map[get_tmp_comp_assign(comp_list[first_vertex[rv]])] =
+                rv;
+        }
+    }
+
+    /**  gather edges, lowest component first; might contain duplicates  **/
+    size_t rEtmp = rE > rV ? rE : rV; // temporary buffer size
+    comp_t* tmp_edges = (comp_t*) malloc_check(sizeof(comp_t)*2*rEtmp);
+    real_t* tmp_weights = (real_t*) malloc_check(sizeof(real_t)*rEtmp);
+    bool* isolated = (bool*) malloc_check(sizeof(bool)*rV);
+    for (comp_t rv = 0; rv < rV; rv++){ isolated[rv] = true; }
+    size_t tmp_rE = 0;
+
+    auto add_edge = [&](comp_t ru, comp_t rv, real_t weight){
+        if (tmp_rE == rEtmp){ // reach buffer size
+            rEtmp += rEtmp;
+            tmp_edges = (comp_t*) realloc_check(tmp_edges,
+                sizeof(comp_t)*2*rEtmp);
+            tmp_weights = (real_t*) realloc_check(tmp_weights,
+                sizeof(real_t)*rEtmp);
+        }
+        if (ru > rv){ comp_t tmp = ru; ru = rv; rv = tmp; }
+        tmp_edges[2*tmp_rE] = ru;
+        tmp_edges[2*tmp_rE + 1] = rv;
+        tmp_weights[tmp_rE++] = weight;
+        isolated[ru] = isolated[rv] = false;
+    };
+
+    /* reduced edges between unchanged components; the previous reduced graph
+     * contains no edge with zero weight, but might contain isolated
+     * components linked to themselves, which are discarded */
+    for (size_t re = 0; re < rE; re++){
+        comp_t ru = last_comp_map[reduced_edges[2*re]];
+        comp_t rv = last_comp_map[reduced_edges[2*re + 1]];
+        if (ru == NOT_ASSIGNED || rv == NOT_ASSIGNED || ru == rv){ continue; }
+        add_edge(ru, rv, reduced_edge_weights[re]);
+    }
+    free(last_comp_map);
+    free(reduced_edges);
+    free(reduced_edge_weights);
+
+    /* edges involving a new component, scanned along its vertices */
+    for (comp_t ru = 0; ru < rV; ru++){
+        if (is_saturated(ru)){ continue; }
+        for (index_t i = first_vertex[ru]; i < first_vertex[ru + 1]; i++){
+            index_t u = comp_list[i];
+            for (arc* a = G->nodes[u].first; a; a = a->next){
+                if (a->r_cap != ACTIVE_EDGE){ continue; }
+                index_t e = (a - G->arcs)/2; // index in undirected edge list
+                if (EDGE_WEIGHTS_(e) == ZERO){ continue; }
+                index_t v = a->head - G->nodes; // adjacent vertex
+                comp_t rv = comp_assign[v];
+                /* edges between new components are counted once */
+                if (rv < ru && !is_saturated(rv)){ continue; }
+                add_edge(ru, rv, EDGE_WEIGHTS_(e));
+            }
+        }
+    }
+
+    /**  sort edges by lowest component  **/
+    size_t* first_tmp_edge = (size_t*) malloc_check(sizeof(size_t)*rVp1);
+    for (comp_t rv = 0; rv < rVp1; rv++){ first_tmp_edge[rv] = 0; }
+    for (size_t re = 0; re < tmp_rE; re++){
+        first_tmp_edge[tmp_edges[2*re] + 1]++;
+    }
+    for (comp_t rv = 1; rv < rV; rv++){
+        first_tmp_edge[rv + 1] += first_tmp_edge[rv];
+    }
+    size_t* tmp_edge_list = (size_t*) malloc_check(sizeof(size_t)*tmp_rE);
+    for (size_t re = 0; re < tmp_rE; re++){
+        tmp_edge_list[first_tmp_edge[tmp_edges[2*re]]++] = re;
+    }
+    for (comp_t rv = rV; rv > 0; rv--){
+        first_tmp_edge[rv] = first_tmp_edge[rv - 1];
+    }
+    first_tmp_edge[0] = 0;
+
+    /**  sum up duplicates, and link isolated components to themselves, as
+     **  in compute_reduced_graph()  **/
+    index_t* reduced_edge_to = (index_t*) malloc_check(sizeof(index_t)*rV);
+    for (comp_t rv = 0; rv < rV; rv++){ reduced_edge_to[rv] = NO_EDGE; }
+    rEtmp = tmp_rE + rV; // upper bound
+    reduced_edges = (comp_t*) malloc_check(sizeof(comp_t)*2*rEtmp);
+    reduced_edge_weights = (real_t*) malloc_check(sizeof(real_t)*rEtmp);
+    rE = 0;
+    for (comp_t ru = 0; ru < rV; ru++){
+        if (isolated[ru]){
+            reduced_edges[2*rE] = reduced_edges[2*rE + 1] = ru;
+            reduced_edge_weights[rE++] = eps;
+            continue;
+        }
+        size_t first_rE = rE;
+        for (size_t i = first_tmp_edge[ru]; i < first_tmp_edge[ru + 1]; i++){
+            size_t re = tmp_edge_list[i];
+            comp_t rv = tmp_edges[2*re + 1];
+            if (reduced_edge_to[rv] == NO_EDGE){ // a new edge must be created
+                reduced_edges[2*rE] = ru;
+                reduced_edges[2*rE + 1] = rv;
+                reduced_edge_weights[rE] = tmp_weights[re];
+                reduced_edge_to[rv] = rE++;
+            }else{ /* edge already exists */
+                reduced_edge_weights[reduced_edge_to[rv]] += tmp_weights[re];
+            }
+        }
+        for (size_t re = first_rE; re < rE; re++){ /* reset reduced_edge_to */
+            reduced_edge_to[reduced_edges[2*re + 1]] = NO_EDGE;
+        }
+    }
+
+    free(reduced_edge_to);
+    free(first_tmp_edge);
+    free(tmp_edge_list);
+    free(isolated);
+    free(tmp_edges);
+    free(tmp_weights);
+
+    reduced_edges = (comp_t*) realloc_check(reduced_edges,
+        sizeof(comp_t)*2*rE);
+    reduced_edge_weights = (real_t*) realloc_check(reduced_edge_weights,
+        sizeof(real_t)*rE);
+}
+
 TPL void CP::initialize()
 {
     free(rX); 
@@ -545,6 +1395,7 @@ TPL void CP::initialize()
     last_rV = 0;
     for (comp_t rv = 0; rv < rV; rv++){ set_saturation(rv, false); }
     saturation_count = 0;
+    pending_update = false;
 
     compute_reduced_graph();
     rX = (value_t*) malloc_check(sizeof(value_t)*D*rV);
@@ -715,11 +1566,11 @@ TPL index_t CP::merge()
 
     /* deactivate corresponding edges */
     index_t deactivation = 0;
-    #pragma omp parallel for schedule(dynamic) NUM_THREADS(E, V)
+    #pragma omp parallel for schedule(dynamic) NUM_THREADS(E, V, OMP_GRAPH)
     for (index_t v = 0; v < V; v++){ /* will run along all edges */
         comp_t rv = comp_assign[v];
         for (index_t e = first_edge[v]; e < first_edge[v + 1]; e++){
-            if (is_active(e) && rv == comp_assign[adj_vertices[e]]){
+            if (is_active(e) && rv == comp_assign[adj_vertex(e)]){
                 set_inactive(e);
                 deactivation++;
             }
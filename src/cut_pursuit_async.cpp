@@ -0,0 +1,67 @@
+/*=============================================================================
+ * Asynchronous run of cut-pursuit, with progress and cancellation
+ *===========================================================================*/
+#include "../include/cut_pursuit_async.hpp"
+
+#define TPL template <typename real_t, typename index_t, typename comp_t, \
+    typename value_t>
+#define CP_ASYNC Cp_async<real_t, index_t, comp_t, value_t>
+
+using namespace std;
+
+TPL CP_ASYNC::Cp_async(Cp<real_t, index_t, comp_t, value_t>& cp, bool init)
+    : cp(cp)
+{
+    cp.set_control(&control);
+    run = async(launch::async, [&cp, init](){ return cp.cut_pursuit(init); });
+}
+
+TPL CP_ASYNC::~Cp_async()
+{
+    if (run.valid()){
+        cancel();
+        run.wait();
+    }
+    cp.set_control(nullptr);
+}
+
+TPL void CP_ASYNC::cancel(){ control.cancel = true; }
+
+TPL bool CP_ASYNC::is_cancelled() const { return control.cancel; }
+
+TPL bool CP_ASYNC::is_done() const { return wait_for(0.0); }
+
+TPL bool CP_ASYNC::wait_for(double timeout) const
+{
+    if (!run.valid()){ return true; } // wait() already returned
+    if (timeout <= 0.0){
+        return run.wait_for(chrono::seconds(0)) == future_status::ready;
+    }
+    return run.wait_for(chrono::duration<double>(timeout)) ==
+        future_status::ready;
+}
+
+TPL int CP_ASYNC::wait()
+{
+    if (!run.valid()){
+        cerr << "Cut-pursuit asynchronous run: the result has already been "
+            "retrieved." << endl;
+        exit(EXIT_FAILURE);
+    }
+    return run.get();
+}
+
+TPL Cp_progress CP_ASYNC::get_progress() const
+{
+    Cp_progress progress;
+    progress.iteration = control.iteration;
+    progress.components = control.components;
+    progress.objective = control.objective;
+    return progress;
+}
+
+/* instantiate for compilation */
+template class Cp_async<float, uint32_t, uint16_t>;
+template class Cp_async<double, uint32_t, uint16_t>;
+template class Cp_async<float, uint32_t, uint32_t>;
+template class Cp_async<double, uint32_t, uint32_t>;
@@ -7,7 +7,8 @@
 #define ZERO ((real_t) 0.0)
 #define ONE ((real_t) 1.0)
 #define TWO ((real_t) 2.0)
-#define EDGE_WEIGHTS_(e) (edge_weights ? edge_weights[(e)] : homo_edge_weight)
+#define EDGE_WEIGHTS_(e) (edge_weights ? edge_weights[(e)] : \
+    quantized_edge_weights ? quantized_edge_weights[(e)] : homo_edge_weight)
 /* special flag */
 #define MERGE_INIT MAX_NUM_COMP
 
@@ -18,15 +19,19 @@
 using namespace std;
 
 TPL CP_D0::Cp_d0(index_t V, index_t E, const index_t* first_edge,
-    const index_t* adj_vertices, size_t D) :
+    Adj_vertices<index_t> adj_vertices, size_t D) :
     Cp<real_t, index_t, comp_t>(V, E, first_edge, adj_vertices, D),
     no_merge_info(&reserved_merge_info)
 {
     K = 2;
     split_iter_num = 2;
+    recursive_split = false;
+    standard_refine = true;
+    matching_merge = false;
 }
 
-TPL void CP_D0::set_split_param(int K, int split_iter_num)
+TPL void CP_D0::set_split_param(int K, int split_iter_num,
+    bool recursive_split, bool standard_refine)
 {
     if (split_iter_num < 1){
         cerr << "Cut-pursuit d0: there must be at least one iteration in the "
@@ -43,8 +48,16 @@ TPL void CP_D0::set_split_param(int K, int split_iter_num)
             " of alternative values in the split K (" << K << ")." << endl;
         exit(EXIT_FAILURE);
     }
+
+    this->K = K;
+    this->split_iter_num = split_iter_num;
+    this->recursive_split = recursive_split;
+    this->standard_refine = standard_refine;
 }
 
+TPL void CP_D0::set_merge_param(bool matching_merge)
+{ this->matching_merge = matching_merge; }
+
 TPL real_t CP_D0::compute_graph_d0()
 {
     real_t weighted_contour_length = ZERO;
@@ -73,167 +86,274 @@ TPL real_t CP_D0::compute_f()
 TPL real_t CP_D0::compute_objective()
 { return compute_f() + compute_graph_d0(); } // f(x) + ||x||_d0 }
 
-TPL index_t CP_D0::split()
+TPL real_t CP_D0::compute_split_objective(index_t task_num,
+    index_t comp_size, const index_t* comp_vertices, const value_t* altX,
+    const comp_t* label_assign)
+{
+    real_t objective = ZERO;
+    component_tasks(task_num, comp_size, [&](index_t first, index_t last)
+    {
+    real_t task_objective = ZERO;
+    for (index_t i = first; i < last; i++){
+        index_t v = comp_vertices[i];
+        comp_t l = label_assign[v];
+        task_objective += fv(v, altX + D*l);
+        /* inactive edges stay within the component */
+        for (index_t e = first_edge[v]; e < first_edge[v + 1]; e++){
+            if (!is_active(e) && label_assign[adj_vertex(e)] != l){
+                task_objective += EDGE_WEIGHTS_(e);
+            }
+        }
+    }
+    #pragma omp atomic
+    objective += task_objective;
+    });
+    return objective;
+}
+
+TPL index_t CP_D0::split_component(comp_t rv, index_t comp_size,
+    const index_t* comp_vertices, Flow_graph* Gpar, value_t* altX,
+    bool check_gain)
 {
     index_t activation = 0;
 
     /* best alternative label stored temporarily in array 'comp_assign' */
     comp_t* label_assign = comp_assign;
 
-    /**  refine components in parallel  **/
-    #pragma omp parallel NUM_THREADS((K - 1)*(2*D*V + 5*E), rV)
-    {
+    Maxflow_engine engine = get_maxflow_engine(comp_size, comp_vertices);
+    /* rough estimate assuming a couple of edges per vertex */
+    const index_t task_num = get_task_num(comp_size, 2*D + 10);
+
+    /* objective with the best single value over the component */
+    real_t single_objective = ZERO;
+    if (check_gain){
+        component_tasks(task_num, comp_size, [&](index_t first, index_t last)
+        {
+        for (index_t i = first; i < last; i++){
+            label_assign[comp_vertices[i]] = 0;
+        }
+        });
+        update_split_values(comp_size, comp_vertices, altX, label_assign);
+        single_objective = compute_split_objective(task_num, comp_size,
+            comp_vertices, altX, label_assign);
+    }
 
-    Cp_graph<real_t, index_t, comp_t>* Gpar = get_parallel_flow_graph();
-    value_t* altX = (value_t*) malloc_check(sizeof(value_t)*D*K);
+    for (int split_it = 0; split_it < split_iter_num; split_it++){
 
-    #pragma omp for schedule(dynamic) reduction(+:activation)
-    for (comp_t rv = 0; rv < rV; rv++){
-        if (is_saturated(rv)){ continue; }
-        index_t rv_activation = 0;
+        if (split_it == 0){
+            init_split_values(comp_size, comp_vertices, altX, label_assign);
+        }else{
+            update_split_values(comp_size, comp_vertices, altX, label_assign);
+        }
 
-        for (int split_it = 0; split_it < split_iter_num; split_it++){
-
-            if (split_it == 0){ init_split_values(rv, altX, label_assign); }
-            else{ update_split_values(rv, altX, label_assign); }
-    
-            bool no_reassignment = true;
-
-            if (K == 2){ /* one graph cut is enough */
-                for (index_t i = first_vertex[rv]; i < first_vertex[rv + 1];
-                    i++){
-                    index_t v = comp_list[i];
-                    /* unary cost for chosing the second alternative */
-                    set_term_capacities(v, fv(v, altX + D) - fv(v, altX));
-                }
+        bool no_reassignment = true;
 
+        if (K == 2){ /* one graph cut is enough */
+            component_tasks(task_num, comp_size,
+                [&](index_t first, index_t last)
+            {
+            for (index_t i = first; i < last; i++){
+                index_t v = comp_vertices[i];
+                /* unary cost for chosing the second alternative */
+                set_term_capacities(v, fv(v, altX + D) - fv(v, altX));
                 /* set d1 edge capacities within each component */
-                for (index_t i = first_vertex[rv]; i < first_vertex[rv + 1];
-                    i++){
-                    index_t v = comp_list[i];
-                    for (index_t e = first_edge[v]; e < first_edge[v + 1];
-                        e++){
-                        if (!is_active(e)){
-                            set_edge_capacities(e, EDGE_WEIGHTS_(e),
-                                EDGE_WEIGHTS_(e));
-                        }
+                for (index_t e = first_edge[v]; e < first_edge[v + 1]; e++){
+                    if (!is_active(e)){
+                        set_edge_capacities(e, EDGE_WEIGHTS_(e),
+                            EDGE_WEIGHTS_(e));
                     }
                 }
-
-                /* find min cut and set assignment accordingly */
-                Gpar->maxflow(first_vertex[rv + 1] - first_vertex[rv],
-                    comp_list + first_vertex[rv]);
-
-                for (index_t i = first_vertex[rv]; i < first_vertex[rv + 1];
-                    i++){
-                    index_t v = comp_list[i];
-                    if (is_sink(v) != label_assign[v]){
-                        label_assign[v] = is_sink(v);
-                        no_reassignment = false;
-                    }
+            }
+            });
+
+            /* find min cut and set assignment accordingly */
+            compute_maxflow(Gpar, comp_size, comp_vertices, engine);
+
+            component_tasks(task_num, comp_size,
+                [&](index_t first, index_t last)
+            {
+            bool task_reassignment = false;
+            for (index_t i = first; i < last; i++){
+                index_t v = comp_vertices[i];
+                if (is_sink(v) != label_assign[v]){
+                    label_assign[v] = is_sink(v);
+                    task_reassignment = true;
                 }
+            }
+            if (task_reassignment){
+                #pragma omp atomic write
+                no_reassignment = false;
+            }
+            });
 
-            }else{ /* iterate over all K alternative values */
-                for (comp_t k = 0; k < K; k++){
-        
-                /* check if alternative k has still vertices assigned to it */
-                if (!is_split_value(altX[D*k])){ continue; }
-
-                /* set the source/sink capacities */
-                bool all_assigned_k = true;
-                for (index_t i = first_vertex[rv]; i < first_vertex[rv + 1];
-                    i++){
-                    index_t v = comp_list[i];
-                    comp_t l = label_assign[v];
-                    /* unary cost for changing current value to k-th value */
-                    if (l == k){
-                        set_term_capacities(v, ZERO);
-                    }else{
-                        set_term_capacities(v, fv(v, altX + D*k) -
-                            fv(v, altX + D*l));
-                        all_assigned_k = false;
-                    }
+        }else{ /* iterate over all K alternative values */
+            for (comp_t k = 0; k < K; k++){
+    
+            /* check if alternative k has still vertices assigned to it */
+            if (!is_split_value(altX[D*k])){ continue; }
+
+            /* set the source/sink capacities */
+            bool all_assigned_k = true;
+            component_tasks(task_num, comp_size,
+                [&](index_t first, index_t last)
+            {
+            bool task_all_assigned_k = true;
+            for (index_t i = first; i < last; i++){
+                index_t v = comp_vertices[i];
+                comp_t l = label_assign[v];
+                /* unary cost for changing current value to k-th value */
+                if (l == k){
+                    set_term_capacities(v, ZERO);
+                }else{
+                    set_term_capacities(v, fv(v, altX + D*k) -
+                        fv(v, altX + D*l));
+                    task_all_assigned_k = false;
                 }
-                if (all_assigned_k){ continue; }
-
-                /* set d1 edge capacities within each component */
-                for (index_t i = first_vertex[rv]; i < first_vertex[rv + 1];
-                    i++){
-                    index_t u = comp_list[i];
-                    comp_t lu = label_assign[u];
-                    for (index_t e = first_edge[u]; e < first_edge[u + 1];
-                        e++){
-                        if (is_active(e)){ continue; }
-                        index_t v = adj_vertices[e];
-                        comp_t lv = label_assign[v];
-                    /* horizontal and source/sink capacities are modified 
-                     * according to Kolmogorov & Zabih (2004); in their
-                     * notations, functional E(u,v) is decomposed as
-                     *
-                     * E(0,0) | E(0,1)    A | B
-                     * --------------- = -------
-                     * E(1,0) | E(1,1)    C | D
-                     *                         0 | 0      0 | D-C    0 |B+C-A-D
-                     *                 = A + --------- + -------- + -----------
-                     *                       C-A | C-A    0 | D-C    0 |   0
-                     *
-                     *            constant +      unary terms     + binary term
-                     */
-                        /* A = E(0,0) is the cost of the current assignment */
-                        real_t A = lu == lv ? ZERO : EDGE_WEIGHTS_(e);
-                        /* B = E(0,1) is the cost of changing lv to k */
-                        real_t B = lu == k ? ZERO : EDGE_WEIGHTS_(e);
-                        /* C = E(1,0) is the cost of changing lu to k */
-                        real_t C = lv == k ? ZERO : EDGE_WEIGHTS_(e);
-                        /* D = E(1,1) = 0 is for changing both lu, lv to k */
-                        /* set weights in accordance with orientation u -> v */
-                        add_term_capacities(u, C - A);
-                        add_term_capacities(v, -C);
-                        set_edge_capacities(e, B + C - A, ZERO);
-                    }
+            }
+            if (!task_all_assigned_k){
+                #pragma omp atomic write
+                all_assigned_k = false;
+            }
+            });
+            if (all_assigned_k){ continue; }
+
+            /* set d1 edge capacities within each component; capacities of
+             * both ends of each edge are modified, so this is not split into
+             * concurrent tasks */
+            for (index_t i = 0; i < comp_size; i++){
+                index_t u = comp_vertices[i];
+                comp_t lu = label_assign[u];
+                for (index_t e = first_edge[u]; e < first_edge[u + 1]; e++){
+                    if (is_active(e)){ continue; }
+                    index_t v = adj_vertex(e);
+                    comp_t lv = label_assign[v];
+                /* horizontal and source/sink capacities are modified 
+                 * according to Kolmogorov & Zabih (2004); in their
+                 * notations, functional E(u,v) is decomposed as
+                 *
+                 * E(0,0) | E(0,1)    A | B
+                 * --------------- = -------
+                 * E(1,0) | E(1,1)    C | D
+                 *                         0 | 0      0 | D-C    0 |B+C-A-D
+                 *                 = A + --------- + -------- + -----------
+                 *                       C-A | C-A    0 | D-C    0 |   0
+                 *
+                 *            constant +      unary terms     + binary term
+                 */
+                    /* A = E(0,0) is the cost of the current assignment */
+                    real_t A = lu == lv ? ZERO : EDGE_WEIGHTS_(e);
+                    /* B = E(0,1) is the cost of changing lv to k */
+                    real_t B = lu == k ? ZERO : EDGE_WEIGHTS_(e);
+                    /* C = E(1,0) is the cost of changing lu to k */
+                    real_t C = lv == k ? ZERO : EDGE_WEIGHTS_(e);
+                    /* D = E(1,1) = 0 is for changing both lu, lv to k */
+                    /* set weights in accordance with orientation u -> v */
+                    add_term_capacities(u, C - A);
+                    add_term_capacities(v, -C);
+                    set_edge_capacities(e, B + C - A, ZERO);
                 }
+            }
 
-                /* find min cut and update assignment accordingly */
-                Gpar->maxflow(first_vertex[rv + 1] - first_vertex[rv],
-                    comp_list + first_vertex[rv]);
-
-                for (index_t i = first_vertex[rv]; i < first_vertex[rv + 1];
-                    i++){
-                    index_t v = comp_list[i];
-                    if (is_sink(v) && label_assign[v] != k){
-                        label_assign[v] = k;
-                        no_reassignment = false;
-                    }
+            /* find min cut and update assignment accordingly */
+            compute_maxflow(Gpar, comp_size, comp_vertices, engine);
+
+            component_tasks(task_num, comp_size,
+                [&](index_t first, index_t last)
+            {
+            bool task_reassignment = false;
+            for (index_t i = first; i < last; i++){
+                index_t v = comp_vertices[i];
+                if (is_sink(v) && label_assign[v] != k){
+                    label_assign[v] = k;
+                    task_reassignment = true;
                 }
+            }
+            if (task_reassignment){
+                #pragma omp atomic write
+                no_reassignment = false;
+            }
+            });
+
+            } // end for k
+        } // end if K == 2
+
+        if (no_reassignment){ break; }
+
+    } // end for split_it
+
+    /* discard the split if it does not decrease the objective, with the
+     * best values for the resulting labels */
+    if (check_gain){
+        update_split_values(comp_size, comp_vertices, altX, label_assign);
+        if (!(compute_split_objective(task_num, comp_size, comp_vertices,
+            altX, label_assign) < single_objective)){
+            component_tasks(task_num, comp_size,
+                [&](index_t first, index_t last)
+            {
+            for (index_t i = first; i < last; i++){
+                label_assign[comp_vertices[i]] = 0;
+            }
+            });
+        }
+    }
 
-                } // end for k
-            } // end if K == 2
-
-            if (no_reassignment){ break; }
-    
-        } // end for split_it
-
-        /* activate edges correspondingly */
-        for (index_t i = first_vertex[rv]; i < first_vertex[rv + 1]; i++){
-            index_t v = comp_list[i];
-            for (index_t e = first_edge[v]; e < first_edge[v + 1]; e++){
-                if (!is_active(e) &&
-                    label_assign[v] != label_assign[adj_vertices[e]]){
-                    set_active(e);
-                    rv_activation++;
-                }
+    /* activate edges correspondingly */
+    component_tasks(task_num, comp_size, [&](index_t first, index_t last)
+    {
+    index_t task_activation = 0;
+    for (index_t i = first; i < last; i++){
+        index_t v = comp_vertices[i];
+        for (index_t e = first_edge[v]; e < first_edge[v + 1]; e++){
+            if (!is_active(e) &&
+                label_assign[v] != label_assign[adj_vertex(e)]){
+                set_active(e);
+                task_activation++;
             }
         }
+    }
+    #pragma omp atomic
+    activation += task_activation;
+    });
 
-        set_saturation(rv, rv_activation == 0);
-        activation += rv_activation;
+    /* reconstruct comp_assign */
+    component_tasks(task_num, comp_size, [&](index_t first, index_t last)
+    {
+    for (index_t i = first; i < last; i++){
+        comp_assign[comp_vertices[i]] = rv;
+    }
+    });
 
-        /* reconstruct comp_assign */
-        for (index_t i = first_vertex[rv]; i < first_vertex[rv + 1]; i++){
-            comp_assign[comp_list[i]] = rv;
-        }
+    return activation;
+}
+
+TPL index_t CP_D0::split()
+{
+    if (recursive_split && (first_split || !standard_refine)){
+        return split_recursively();
+    }
+
+    index_t activation = 0;
+
+    /**  refine components in parallel; if there are less components than
+     **  threads, the remaining threads help within large components, see
+     **  Cp::get_task_num()  **/
+    #pragma omp parallel NUM_THREADS((K - 1)*(2*D*V + 5*E), V, OMP_GRAPH)
+    {
+
+    Flow_graph* Gpar = get_parallel_flow_graph();
+    value_t* altX = (value_t*) malloc_check(sizeof(value_t)*D*K);
 
-    } // end for rv
+    #pragma omp for schedule(dynamic) reduction(+:activation)
+    for (comp_t rv = 0; rv < rV; rv++){
+        if (is_saturated(rv) || is_cancelled()){ continue; }
+
+        index_t rv_activation = split_component(rv,
+            first_vertex[rv + 1] - first_vertex[rv],
+            comp_list + first_vertex[rv], Gpar, altX);
+
+        set_saturation(rv, rv_activation == 0);
+        activation += rv_activation;
+    }
 
     free(altX);
     delete Gpar;
@@ -243,6 +363,81 @@ TPL index_t CP_D0::split()
     return activation;
 }
 
+TPL void CP_D0::split_component_recursively(comp_t rv, index_t comp_size,
+    index_t* comp_vertices, Flow_graph** Gpar, index_t* comp_activation)
+{
+    value_t* altX = (value_t*) malloc_check(sizeof(value_t)*D*K);
+    index_t activation = split_component(rv, comp_size, comp_vertices,
+        Gpar[omp_get_thread_num()], altX, true);
+    free(altX);
+    if (!activation){ return; } // saturated
+
+    #pragma omp atomic
+    comp_activation[rv] += activation;
+
+    if (is_cancelled()){ return; } // resulting components left as they are
+
+    /* the flow graph of the thread is not used beyond this point, so that
+     * it is available to the tasks started by this thread */
+    index_t* first_local;
+    index_t local_count = compute_local_connected_components(rv, comp_size,
+        comp_vertices, first_local);
+
+    for (index_t c = 0; c < local_count; c++){
+        index_t local_size = first_local[c + 1] - first_local[c];
+        index_t* local_vertices = comp_vertices + first_local[c];
+        /* small components are split immediately by the current thread;
+         * rough estimate assuming a couple of edges per vertex */
+        #pragma omp task if (compute_num_threads( \
+            (K - 1)*(2*D + 10)*local_size, 2, OMP_GRAPH) > 1)
+        split_component_recursively(rv, local_size, local_vertices, Gpar,
+            comp_activation);
+    }
+
+    free(first_local);
+}
+
+TPL index_t CP_D0::split_recursively()
+{
+    index_t* comp_activation = (index_t*) malloc_check(sizeof(index_t)*rV);
+    for (comp_t rv = 0; rv < rV; rv++){ comp_activation[rv] = 0; }
+
+    /* one flow graph per thread, shared by the tasks the thread executes */
+    Flow_graph** Gpar = (Flow_graph**) malloc_check(sizeof(Flow_graph*)*
+        omp_get_max_threads());
+
+    /**  refine components in parallel, recursively until saturation  **/
+    #pragma omp parallel NUM_THREADS((K - 1)*(2*D*V + 5*E), V, OMP_GRAPH)
+    {
+
+    Gpar[omp_get_thread_num()] = get_parallel_flow_graph();
+
+    /* tasks started along the way are completed by the implicit barrier */
+    #pragma omp for schedule(dynamic)
+    for (comp_t rv = 0; rv < rV; rv++){
+        if (is_saturated(rv) || is_cancelled()){ continue; }
+        split_component_recursively(rv,
+            first_vertex[rv + 1] - first_vertex[rv],
+            comp_list + first_vertex[rv], Gpar, comp_activation);
+    }
+
+    delete Gpar[omp_get_thread_num()];
+
+    } // end parallel region
+
+    free(Gpar);
+
+    /* saturation is flagged once all vertices are in their final place */
+    index_t activation = 0;
+    for (comp_t rv = 0; rv < rV; rv++){
+        set_saturation(rv, comp_activation[rv] == 0);
+        activation += comp_activation[rv];
+    }
+    free(comp_activation);
+
+    return activation;
+}
+
 TPL CP_D0::Merge_info::Merge_info(size_t D)
 { value = (value_t*) malloc_check(sizeof(value_t)*D); }
 
@@ -274,6 +469,8 @@ TPL void CP_D0::accept_merge_candidate(size_t re, comp_t& ru, comp_t& rv)
 
 TPL comp_t CP_D0::compute_merge_chains()
 {
+    if (matching_merge){ return compute_matching_merge_chains(); }
+
     comp_t merge_count = 0;
    
     merge_info_list = (Merge_info**) malloc_check(sizeof(Merge_info*)*rE);
@@ -362,6 +559,189 @@ TPL comp_t CP_D0::compute_merge_chains()
     return merge_count;
 }
 
+TPL comp_t CP_D0::compute_matching_merge_chains()
+{
+    comp_t merge_count = 0;
+
+    merge_info_list = (Merge_info**) malloc_check(sizeof(Merge_info*)*rE);
+
+    /**  list the reduced edges incident to each component  **/
+    size_t* first_incident = (size_t*) malloc_check(sizeof(size_t)*(rV + 1));
+    size_t* incident_edges = (size_t*) malloc_check(sizeof(size_t)*2*rE);
+    for (comp_t rv = 0; rv <= rV; rv++){ first_incident[rv] = 0; }
+    for (size_t re = 0; re < rE; re++){
+        first_incident[reduced_edges[2*re] + 1]++;
+        first_incident[reduced_edges[2*re + 1] + 1]++;
+    }
+    for (comp_t rv = 1; rv <= rV; rv++){
+        first_incident[rv] += first_incident[rv - 1];
+    }
+    for (size_t re = 0; re < rE; re++){
+        incident_edges[first_incident[reduced_edges[2*re]]++] = re;
+        incident_edges[first_incident[reduced_edges[2*re + 1]]++] = re;
+    }
+    for (comp_t rv = rV; rv > 0; rv--){
+        first_incident[rv] = first_incident[rv - 1];
+    }
+    first_incident[0] = 0;
+
+    /**  compute all candidates in parallel  **/
+    /* current roots of the endpoints of each reduced edge; only kept up to
+     * date for candidates with positive gain */
+    comp_t* edge_roots = (comp_t*) malloc_check(sizeof(comp_t)*2*rE);
+
+    #pragma omp parallel for schedule(static) \
+        NUM_THREADS(update_merge_complexity(), rE, OMP_GRAPH)
+    for (size_t re = 0; re < rE; re++){
+        comp_t ru = reduced_edges[2*re];
+        comp_t rv = reduced_edges[2*re + 1];
+        if (ru == rv){ /* edge from a single component to itself */
+            merge_info_list[re] = nullptr;
+            continue;
+        }
+        merge_info_list[re] = no_merge_info;
+        update_merge_candidate(re, ru, rv);
+        edge_roots[2*re] = ru;
+        edge_roots[2*re + 1] = rv;
+    }
+
+    /* list of candidates with positive gain, flagged in 'is_listed' */
+    size_t* candidates = (size_t*) malloc_check(sizeof(size_t)*rE);
+    bool* is_listed = (bool*) malloc_check(sizeof(bool)*rE);
+    size_t cand_num = 0;
+    for (size_t re = 0; re < rE; re++){
+        is_listed[re] = merge_info_list[re] &&
+            merge_info_list[re] != no_merge_info;
+        if (is_listed[re]){ candidates[cand_num++] = re; }
+    }
+
+    /* components merged in the last round, flagged in 'is_merged', and best
+     * candidate involving each root, rE if none */
+    comp_t* merged_roots = (comp_t*) malloc_check(sizeof(comp_t)*rV);
+    bool* is_merged = (bool*) malloc_check(sizeof(bool)*rV);
+    for (comp_t rv = 0; rv < rV; rv++){ is_merged[rv] = false; }
+    std::atomic<size_t>* best_edges = new std::atomic<size_t>[rV];
+
+    comp_t round_merge_count;
+    do{
+
+        /**  select locally dominant candidates in parallel  **/
+        /* atomic maximum per root, over candidates ordered by gain and then
+         * by lowest edge index; this order is total so that the selection
+         * does not depend on the schedule, and the candidate with greatest
+         * gain is always selected, ensuring progress */
+        #pragma omp parallel NUM_THREADS(2*cand_num, cand_num, OMP_GRAPH)
+        {
+        #pragma omp for schedule(static)
+        for (size_t i = 0; i < cand_num; i++){
+            size_t re = candidates[i];
+            best_edges[edge_roots[2*re]].store(rE, std::memory_order_relaxed);
+            best_edges[edge_roots[2*re + 1]].store(rE,
+                std::memory_order_relaxed);
+        }
+        #pragma omp for schedule(static)
+        for (size_t i = 0; i < cand_num; i++){
+            size_t re = candidates[i];
+            real_t gain = merge_info_list[re]->gain;
+            for (int j = 0; j < 2; j++){
+                std::atomic<size_t>& best_edge = best_edges[edge_roots[2*re
+                    + j]];
+                size_t cur = best_edge.load(std::memory_order_relaxed);
+                while (cur == rE || merge_info_list[cur]->gain < gain ||
+                    (merge_info_list[cur]->gain == gain && re < cur)){
+                    if (best_edge.compare_exchange_weak(cur, re,
+                        std::memory_order_relaxed)){ break; }
+                }
+            }
+        }
+        } // end parallel region
+
+        /**  accept all of them; they form a matching  **/
+            round_merge_count = 0;
+        for (size_t i = 0; i < cand_num; i++){
+            size_t re = candidates[i];
+            comp_t ru = edge_roots[2*re];
+            comp_t rv = edge_roots[2*re + 1];
+            if (best_edges[ru] != re || best_edges[rv] != re){ continue; }
+            accept_merge_candidate(re, ru, rv); // ru now the root
+            delete_merge_candidate(re);
+            merged_roots[round_merge_count++] = ru;
+            is_merged[ru] = true;
+        }
+        merge_count += round_merge_count;
+    
+        /**  update the candidates involving a merged component  **/
+        /* the edges of each merged component are found along its merge
+         * chain; a candidate linking two merged components is updated from
+         * the one with lowest index; the fraction of candidates to update is
+         * estimated as in compute_merge_chains() */
+        #pragma omp parallel for schedule(dynamic) \
+            NUM_THREADS(update_merge_complexity()/rV*2*round_merge_count, \
+                round_merge_count, OMP_GRAPH)
+        for (comp_t i = 0; i < round_merge_count; i++){
+            comp_t rr = merged_roots[i];
+            for (comp_t rc = rr; rc != CHAIN_LEAF;
+                 rc = get_merge_chain_next(rc)){
+            for (size_t j = first_incident[rc]; j < first_incident[rc + 1];
+                 j++){
+                size_t re = incident_edges[j];
+                comp_t ru = get_merge_chain_root(reduced_edges[2*re]);
+                comp_t rv = get_merge_chain_root(reduced_edges[2*re + 1]);
+                if (ru == rv){ /* already merged */
+                    if (merge_info_list[re]){ delete_merge_candidate(re); }
+                    continue;
+                }
+                comp_t ro = ru == rr ? rv : ru;
+                if (is_merged[ro] && ro < rr){ continue; }
+                update_merge_candidate(re, ru, rv);
+                edge_roots[2*re] = ru;
+                edge_roots[2*re + 1] = rv;
+                if (merge_info_list[re] != no_merge_info && !is_listed[re]){
+                    is_listed[re] = true;
+                    size_t k;
+                    #pragma omp atomic capture
+                    k = cand_num++;
+                    candidates[k] = re;
+                }
+            }
+            }
+        }
+
+        /* remove merged candidates and candidates with nonpositive gain */
+        size_t k = 0;
+        for (size_t i = 0; i < cand_num; i++){
+            size_t re = candidates[i];
+            if (merge_info_list[re] && merge_info_list[re] != no_merge_info){
+                candidates[k++] = re;
+            }else{
+                is_listed[re] = false;
+            }
+        }
+        cand_num = k;
+        for (comp_t i = 0; i < round_merge_count; i++){
+            is_merged[merged_roots[i]] = false;
+        }
+
+    }while (round_merge_count);
+
+    /* discard remaining candidates, all with nonpositive gain */
+    for (size_t re = 0; re < rE; re++){
+        if (merge_info_list[re]){ delete_merge_candidate(re); }
+    }
+
+    delete[] best_edges;
+    free(first_incident);
+    free(incident_edges);
+    free(edge_roots);
+    free(candidates);
+    free(is_listed);
+    free(merged_roots);
+    free(is_merged);
+    free(merge_info_list);
+
+    return merge_count;
+}
+
 /**  instantiate for compilation  **/
 template class Cp_d0<float, uint32_t, uint16_t>;
 template class Cp_d0<double, uint32_t, uint16_t>;
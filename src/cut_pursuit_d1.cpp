@@ -7,6 +7,9 @@
 
 #define ZERO ((real_t) 0.0)
 #define ONE ((real_t) 1.0)
+#define INF_REAL (std::numeric_limits<real_t>::infinity())
+#define EDGE_WEIGHTS_(e) (edge_weights ? edge_weights[(e)] : \
+    quantized_edge_weights ? quantized_edge_weights[(e)] : homo_edge_weight)
 #define COOR_WEIGHTS_(d) (coor_weights ? coor_weights[(d)] : ONE)
 
 #define TPL template <typename real_t, typename index_t, typename comp_t>
@@ -15,9 +18,26 @@
 using namespace std;
 
 TPL CP_D1::Cp_d1(index_t V, index_t E, const index_t* first_edge,
-    const index_t* adj_vertices, size_t D, D1p d1p)
+    Adj_vertices<index_t> adj_vertices, size_t D, D1p d1p)
     : Cp<real_t, index_t, comp_t>(V, E, first_edge, adj_vertices, D), d1p(d1p)
-{ coor_weights = nullptr; }
+{
+    coor_weights = nullptr;
+    independent_reduced_solves = true;
+    independent_min_size = 1000;
+    reduced_solver = REDUCED_PFDR;
+    pd_dual_scale = ZERO;
+    auto_coupling_max = 0.5;
+    duality_gap = INF_REAL;
+    dual_flows = certified_grad = nullptr;
+    own_flows = nullptr;
+    loose_dif_tol = inexactness = ZERO;
+    last_objective = INF_REAL;
+    accurate_retry = false;
+    stable_ratio = 0.05;
+    loose_it_max = 100;
+}
+
+TPL CP_D1::~Cp_d1(){ free(dual_flows); free(own_flows); free(certified_grad); }
 
 TPL void CP_D1::set_edge_weights(const real_t* edge_weights,
     real_t homo_edge_weight, const real_t* coor_weights)
@@ -25,6 +45,254 @@ TPL void CP_D1::set_edge_weights(const real_t* edge_weights,
     Cp<real_t, index_t, comp_t>::set_edge_weights(edge_weights,
         homo_edge_weight);
     this->coor_weights = coor_weights;
+    reset_certificate_cache(true);
+}
+
+TPL void CP_D1::set_independent_reduced_solves(bool independent,
+    comp_t min_size)
+{
+    independent_reduced_solves = independent;
+    independent_min_size = min_size;
+}
+
+TPL void CP_D1::set_reduced_solver(Reduced_solver solver,
+    real_t pd_dual_scale, real_t auto_coupling_max)
+{
+    if (pd_dual_scale < ZERO || auto_coupling_max < ZERO){
+        cerr << "Cut-pursuit d1: primal-dual dual scale and automatic choice "
+            "coupling should be nonnegative (" << pd_dual_scale << " and "
+            << auto_coupling_max << " given)." << endl;
+        exit(EXIT_FAILURE);
+    }
+    reduced_solver = solver;
+    this->pd_dual_scale = pd_dual_scale;
+    this->auto_coupling_max = auto_coupling_max;
+}
+
+TPL void CP_D1::set_gap_tol(real_t gap_tol)
+{
+    if (gap_tol < ZERO){
+        cerr << "Cut-pursuit d1: duality gap tolerance should be nonnegative ("
+            << gap_tol << " given)." << endl;
+        exit(EXIT_FAILURE);
+    }
+    if (gap_tol > ZERO && d1p != D11){
+        cerr << "Cut-pursuit d1: duality gap certificates are only available "
+            "for d1,1 total variation." << endl;
+        exit(EXIT_FAILURE);
+    }
+    this->gap_tol = gap_tol;
+    /* iterations without certificates do not maintain them */
+    reset_certificate_cache(true);
+}
+
+TPL real_t CP_D1::get_duality_gap(){ return duality_gap; }
+
+TPL void CP_D1::set_inexact_reduced(real_t loose_dif_tol, int loose_it_max,
+    real_t stable_ratio)
+{
+    if (loose_dif_tol < ZERO || loose_it_max < 1 || stable_ratio < ZERO ||
+        stable_ratio >= ONE){
+        cerr << "Cut-pursuit d1: inexact reduced problems loose tolerance "
+            "should be nonnegative, loose maximum number of iterations "
+            "positive, and stable ratio within [0, 1) (" << loose_dif_tol
+            << ", " << loose_it_max << " and " << stable_ratio << " given)."
+            << endl;
+        exit(EXIT_FAILURE);
+    }
+    this->loose_dif_tol = loose_dif_tol;
+    this->loose_it_max = loose_it_max;
+    this->stable_ratio = stable_ratio;
+}
+
+TPL void CP_D1::schedule_reduced(real_t dif_tol, int it_max)
+{
+    /* the iterate changes; the partition also changes after initialization
+     * or update, see compute_dual_flows() */
+    reset_certificate_cache(!last_rV);
+
+    inexactness = ZERO;
+    /* no previous partition after initialization or update, and a reduced
+     * problem failing to decrease the objective is solved again accurately,
+     * see reduced_decrease() */
+    if (loose_dif_tol > ZERO && !exact_reduced && last_rV && last_activation
+        && !accurate_retry){
+        index_t active_count = 0;
+        #pragma omp parallel for schedule(static) NUM_THREADS(E) \
+            reduction(+:active_count)
+        for (index_t e = 0; e < E; e++){
+            if (is_active(e)){ active_count++; }
+        }
+        real_t new_ratio = (real_t) last_activation/active_count;
+        if (new_ratio > ONE){ new_ratio = ONE; }
+        if (new_ratio > stable_ratio){
+            inexactness = (new_ratio - stable_ratio)/(ONE - stable_ratio);
+        }
+    }
+    approx_reduced = reduced_dif_tol(dif_tol) > dif_tol ||
+        reduced_it_max(it_max) < it_max;
+}
+
+TPL bool CP_D1::reduced_decrease()
+{
+    if (loose_dif_tol == ZERO){ return true; }
+    real_t objective = compute_objective();
+    if (inexactness > ZERO && objective >= last_objective &&
+        !is_cancelled()){
+        accurate_retry = true;
+        return false;
+    }
+    accurate_retry = false;
+    last_objective = objective;
+    return true;
+}
+
+TPL real_t CP_D1::reduced_dif_tol(real_t dif_tol)
+{
+    if (inexactness == ZERO || loose_dif_tol <= dif_tol){ return dif_tol; }
+    return dif_tol > ZERO ? dif_tol*pow(loose_dif_tol/dif_tol, inexactness)
+        : loose_dif_tol*inexactness;
+}
+
+TPL int CP_D1::reduced_it_max(int it_max)
+{
+    if (inexactness == ZERO || loose_it_max >= it_max){ return it_max; }
+    return it_max*pow((real_t) loose_it_max/it_max, inexactness);
+}
+
+TPL bool CP_D1::use_primal_dual(comp_t rV, size_t rE,
+    const comp_t* reduced_edges, const real_t* reduced_edge_weights,
+    const real_t* curvature)
+{
+    if (reduced_solver != REDUCED_AUTO){
+        return reduced_solver == REDUCED_PD;
+    }
+    if (!curvature || rE == 0){ return false; }
+
+    /* compare total coupling and total curvature */
+    real_t sum_wdeg = ZERO, sum_curv = ZERO;
+    for (size_t re = 0; re < rE; re++){
+        if (reduced_edges[2*re] == reduced_edges[2*re + 1]){ continue; }
+        sum_wdeg += 2.0*reduced_edge_weights[re];
+    }
+    for (comp_t rv = 0; rv < rV; rv++){ sum_curv += curvature[rv]; }
+
+    return sum_wdeg <= auto_coupling_max*sum_curv;
+}
+
+TPL comp_t CP_D1::compute_reduced_components(comp_t*& rcomp_list,
+    comp_t*& first_rcomp_vertex, comp_t*& rcomp_edges,
+    real_t*& rcomp_edge_weights, size_t*& first_rcomp_edge)
+{
+    /**  union-find along the reduced edges  **/
+    comp_t* parent = (comp_t*) malloc_check(sizeof(comp_t)*rV);
+    for (comp_t rv = 0; rv < rV; rv++){ parent[rv] = rv; }
+    for (size_t re = 0; re < rE; re++){
+        comp_t ru = reduced_edges[2*re];
+        comp_t rv = reduced_edges[2*re + 1];
+        while (parent[ru] != ru){ ru = parent[ru] = parent[parent[ru]]; }
+        while (parent[rv] != rv){ rv = parent[rv] = parent[parent[rv]]; }
+        /* the root of each tree is its lowest reduced vertex */
+        if (ru < rv){ parent[rv] = ru; }else if (rv < ru){ parent[ru] = rv; }
+    }
+
+    /**  number the components in increasing order of their roots  **/
+    comp_t* rcomp_assign = parent; // reuse storage in-place
+    comp_t rcomp_num = 0;
+    for (comp_t rv = 0; rv < rV; rv++){
+        /* parent[rv] <= rv, and roots have already been numbered */
+        rcomp_assign[rv] = parent[rv] == rv ? rcomp_num++ :
+            rcomp_assign[parent[rv]];
+    }
+
+    /**  gather consecutive components with several reduced vertices into
+     **  groups of at least 'independent_min_size' reduced vertices, so that
+     **  the overhead of each subproblem remains negligible  **/
+    first_rcomp_vertex = (comp_t*) malloc_check(sizeof(comp_t)*
+        ((size_t) rcomp_num + 1));
+    comp_t* rcomp_size = first_rcomp_vertex; // reuse storage
+    for (comp_t rc = 0; rc < rcomp_num; rc++){ rcomp_size[rc] = 0; }
+    for (comp_t rv = 0; rv < rV; rv++){ rcomp_size[rcomp_assign[rv]]++; }
+    comp_t* rcomp_group = (comp_t*) malloc_check(sizeof(comp_t)*rcomp_num);
+    comp_t group_num = 0, open_group = 0, group_size = 0;
+    for (comp_t rc = 0; rc < rcomp_num; rc++){
+        if (rcomp_size[rc] == 1){ rcomp_group[rc] = group_num++; continue; }
+        if (!group_size){ open_group = group_num++; }
+        rcomp_group[rc] = open_group;
+        group_size += rcomp_size[rc];
+        if (group_size >= independent_min_size){ group_size = 0; }
+    }
+    for (comp_t rv = 0; rv < rV; rv++){
+        rcomp_assign[rv] = rcomp_group[rcomp_assign[rv]];
+    }
+    free(rcomp_group);
+    rcomp_num = group_num;
+
+    /**  list the reduced vertices of each group  **/
+    for (comp_t rc = 0; rc <= rcomp_num; rc++){ first_rcomp_vertex[rc] = 0; }
+    for (comp_t rv = 0; rv < rV; rv++){
+        first_rcomp_vertex[rcomp_assign[rv] + 1]++;
+    }
+    for (comp_t rc = 1; rc < rcomp_num - 1; rc++){
+        first_rcomp_vertex[rc + 1] += first_rcomp_vertex[rc];
+    }
+    rcomp_list = (comp_t*) malloc_check(sizeof(comp_t)*rV);
+    /* position of each reduced vertex within its component */
+    comp_t* rcomp_index = (comp_t*) malloc_check(sizeof(comp_t)*rV);
+    for (comp_t rv = 0; rv < rV; rv++){
+        comp_t i = first_rcomp_vertex[rcomp_assign[rv]]++;
+        rcomp_list[i] = rv;
+        rcomp_index[rv] = i;
+    }
+    for (comp_t rc = rcomp_num; rc > 0; rc--){
+        first_rcomp_vertex[rc] = first_rcomp_vertex[rc - 1];
+    }
+    first_rcomp_vertex[0] = 0;
+    for (comp_t rv = 0; rv < rV; rv++){
+        rcomp_index[rv] -= first_rcomp_vertex[rcomp_assign[rv]];
+    }
+
+    /**  list the reduced edges of each group, with local indices  **/
+    first_rcomp_edge = (size_t*) malloc_check(sizeof(size_t)*
+        ((size_t) rcomp_num + 1));
+    for (comp_t rc = 0; rc <= rcomp_num; rc++){ first_rcomp_edge[rc] = 0; }
+    size_t rcomp_E = 0;
+    for (size_t re = 0; re < rE; re++){
+        comp_t ru = reduced_edges[2*re];
+        comp_t rv = reduced_edges[2*re + 1];
+        if (ru != rv){ first_rcomp_edge[rcomp_assign[ru] + 1]++; rcomp_E++; }
+    }
+    for (comp_t rc = 1; rc < rcomp_num - 1; rc++){
+        first_rcomp_edge[rc + 1] += first_rcomp_edge[rc];
+    }
+    rcomp_edges = (comp_t*) malloc_check(sizeof(comp_t)*2*rcomp_E);
+    rcomp_edge_weights = (real_t*) malloc_check(sizeof(real_t)*rcomp_E);
+    for (size_t re = 0; re < rE; re++){
+        comp_t ru = reduced_edges[2*re];
+        comp_t rv = reduced_edges[2*re + 1];
+        if (ru == rv){ continue; }
+        size_t i = first_rcomp_edge[rcomp_assign[ru]]++;
+        rcomp_edges[2*i] = rcomp_index[ru];
+        rcomp_edges[2*i + 1] = rcomp_index[rv];
+        rcomp_edge_weights[i] = reduced_edge_weights[re];
+    }
+    for (comp_t rc = rcomp_num; rc > 0; rc--){
+        first_rcomp_edge[rc] = first_rcomp_edge[rc - 1];
+    }
+    first_rcomp_edge[0] = 0;
+
+    free(parent);
+    free(rcomp_index);
+
+    return rcomp_num;
+}
+
+TPL comp_t CP_D1::large_reduced_component_size(comp_t rcomp_num)
+{
+    /* if more threads are available than components, they are mostly useful
+     * within the largest components */
+    int num_thrds = compute_num_threads((uintmax_t) D*rV, rcomp_num);
+    return rV/num_thrds;
 }
 
 TPL bool CP_D1::is_almost_equal(comp_t ru, comp_t rv)
@@ -66,10 +334,244 @@ TPL comp_t CP_D1::compute_merge_chains()
     return merge_count;
 }
 
+TPL bool CP_D1::is_tied(index_t v, index_t e, size_t d)
+{
+    /* same relative tolerance as for merging, see is_almost_equal() */
+    real_t xu = rX[D*comp_assign[v] + d];
+    real_t xv = rX[D*comp_assign[adj_vertex(e)] + d];
+    real_t amp = abs(xu) > abs(xv) ? abs(xu) : abs(xv);
+    if (eps > amp){ amp = eps; }
+    return abs(xu - xv) <= dif_tol*amp;
+}
+
+TPL bool CP_D1::is_crossing(index_t v, index_t e)
+{ return comp_assign[v] != comp_assign[adj_vertex(e)]; }
+
+TPL void CP_D1::reset_certificate_cache(bool flows)
+{
+    free(certified_grad);
+    certified_grad = nullptr;
+    if (flows && own_flows){
+        for (size_t i = 0; i < D*V; i++){ own_flows[i] = false; }
+    }
+}
+
+TPL void CP_D1::compute_dual_flows(const real_t* out_min,
+    const real_t* out_max)
+{
+    if (!dual_flows){
+        dual_flows = (real_t*) malloc_check(sizeof(real_t)*D*V);
+        own_flows = (bool*) malloc_check(sizeof(bool)*D*V);
+        for (size_t i = 0; i < D*V; i++){ own_flows[i] = false; }
+    }
+    real_t* flows = dual_flows;
+
+    /* saturation is stored along the maximum flow states, see cp_graph.hpp */
+    bool* saturated = (bool*) malloc_check(sizeof(bool)*rV);
+    for (comp_t rv = 0; rv < rV; rv++){ saturated[rv] = is_saturated(rv); }
+
+    /**  along each coordinate, components with equal values are grouped
+     **  together, and flows are also routed along the active edges between
+     **  them, by adjusting the subgradient of the total variation  **/
+    comp_t* group = (comp_t*) malloc_check(sizeof(comp_t)*rV);
+    comp_t* group_id = (comp_t*) malloc_check(sizeof(comp_t)*rV);
+    index_t* first_group_vertex = (index_t*)
+        malloc_check(sizeof(index_t)*(rV + 1));
+    index_t* group_list = (index_t*) malloc_check(sizeof(index_t)*V);
+
+    for (size_t d = 0; d < D; d++){
+        /* union-find, each group being represented by its lowest component */
+        for (comp_t rv = 0; rv < rV; rv++){ group[rv] = rv; }
+        bool tied = false;
+        for (index_t v = 0; v < V; v++){
+            for (index_t e = first_edge[v]; e < first_edge[v + 1]; e++){
+                if (!is_active(e) || !is_tied(v, e, d)){ continue; }
+                comp_t ru = comp_assign[v], rv = comp_assign[adj_vertex(e)];
+                while (group[ru] != ru){ ru = group[ru] = group[group[ru]]; }
+                while (group[rv] != rv){ rv = group[rv] = group[group[rv]]; }
+                if (ru < rv){ group[rv] = ru; tied = true; }
+                else if (rv < ru){ group[ru] = rv; tied = true; }
+            }
+        }
+
+        comp_t group_num = rV;
+        const index_t* group_first = first_vertex;
+        const index_t* group_vertices = comp_list;
+        if (tied){ /* list the vertices of each group */
+            group_num = 0;
+            for (comp_t rv = 0; rv < rV; rv++){
+                /* parents have lower indices */
+                group_id[rv] = group[rv] == rv ? group_num++ :
+                    group_id[group[rv]];
+            }
+            for (comp_t g = 0; g <= group_num; g++){
+                first_group_vertex[g] = 0;
+            }
+            for (comp_t rv = 0; rv < rV; rv++){
+                first_group_vertex[group_id[rv] + 1] +=
+                    first_vertex[rv + 1] - first_vertex[rv];
+            }
+            for (comp_t g = 1; g <= group_num; g++){
+                first_group_vertex[g] += first_group_vertex[g - 1];
+            }
+            for (comp_t rv = 0; rv < rV; rv++){
+                index_t& i = first_group_vertex[group_id[rv]];
+                for (index_t j = first_vertex[rv]; j < first_vertex[rv + 1];
+                    j++){ group_list[i++] = comp_list[j]; }
+            }
+            for (comp_t g = group_num; g > 0; g--){
+                first_group_vertex[g] = first_group_vertex[g - 1];
+            }
+            first_group_vertex[0] = 0;
+            group_first = first_group_vertex;
+            group_vertices = group_list;
+        }
+
+        #pragma omp parallel NUM_THREADS(4*V + 10*E, group_num, OMP_GRAPH)
+        {
+
+        Flow_graph* Gpar = get_parallel_flow_graph();
+
+        #pragma omp for schedule(dynamic)
+        for (comp_t g = 0; g < group_num; g++){
+            const index_t size = group_first[g + 1] - group_first[g];
+            const index_t* vertices = group_vertices + group_first[g];
+
+            /* a saturated component has not changed since the last
+             * certificate, so that the flows routed within it remain
+             * feasible, and any feasible flow gives a valid dual point */
+            const comp_t rv = comp_assign[vertices[0]];
+            const bool own = first_vertex[rv + 1] - first_vertex[rv] == size;
+            if (own && saturated[rv] && own_flows[D*vertices[0] + d]){
+                continue;
+            }
+            for (index_t i = 0; i < size; i++){
+                flows[D*vertices[i] + d] = ZERO;
+                own_flows[D*vertices[i] + d] = own;
+            }
+            if (size == 1){ continue; } /* nothing to route */
+
+            /* edges within components are the inactive ones, but tied edges
+             * are not flagged as active until flows are computed; no vertex
+             * can send or receive more than the total capacity, which thus
+             * replaces infinite bounds; the subgradient of the
+             * total variation along tied active edges is the one taken for
+             * the gradient, from the ending to the starting vertex, and is
+             * allowed to vary up to its opposite */
+            real_t cap_sum = ZERO;
+            for (index_t i = 0; i < size; i++){
+                index_t v = vertices[i];
+                for (index_t e = first_edge[v]; e < first_edge[v + 1]; e++){
+                    real_t cap = EDGE_WEIGHTS_(e)*COOR_WEIGHTS_(d);
+                    if (!is_crossing(v, e)){
+                        set_edge_capacities(e, cap, cap);
+                    }else if (is_tied(v, e, d)){
+                        set_edge_capacities(e, ZERO, 2.0*cap);
+                    }else{
+                        continue;
+                    }
+                    cap_sum += cap;
+                }
+            }
+
+            /**  first, route the lower bounds; second, route what remains
+             **  up to the upper bounds, in the residual graph, unless they
+             **  coincide, in which case no augmenting path remains  **/
+            bool slack = false;
+            for (int bound = 0; bound < 2 && (bound == 0 || slack); bound++){
+                bool source = false, sink = false;
+                for (index_t i = 0; i < size; i++){
+                    index_t v = vertices[i];
+                    if (out_max[D*v + d] > out_min[D*v + d]){ slack = true; }
+                    real_t cap = bound == 0 ? out_min[D*v + d] :
+                        out_max[D*v + d] - flows[D*v + d];
+                    if (cap > cap_sum){ cap = cap_sum; }
+                    else if (cap < -cap_sum){ cap = -cap_sum; }
+                    set_term_capacities(v, cap);
+                    if (cap > ZERO){ source = true; }
+                    else if (cap < ZERO){ sink = true; }
+                }
+                if (!source || !sink){ continue; }
+
+                /* the flows are needed and not only the cut, so that the
+                 * algorithm is run directly on the main flow graph */
+                Gpar->maxflow(size, vertices, MAXFLOW_BK);
+
+                /* residual capacities accumulate over both flows */
+                for (index_t i = 0; i < size; i++){
+                    flows[D*vertices[i] + d] = ZERO;
+                }
+                for (index_t i = 0; i < size; i++){
+                    index_t u = vertices[i];
+                    for (index_t e = first_edge[u]; e < first_edge[u + 1];
+                        e++){
+                        real_t flow = get_edge_flow(e);
+                        if (is_crossing(u, e)){
+                            if (!is_tied(u, e, d)){ continue; }
+                            /* asymmetric capacities */
+                            flow -= EDGE_WEIGHTS_(e)*COOR_WEIGHTS_(d);
+                        }
+                        flows[D*u + d] += flow;
+                        flows[D*adj_vertex(e) + d] -= flow;
+                    }
+                }
+            }
+
+            for (index_t i = 0; i < size; i++){
+                index_t v = vertices[i];
+                for (index_t e = first_edge[v]; e < first_edge[v + 1]; e++){
+                    if (is_crossing(v, e) && is_tied(v, e, d)){
+                        set_active(e);
+                    }
+                }
+            }
+        }
+
+        delete Gpar;
+
+        } // end parallel region
+    }
+
+    for (comp_t rv = 0; rv < rV; rv++){ set_saturation(rv, saturated[rv]); }
+
+    free(saturated);
+    free(group);
+    free(group_id);
+    free(first_group_vertex);
+    free(group_list);
+}
+
+TPL real_t CP_D1::certify_components(const real_t* vertex_gap,
+    bool saturate)
+{
+    real_t gap = ZERO;
+    comp_t saturation_par_count = 0; // auxiliary variable for parallel region
+    #pragma omp parallel for schedule(dynamic) NUM_THREADS(V, rV) \
+        reduction(+:gap, saturation_par_count)
+    for (comp_t rv = 0; rv < rV; rv++){
+        real_t rv_gap = ZERO;
+        for (index_t i = first_vertex[rv]; i < first_vertex[rv + 1]; i++){
+            rv_gap += vertex_gap[comp_list[i]];
+        }
+        gap += rv_gap;
+        if (!saturate){ continue; }
+        /* share of the tolerance proportional to the size */
+        if (rv_gap <= gap_tol*(first_vertex[rv + 1] - first_vertex[rv])/V){
+            set_saturation(rv, true);
+            saturation_par_count++;
+        }else{
+            set_saturation(rv, false);
+        }
+    }
+    if (saturate){ saturation_count = saturation_par_count; }
+    return duality_gap = gap;
+}
+
 TPL real_t CP_D1::compute_graph_d1()
 {
     real_t tv = ZERO;
-    #pragma omp parallel for schedule(static) NUM_THREADS(2*rE*D, rE) \
+    #pragma omp parallel for schedule(static) \
+        NUM_THREADS(2*rE*D, rE, OMP_GRAPH) \
         reduction(+:tv)
     for (size_t re = 0; re < rE; re++){
         real_t *rXu = rX + reduced_edges[2*re]*D;
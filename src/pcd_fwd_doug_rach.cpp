@@ -159,6 +159,9 @@ TPL void PFDR::preconditioning(bool init)
 
     if (init){
         if (!Z){ initialize_auxiliary(); }
+        else if (Z_Id){ /* warm restart, Z_Id might have just been allocated */
+            for (size_t id = 0; id < size*D; id++){ Z_Id[id] = X[id]; }
+        }
         if (!Ga && gashape != SCALAR){
             if (gashape == MONODIM){
                 Ga = (real_t*) malloc_check(sizeof(real_t)*size);
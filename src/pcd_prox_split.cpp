@@ -26,6 +26,7 @@ TPL PCD_PROX::Pcd_prox(size_t size) : size(size)
     verbose = 1e2;
     eps = numeric_limits<real_t>::epsilon();
     X = nullptr;
+    cancel = nullptr;
 }
 
 TPL PCD_PROX::~Pcd_prox(){ free(X); }
@@ -46,6 +47,9 @@ TPL void PCD_PROX::set_conditioning_param(real_t cond_min, real_t dif_rcd)
     this->dif_rcd = dif_rcd;
 }
 
+TPL void PCD_PROX::set_cancel_flag(const atomic<bool>* cancel)
+{ this->cancel = cancel; }
+
 TPL void PCD_PROX::set_algo_param(real_t dif_tol, int it_max, int verbose,
     real_t eps)
 {
@@ -91,7 +95,7 @@ TPL int PCD_PROX::precond_proximal_splitting(bool init)
         for (size_t i = 0; i < size; i++){ last_X[i] = X[i]; }
     }
 
-    while (it < it_max && dif >= dif_tol){
+    while (it < it_max && dif >= dif_tol && !(cancel && *cancel)){
 
         if (verbose && it_verb == verbose){
             print_progress(it, dif);
@@ -142,8 +146,9 @@ TPL void PCD_PROX::print_progress(int it, real_t dif)
 TPL real_t PCD_PROX::compute_evolution()
 /* by default, relative evolution in Euclidean norm */
 {
-    real_t dif = ZERO;
-    real_t norm = ZERO;
+    /* accumulate in double precision, for accuracy in single precision */
+    double dif = 0.0;
+    double norm = 0.0;
     #pragma omp parallel for schedule(static) NUM_THREADS(size) \
         reduction(+:dif, norm)
     for (size_t i = 0; i < size; i++){
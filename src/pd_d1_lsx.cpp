@@ -0,0 +1,211 @@
+/*=============================================================================
+ * Diagonally preconditioned primal-dual algorithm for separable loss on the
+ * simplex with graph total variation
+ *===========================================================================*/
+#include <cmath>
+#include "../include/pd_d1_lsx.hpp"
+#include "../include/proj_simplex.hpp"
+#include "../include/omp_num_threads.hpp"
+
+/* constants of the correct type */
+#define ZERO ((real_t) 0.0)
+#define ONE ((real_t) 1.0)
+#define HALF ((real_t) 0.5)
+
+#define LOSS_WEIGHTS_(v) (loss_weights ? loss_weights[(v)] : ONE)
+
+#define TPL template <typename real_t, typename vertex_t>
+#define PD_D1_LSX Pd_d1_lsx<real_t, vertex_t>
+
+using namespace std;
+
+TPL PD_D1_LSX::Pd_d1_lsx(vertex_t V, size_t E, const vertex_t* edges,
+    real_t loss, size_t D, const real_t* Y, const real_t* d1_coor_weights)
+    : Pd_d1<real_t, vertex_t>(V, E, edges, D, d1_coor_weights), Y(Y),
+    loss(loss)
+{
+    loss_weights = nullptr;
+    Lmut = nullptr;
+}
+
+TPL PD_D1_LSX::~Pd_d1_lsx(){ free(Lmut); }
+
+TPL void PD_D1_LSX::set_loss(real_t loss, const real_t* Y,
+    const real_t* loss_weights)
+{
+    if (loss < ZERO || loss > ONE){
+        cerr << "PD graph d1 loss simplex: loss parameter should be between "
+            "0 and 1 (" << loss << " given)." << endl;
+        exit(EXIT_FAILURE);
+    }
+    if ((this->loss != loss) &&
+        (this->loss == LINEAR || this->loss == QUADRATIC ||
+         loss == LINEAR || loss == QUADRATIC)){
+        cerr << "PD graph d1 loss simplex: the type of loss cannot be "
+            "changed; for changing from one loss type to another, create a "
+            "new instance of Pd_d1_lsx." << endl;
+        exit(EXIT_FAILURE);
+    }
+    this->loss = loss;
+    if (Y){ this->Y = Y; }
+    this->loss_weights = loss_weights;
+}
+
+TPL void PD_D1_LSX::compute_lipschitz_metric()
+{
+    double sum = 0.0;
+    if (loss == LINEAR){
+        L = nullptr;
+    }else if (loss == QUADRATIC){ /* within the proximal operator */
+        L = nullptr;
+        #pragma omp parallel for schedule(static) NUM_THREADS(V) \
+            reduction(+:sum)
+        for (vertex_t v = 0; v < V; v++){ sum += LOSS_WEIGHTS_(v); }
+    }else{ /* KLs loss, Lv = max_d max_{0 <= x_d <= 1} d^2KLs/dx_d^2
+            *              = max_d (1-s)^2/(s/D)^2 (s/D + (1-s)y_d) */
+        const real_t c = (ONE - loss);
+        const real_t q = loss/D;
+        const real_t r = c*c/(q*q);
+        if (!Lmut){ Lmut = (real_t*) malloc_check(sizeof(real_t)*V); }
+        #pragma omp parallel for schedule(static) NUM_THREADS(V*D, V) \
+            reduction(+:sum)
+        for (vertex_t v = 0; v < V; v++){
+            const real_t* Yv = Y + D*v;
+            real_t max_y = Yv[0];
+            for (size_t d = 1; d < D; d++){
+                if (Yv[d] > max_y){ max_y = Yv[d]; }
+            }
+            Lmut[v] = LOSS_WEIGHTS_(v)*r*(q + c*max_y);
+            sum += Lmut[v];
+        }
+        L = Lmut;
+    }
+    mean_curvature = sum/V;
+}
+
+TPL void PD_D1_LSX::compute_grad_f()
+{
+    if (loss == LINEAR || loss == QUADRATIC){ return; }
+    /* dKLs/dx_d = -(1-s)(s/D + (1-s)y_d)/(s/D + (1-s)x_d) */
+    const real_t c = (ONE - loss);
+    const real_t q = loss/D;
+    #pragma omp parallel for schedule(static) NUM_THREADS(V*D, V)
+    for (vertex_t v = 0; v < V; v++){
+        size_t vd = D*v;
+        for (size_t d = 0; d < D; d++){
+            Grad[vd] = -LOSS_WEIGHTS_(v)*c*(q + c*Y[vd])/(q + c*X[vd]);
+            vd++;
+        }
+    }
+}
+
+TPL void PD_D1_LSX::compute_prox_Tau_h()
+{
+    if (loss == LINEAR){ /* shift by Tau w Y */
+        #pragma omp parallel for schedule(static) NUM_THREADS(V*D, V)
+        for (vertex_t v = 0; v < V; v++){
+            real_t tau_w = Tau[v]*LOSS_WEIGHTS_(v);
+            size_t vd = D*v;
+            for (size_t d = 0; d < D; d++){ X[vd] += tau_w*Y[vd]; vd++; }
+        }
+    }else if (loss == QUADRATIC){ /* weighted average with Y */
+        #pragma omp parallel for schedule(static) NUM_THREADS(V*D, V)
+        for (vertex_t v = 0; v < V; v++){
+            real_t tau_w = Tau[v]*LOSS_WEIGHTS_(v);
+            size_t vd = D*v;
+            for (size_t d = 0; d < D; d++){
+                X[vd] = (X[vd] + tau_w*Y[vd])/(ONE + tau_w);
+                vd++;
+            }
+        }
+    }
+    /* metric is uniform along coordinates of each vertex */
+    proj_simplex<real_t>(X, D, V, nullptr, ONE);
+}
+
+TPL real_t PD_D1_LSX::compute_f()
+{
+    double obj = 0.0; // accumulate in double precision
+    if (loss == LINEAR){
+        #pragma omp parallel for schedule(static) NUM_THREADS(V*D, V) \
+            reduction(+:obj)
+        for (vertex_t v = 0; v < V; v++){
+            real_t* Xv = X + D*v;
+            const real_t* Yv = Y + D*v;
+            real_t prod = ZERO;
+            for (size_t d = 0; d < D; d++){ prod += Xv[d]*Yv[d]; }
+            obj -= LOSS_WEIGHTS_(v)*prod;
+        }
+    }else if (loss == QUADRATIC){
+        #pragma omp parallel for schedule(static) NUM_THREADS(V*D, V) \
+            reduction(+:obj)
+        for (vertex_t v = 0; v < V; v++){
+            real_t* Xv = X + D*v;
+            const real_t* Yv = Y + D*v;
+            real_t dif2 = ZERO;
+            for (size_t d = 0; d < D; d++){
+                dif2 += (Xv[d] - Yv[d])*(Xv[d] - Yv[d]);
+            }
+            obj += LOSS_WEIGHTS_(v)*dif2;
+        }
+        obj *= HALF;
+    }else{ /* smoothed Kullback-Leibler */
+        const real_t c = (ONE - loss);
+        const real_t q = loss/D;
+        #pragma omp parallel for schedule(static) NUM_THREADS(V*D, V) \
+            reduction(+:obj)
+        for (vertex_t v = 0; v < V; v++){
+            real_t* Xv = X + D*v;
+            const real_t* Yv = Y + D*v;
+            real_t KLs = ZERO;
+            for (size_t d = 0; d < D; d++){
+                real_t ys = q + c*Yv[d];
+                KLs += ys*log(ys/(q + c*Xv[d]));
+            }
+            obj += LOSS_WEIGHTS_(v)*KLs;
+        }
+    }
+    return obj;
+}
+
+TPL void PD_D1_LSX::preconditioning(bool init)
+{
+    if (loss != LINEAR && loss != QUADRATIC && !Grad){
+        Grad = (real_t*) malloc_check(sizeof(real_t)*V*D);
+    }
+
+    Pd_d1<real_t, vertex_t>::preconditioning(init);
+}
+
+TPL void PD_D1_LSX::initialize_iterate()
+{
+    if (!X){ X = (real_t*) malloc_check(sizeof(real_t)*V*D); }
+    /* currently all assumed to lie on the simplex, see Pfdr_d1_lsx */
+    for (size_t vd = 0; vd < V*D; vd++){ X[vd] = Y[vd]; }
+}
+
+TPL real_t PD_D1_LSX::compute_primal_evolution()
+{
+    double dif = 0.0; // accumulate in double precision
+    double amp = 0.0;
+    #pragma omp parallel for schedule(static) NUM_THREADS(V*D, V) \
+        reduction(+:dif, amp)
+    for (vertex_t v = 0; v < V; v++){
+        real_t* Xv = X + D*v;
+        real_t* last_Xv = last_X + D*v;
+        real_t dif_v = ZERO;
+        for (size_t d = 0; d < D; d++){
+            dif_v += abs(last_Xv[d] - Xv[d]);
+            last_Xv[d] = Xv[d];
+        }
+        dif += LOSS_WEIGHTS_(v)*dif_v;
+        amp += LOSS_WEIGHTS_(v);
+    }
+    return dif/amp;
+}
+
+/**  instantiate for compilation  **/
+template class Pd_d1_lsx<float, uint16_t>;
+template class Pd_d1_lsx<float, uint32_t>;
+template class Pd_d1_lsx<double, uint16_t>;
+template class Pd_d1_lsx<double, uint32_t>;
@@ -0,0 +1,295 @@
+/*=============================================================================
+ * Diagonally preconditioned primal-dual algorithm for quadratic, l1 and
+ * bounds problems with graph total variation
+ *===========================================================================*/
+#include <cmath>
+#include "../include/pd_d1_ql1b.hpp"
+#include "../include/matrix_tools.hpp"
+#include "../include/omp_num_threads.hpp"
+
+/* constants of the correct type */
+#define ZERO ((real_t) 0.0)
+#define ONE ((real_t) 1.0)
+#define HALF ((real_t) 0.5)
+#define Y_(n) (Y ? Y[(n)] : (real_t) 0.0)
+#define Yl1_(v) (Yl1 ? Yl1[(v)] : (real_t) 0.0)
+#define AA_(v) (A ? A[(v)] : a) // diagonal of A^t A, when it is diagonal
+
+#define TPL template <typename real_t, typename vertex_t>
+#define PD_D1_QL1B Pd_d1_ql1b<real_t, vertex_t>
+
+using namespace std;
+
+TPL PD_D1_QL1B::Pd_d1_ql1b(vertex_t V, size_t E, const vertex_t* edges)
+    : Pd_d1<real_t, vertex_t>(V, E, edges)
+{
+    /* ensure handling of infinite values (negation, comparisons) is safe */
+    static_assert(numeric_limits<real_t>::is_iec559,
+        "PD d1 quadratic l1 bounds: real_t must satisfy IEEE 754.");
+    Y = Yl1 = A = nullptr;
+    R = AX = Lmut = nullptr;
+    N = DIAG_ATA;
+    a = ONE;
+    l1_weights = nullptr; homo_l1_weight = ZERO;
+    low_bnd = nullptr; homo_low_bnd = -INF_REAL;
+    upp_bnd = nullptr; homo_upp_bnd = INF_REAL;
+}
+
+TPL PD_D1_QL1B::~Pd_d1_ql1b(){ free(R); free(AX); free(Lmut); }
+
+TPL void PD_D1_QL1B::set_quadratic(const real_t* Y, size_t N,
+    const real_t* A, real_t a)
+{
+    if (!A && !a){ N = DIAG_ATA; } // no quadratic part !
+    free(R); free(AX);
+    R = IS_ATA(N) ? nullptr : (real_t*) malloc_check(sizeof(real_t)*N);
+    AX = N == FULL_ATA ? (real_t*) malloc_check(sizeof(real_t)*V) : nullptr;
+    this->Y = Y; this->N = N; this->A = A; this->a = a;
+}
+
+TPL void PD_D1_QL1B::set_l1(const real_t* l1_weights, real_t homo_l1_weight,
+    const real_t* Yl1)
+{
+    if (!l1_weights && homo_l1_weight < ZERO){
+        cerr << "PD graph d1 quadratic l1 bounds: negative homogeneous l1 "
+            "penalization (" << homo_l1_weight << ")." << endl;
+        exit(EXIT_FAILURE);
+    }
+    this->l1_weights = l1_weights; this->homo_l1_weight = homo_l1_weight;
+    this->Yl1 = Yl1;
+}
+
+TPL void PD_D1_QL1B::set_bounds(const real_t* low_bnd, real_t homo_low_bnd,
+    const real_t* upp_bnd, real_t homo_upp_bnd)
+{
+    if (!low_bnd && !upp_bnd && homo_low_bnd > homo_upp_bnd){
+        cerr << "PD graph d1 quadratic l1 bounds: homogeneous lower bound ("
+            << homo_low_bnd << ") greater than homogeneous upper bound ("
+            << homo_upp_bnd << ")." << endl;
+        exit(EXIT_FAILURE);
+    }
+    this->low_bnd = low_bnd; this->homo_low_bnd = homo_low_bnd;
+    this->upp_bnd = upp_bnd; this->homo_upp_bnd = homo_upp_bnd;
+}
+
+TPL void PD_D1_QL1B::apply_A()
+{
+    if (!IS_ATA(N)){ /* direct matricial case, compute residual R = Y - A X */
+        #pragma omp parallel for schedule(static) NUM_THREADS(N*V, N)
+        for (size_t n = 0; n < N; n++){
+            R[n] = Y_(n);
+            size_t i = n;
+            for (vertex_t v = 0; v < V; v++){
+                R[n] -= A[i]*X[v];
+                i += N;
+            }
+        }
+    }else if (N == FULL_ATA){ /* premultiplied by A^t, compute (A^t A) X */
+        #pragma omp parallel for schedule(static) NUM_THREADS(V*V, V)
+        for (vertex_t v = 0; v < V; v++){
+            const real_t *Av = A + (size_t) V*v;
+            AX[v] = ZERO;
+            for (vertex_t u = 0; u < V; u++){ AX[v] += Av[u]*X[u]; }
+        }
+    } /* diagonal case dealt with within the proximal operator */
+}
+
+TPL void PD_D1_QL1B::compute_lipschitz_metric()
+{
+    if (N == DIAG_ATA){ /* diagonal case, within the proximal operator */
+        L = nullptr;
+        if (A){
+            double sum = 0.0;
+            #pragma omp parallel for schedule(static) NUM_THREADS(V) \
+                reduction(+:sum)
+            for (vertex_t v = 0; v < V; v++){ sum += A[v]; }
+            mean_curvature = sum/V;
+        }else{
+            mean_curvature = a;
+        }
+        return;
+    }
+
+    /* A^t A <= l diag(Lmut)^-2, with Lmut a Jacobi equilibration and l the
+     * norm of the equilibrated matrix, see Pfdr_d1_ql1b */
+    if (!Lmut){ Lmut = (real_t*) malloc_check(sizeof(real_t)*V); }
+    symmetric_equilibration_jacobi<real_t>(N, V, A, Lmut);
+    real_t l = operator_norm_matrix(N, V, A, Lmut);
+    double sum = 0.0;
+    #pragma omp parallel for schedule(static) NUM_THREADS(2*V, V) \
+        reduction(+:sum)
+    for (vertex_t v = 0; v < V; v++){
+        real_t AAv = ONE/(Lmut[v]*Lmut[v]); // diagonal of A^t A
+        sum += AAv;
+        Lmut[v] = l*AAv;
+    }
+    mean_curvature = sum/V;
+    L = Lmut;
+}
+
+TPL void PD_D1_QL1B::compute_grad_f()
+/* supposed to be called after apply_A() */
+{
+    if (!IS_ATA(N)){ /* direct matricial case, grad = -(A^t) R */
+        #pragma omp parallel for schedule(static) NUM_THREADS(V*N, V)
+        for (vertex_t v = 0; v < V; v++){
+            const real_t *Av = A + N*v;
+            Grad[v] = ZERO;
+            for (size_t n = 0; n < N; n++){ Grad[v] -= Av[n]*R[n]; }
+        }
+    }else if (N == FULL_ATA){ /* grad = (A^t A) X - A^t Y */
+        #pragma omp parallel for schedule(static) NUM_THREADS(V)
+        for (vertex_t v = 0; v < V; v++){ Grad[v] = AX[v] - Y_(v); }
+    }
+}
+
+TPL void PD_D1_QL1B::compute_prox_Tau_h()
+{
+    #pragma omp parallel for schedule(static) NUM_THREADS(V)
+    for (vertex_t v = 0; v < V; v++){
+        real_t th_l1 = l1_weights ? l1_weights[v] : homo_l1_weight;
+        if (N == DIAG_ATA){
+        /* minimize 1/2 q x^2 - b x + th_l1 |x - Yl1|, with q and b gathering
+         * the proximity term and the quadratic part */
+            real_t q = ONE/Tau[v] + AA_(v);
+            real_t b = X[v]/Tau[v] + Y_(v);
+            if (b - th_l1 > q*Yl1_(v)){ X[v] = (b - th_l1)/q; }
+            else if (b + th_l1 < q*Yl1_(v)){ X[v] = (b + th_l1)/q; }
+            else{ X[v] = Yl1_(v); }
+        }else if (th_l1){
+            th_l1 *= Tau[v];
+            real_t dif = X[v] - Yl1_(v);
+            if (dif > th_l1){ dif -= th_l1; }
+            else if (dif < -th_l1){ dif += th_l1; }
+            else{ dif = ZERO; }
+            X[v] = Yl1_(v) + dif;
+        }
+        if (low_bnd){
+            if (X[v] < low_bnd[v]){ X[v] = low_bnd[v]; }
+        }else if (homo_low_bnd > -INF_REAL){
+            if (X[v] < homo_low_bnd){ X[v] = homo_low_bnd; }
+        }
+        if (upp_bnd){
+            if (X[v] > upp_bnd[v]){ X[v] = upp_bnd[v]; }
+        }else if (homo_upp_bnd < INF_REAL){
+            if (X[v] > homo_upp_bnd){ X[v] = homo_upp_bnd; }
+        }
+    }
+}
+
+TPL real_t PD_D1_QL1B::compute_f()
+{
+    double obj = 0.0; // accumulate in double precision
+    if (!IS_ATA(N)){ /* direct matricial case, 1/2 ||Y - A X||^2 */
+        #pragma omp parallel for schedule(static) NUM_THREADS(N) \
+            reduction(+:obj)
+        for (size_t n = 0; n < N; n++){ obj += R[n]*R[n]; }
+        obj *= HALF;
+    }else if (N == FULL_ATA){ /* 1/2<X, A^t AX> - <X, A^t Y> */
+        #pragma omp parallel for schedule(static) NUM_THREADS(V) \
+            reduction(+:obj)
+        for (vertex_t v = 0; v < V; v++){
+            obj += X[v]*(HALF*AX[v] - Y_(v));
+        }
+    }else if (A || a){ /* diagonal case */
+        #pragma omp parallel for schedule(static) NUM_THREADS(V) \
+            reduction(+:obj)
+        for (vertex_t v = 0; v < V; v++){
+            obj += X[v]*(HALF*AA_(v)*X[v] - Y_(v));
+        }
+    }
+    return obj;
+}
+
+TPL real_t PD_D1_QL1B::compute_h()
+{
+    double obj = 0.0; // accumulate in double precision
+    if (l1_weights || homo_l1_weight){ /* ||x||_l1 */
+        #pragma omp parallel for schedule(static) NUM_THREADS(V) \
+             reduction(+:obj)
+        for (vertex_t v = 0; v < V; v++){
+            if (l1_weights){ obj += l1_weights[v]*abs(X[v] - Yl1_(v)); }
+            else{ obj += homo_l1_weight*abs(X[v] - Yl1_(v)); }
+        }
+    }
+    return obj;
+}
+
+TPL void PD_D1_QL1B::initialize_iterate()
+/* initialize with coordinatewise pseudo-inverse pinv = <Av, Y>/||Av||^2,
+ * or on l1 target if there is no quadratic part */
+{
+    if (!X){ X = (real_t*) malloc_check(sizeof(real_t)*V); }
+
+    /* prevent useless computations */
+    if (A && !Y){
+        for (vertex_t v = 0; v < V; v++){ X[v] = ZERO; }
+        return;
+    }
+
+    if (IS_ATA(N)){ /* left-premultiplied by A^t case */
+        if (A){
+            size_t Vdiag = N == FULL_ATA ? (size_t) V + 1 : 1;
+            #pragma omp parallel for schedule(static) NUM_THREADS(V)
+            for (vertex_t v = 0; v < V; v++){
+                X[v] = A[Vdiag*v] > ZERO ? Y[v]/A[Vdiag*v] : ZERO;
+            }
+        }else if (a){ /* identity */
+            for (vertex_t v = 0; v < V; v++){ X[v] = Y_(v); }
+        }else{ /* no quadratic part, initialize on l1 */
+            for (vertex_t v = 0; v < V; v++){ X[v] = Yl1_(v); }
+        }
+    }else{ /* direct matricial case */
+        #pragma omp parallel for schedule(static) NUM_THREADS(2*N*V, V)
+        for (vertex_t v = 0; v < V; v++){
+            const real_t* Av = A + N*v;
+            real_t AvY = ZERO;
+            real_t Av2 = ZERO;
+            for (size_t n = 0; n < N; n++){
+                AvY += Av[n]*Y[n];
+                Av2 += Av[n]*Av[n];
+            }
+            X[v] = Av2 > ZERO ? AvY/Av2 : ZERO;
+        }
+    }
+}
+
+TPL void PD_D1_QL1B::preconditioning(bool init)
+{
+    if (N != DIAG_ATA && !Grad){
+        Grad = (real_t*) malloc_check(sizeof(real_t)*V);
+    }
+
+    Pd_d1<real_t, vertex_t>::preconditioning(init);
+
+    apply_A();
+}
+
+TPL void PD_D1_QL1B::main_iteration()
+{
+    Pd_d1<real_t, vertex_t>::main_iteration();
+
+    apply_A();
+}
+
+TPL real_t PD_D1_QL1B::compute_primal_evolution()
+{
+    const real_t* AA = N == DIAG_ATA ? A : L; // L is only a bound otherwise
+    double dif = 0.0; // accumulate in double precision
+    double amp = 0.0;
+    #pragma omp parallel for schedule(static) NUM_THREADS(V) \
+        reduction(+:dif, amp)
+    for (vertex_t v = 0; v < V; v++){
+        real_t d = last_X[v] - X[v];
+        dif += AA ? AA[v]*d*d : d*d;
+        amp += AA ? AA[v]*X[v]*X[v] : X[v]*X[v];
+        last_X[v] = X[v];
+    }
+    return sqrt(amp) > eps ? sqrt(dif/amp) : sqrt(dif)/eps;
+}
+
+/**  instantiate for compilation  **/
+template class Pd_d1_ql1b<float, uint16_t>;
+template class Pd_d1_ql1b<float, uint32_t>;
+template class Pd_d1_ql1b<double, uint16_t>;
+template class Pd_d1_ql1b<double, uint32_t>;
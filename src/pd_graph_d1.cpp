@@ -0,0 +1,276 @@
+/*=============================================================================
+ * Diagonally preconditioned primal-dual algorithm for graph total variation
+ *===========================================================================*/
+#include <cmath>
+#include "../include/omp_num_threads.hpp"
+#include "../include/pd_graph_d1.hpp"
+
+/* constants of the correct type */
+#define ZERO ((real_t) 0.0)
+#define ONE ((real_t) 1.0)
+#define TWO ((real_t) 2.0)
+#define HALF ((real_t) 0.5)
+
+/* adaptive balance of primal and dual steps, see Goldstein et al. (2015) */
+#define BALANCE_RATIO 1.5 // tolerated ratio between residuals norms
+#define INIT_ADAPT_RATE ((real_t) 0.5)
+#define ADAPT_RATE_DECAY ((real_t) 0.95)
+
+#define EDGE_WEIGHTS_(e) (edge_weights ? edge_weights[(e)] : homo_edge_weight)
+#define COOR_WEIGHTS_(d) (coor_weights ? coor_weights[(d)] : ONE)
+
+#define TPL template <typename real_t, typename vertex_t>
+#define PD_D1 Pd_d1<real_t, vertex_t>
+
+using namespace std;
+
+TPL PD_D1::Pd_d1(vertex_t V, size_t E, const vertex_t* edges, size_t D,
+    const real_t* coor_weights) : Pcd_prox<real_t>(V*D), V(V), E(E), D(D),
+    edges(edges), coor_weights(coor_weights)
+{
+    this->set_name("Diagonally preconditioned primal-dual algorithm");
+    edge_weights = nullptr;
+    homo_edge_weight = ONE;
+    dual_scale = scale = ZERO;
+    adapt_dual_scale = true;
+    adapt_rate = INIT_ADAPT_RATE;
+    dual_res = -1.0;
+    dual_dif = dual_amp = ZERO;
+    L = nullptr;
+    mean_curvature = ZERO;
+    Tau = Grad = P = X_prev = KtP = nullptr;
+    first_adj_edge = adj_edges = nullptr;
+}
+
+TPL PD_D1::~Pd_d1()
+{
+    free(Tau); free(Grad); free(P); free(X_prev); free(KtP);
+    free(first_adj_edge); free(adj_edges);
+}
+
+TPL void PD_D1::set_edge_weights(const real_t* edge_weights,
+    real_t homo_edge_weight)
+{
+    this->edge_weights = edge_weights;
+    this->homo_edge_weight = homo_edge_weight;
+}
+
+TPL void PD_D1::set_dual_scale(real_t dual_scale, bool adapt_dual_scale)
+{
+    if (dual_scale < ZERO){
+        cerr << "PD graph d1: dual scale should be nonnegative ("
+            << dual_scale << " given)." << endl;
+        exit(EXIT_FAILURE);
+    }
+    this->dual_scale = dual_scale;
+    this->adapt_dual_scale = adapt_dual_scale;
+}
+
+TPL void PD_D1::set_dual(real_t* P){ this->P = P; }
+
+TPL real_t* PD_D1::get_dual(){ return P; }
+
+TPL void PD_D1::compute_adjacency()
+{
+    first_adj_edge = (size_t*) malloc_check(sizeof(size_t)*(V + 1));
+    for (vertex_t v = 0; v <= V; v++){ first_adj_edge[v] = 0; }
+    for (size_t e = 0; e < E; e++){
+        if (edges[2*e] == edges[2*e + 1]){ continue; }
+        first_adj_edge[edges[2*e] + 1]++;
+        first_adj_edge[edges[2*e + 1] + 1]++;
+    }
+    for (vertex_t v = 1; v < V; v++){
+        first_adj_edge[v + 1] += first_adj_edge[v];
+    }
+    adj_edges = (size_t*) malloc_check(sizeof(size_t)*first_adj_edge[V]);
+    for (size_t e = 0; e < E; e++){
+        if (edges[2*e] == edges[2*e + 1]){ continue; }
+        adj_edges[first_adj_edge[edges[2*e]]++] = e;
+        adj_edges[first_adj_edge[edges[2*e + 1]]++] = e;
+    }
+    /* shift back the starting indices */
+    for (vertex_t v = V; v > 0; v--){
+        first_adj_edge[v] = first_adj_edge[v - 1];
+    }
+    first_adj_edge[0] = 0;
+}
+
+TPL void PD_D1::preconditioning(bool init)
+{
+    Pcd_prox<real_t>::preconditioning(init);
+
+    if (!first_adj_edge){ compute_adjacency(); }
+
+    if (!P){
+        P = (real_t*) malloc_check(sizeof(real_t)*E*D);
+        for (size_t ed = 0; ed < E*D; ed++){ P[ed] = ZERO; }
+    }
+    if (!X_prev){ X_prev = (real_t*) malloc_check(sizeof(real_t)*V*D); }
+    if (!Tau){ Tau = (real_t*) malloc_check(sizeof(real_t)*V); }
+
+    compute_lipschitz_metric();
+
+    /**  amplitude of the dual variable  **/
+    double sum_w = 0.0, sum_c = 0.0;
+    #pragma omp parallel for schedule(static) NUM_THREADS(E) \
+        reduction(+:sum_w)
+    for (size_t e = 0; e < E; e++){
+        if (edges[2*e] != edges[2*e + 1]){ sum_w += EDGE_WEIGHTS_(e); }
+    }
+    for (size_t d = 0; d < D; d++){ sum_c += COOR_WEIGHTS_(d); }
+    dual_amp = sum_w*sum_c;
+
+    /**  dual scale; adapted value is kept along reconditioning  **/
+    if (init || !adapt_dual_scale || scale == ZERO){
+        scale = dual_scale;
+        if (scale == ZERO){
+            if (mean_curvature > ZERO && first_adj_edge[V] > 0){
+                scale = mean_curvature*V/first_adj_edge[V];
+            }else if (first_adj_edge[V] > 0){ /* average edge weight */
+                scale = 2.0*sum_w/first_adj_edge[V];
+            }
+            if (scale <= ZERO){ scale = ONE; }
+        }
+        adapt_rate = INIT_ADAPT_RATE;
+    }
+
+    if (adapt_dual_scale){
+        if (!KtP){ KtP = (real_t*) malloc_check(sizeof(real_t)*V*D); }
+        dual_res = -1.0; // X_prev and KtP not available yet
+    }
+
+    compute_steps();
+}
+
+TPL void PD_D1::compute_steps()
+{
+    dual_step = HALF*scale;
+
+    #pragma omp parallel for schedule(static) NUM_THREADS(V)
+    for (vertex_t v = 0; v < V; v++){
+        real_t inv_tau = scale*(first_adj_edge[v + 1] - first_adj_edge[v]);
+        if (L){ inv_tau += L[v]; }
+        Tau[v] = inv_tau > eps ? ONE/inv_tau : ONE/eps;
+    }
+}
+
+TPL void PD_D1::balance_steps(double primal_res)
+{
+    /* large primal residual calls for larger primal steps, and conversely */
+    const double ratio2 = BALANCE_RATIO*BALANCE_RATIO;
+    if (primal_res > ratio2*dual_res){
+        scale *= ONE - adapt_rate;
+    }else if (dual_res > ratio2*primal_res){
+        scale /= ONE - adapt_rate;
+    }else{
+        return;
+    }
+    adapt_rate *= ADAPT_RATE_DECAY;
+    compute_steps();
+}
+
+TPL void PD_D1::main_iteration()
+{
+    compute_grad_f();
+
+    /* residuals are available only after a first iteration */
+    const bool residuals = adapt_dual_scale && dual_res >= 0.0;
+
+    /**  forward step on the primal variable  **/
+    double primal_res = 0.0; // accumulate in double precision
+    #pragma omp parallel for schedule(static) \
+        NUM_THREADS(D*(first_adj_edge[V] + V), V, OMP_GRAPH) \
+        reduction(+:primal_res)
+    for (vertex_t v = 0; v < V; v++){
+        real_t* Xv = X + D*v;
+        real_t* X_prevv = X_prev + D*v;
+        for (size_t d = 0; d < D; d++){
+            /* finite differences are x_u - x_v for edge (u, v) */
+            real_t KtPvd = ZERO;
+            for (size_t i = first_adj_edge[v]; i < first_adj_edge[v + 1];
+                i++){
+                size_t e = adj_edges[i];
+                KtPvd += edges[2*e] == v ? P[D*e + d] : -P[D*e + d];
+            }
+            if (adapt_dual_scale){
+                if (residuals){
+                    real_t res = (X_prevv[d] - Xv[d])/Tau[v] -
+                        (KtP[D*v + d] - KtPvd);
+                    primal_res += res*res;
+                }
+                KtP[D*v + d] = KtPvd;
+            }
+            X_prevv[d] = Xv[d];
+            Xv[d] -= Tau[v]*((Grad ? Grad[D*v + d] : ZERO) + KtPvd);
+        }
+    }
+
+    /**  backward step on the primal variable  **/
+    compute_prox_Tau_h();
+
+    /**  dual step over extrapolated primal variable, and projection  **/
+    double dif = 0.0, res = 0.0; // accumulate in double precision
+    #pragma omp parallel for schedule(static) \
+        NUM_THREADS(4*E*D, E, OMP_GRAPH) reduction(+:dif, res)
+    for (size_t e = 0; e < E; e++){
+        vertex_t u = edges[2*e], v = edges[2*e + 1];
+        if (u == v){ continue; }
+        const real_t* Xu = X + D*u;
+        const real_t* Xv = X + D*v;
+        const real_t* X_prevu = X_prev + D*u;
+        const real_t* X_prevv = X_prev + D*v;
+        real_t* Pe = P + D*e;
+        for (size_t d = 0; d < D; d++){
+            real_t bnd = EDGE_WEIGHTS_(e)*COOR_WEIGHTS_(d);
+            real_t Ped = Pe[d] + dual_step*((TWO*Xu[d] - X_prevu[d]) -
+                (TWO*Xv[d] - X_prevv[d]));
+            if (Ped > bnd){ Ped = bnd; }
+            else if (Ped < -bnd){ Ped = -bnd; }
+            dif += abs(Ped - Pe[d]);
+            if (adapt_dual_scale){
+                real_t res_ed = (Pe[d] - Ped)/dual_step -
+                    ((X_prevu[d] - Xu[d]) - (X_prevv[d] - Xv[d]));
+                res += res_ed*res_ed;
+            }
+            Pe[d] = Ped;
+        }
+    }
+    dual_dif = dif;
+
+    /**  balance primal and dual steps with residuals of previous step  **/
+    if (residuals){ balance_steps(primal_res); }
+    if (adapt_dual_scale){ dual_res = res; }
+}
+
+TPL real_t PD_D1::compute_evolution()
+{
+    real_t dif = compute_primal_evolution();
+    if (dual_amp > eps && dual_dif/dual_amp > dif){ dif = dual_dif/dual_amp; }
+    return dif;
+}
+
+TPL real_t PD_D1::compute_g()
+{
+    double obj = 0.0; // accumulate in double precision
+    #pragma omp parallel for schedule(static) \
+        NUM_THREADS(2*E*D, E, OMP_GRAPH) reduction(+:obj)
+    for (size_t e = 0; e < E; e++){
+        const real_t* Xu = X + D*edges[2*e];
+        const real_t* Xv = X + D*edges[2*e + 1];
+        real_t dif = ZERO;
+        for (size_t d = 0; d < D; d++){
+            dif += abs(Xu[d] - Xv[d])*COOR_WEIGHTS_(d);
+        }
+        obj += EDGE_WEIGHTS_(e)*dif;
+    }
+    return obj;
+}
+
+TPL real_t PD_D1::compute_objective()
+{ return compute_f() + compute_g() + compute_h(); }
+
+/**  instantiate for compilation  **/
+template class Pd_d1<float, uint16_t>;
+template class Pd_d1<float, uint32_t>;
+template class Pd_d1<double, uint16_t>;
+template class Pd_d1<double, uint32_t>;
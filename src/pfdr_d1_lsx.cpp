@@ -146,7 +146,7 @@ TPL void PFDR_D1_LSX::compute_prox_Ga_h()
 
 TPL real_t PFDR_D1_LSX::compute_f()
 {
-    real_t obj = ZERO;
+    double obj = 0.0; // accumulate in double precision
     if (loss == LINEAR){
         #pragma omp parallel for schedule(static) NUM_THREADS(V*D, V) \
             reduction(+:obj)
@@ -230,6 +230,8 @@ TPL void PFDR_D1_LSX::preconditioning(bool init)
 
 TPL void PFDR_D1_LSX::initialize_iterate()
 {
+    if (!X){ X = (real_t*) malloc_check(sizeof(real_t)*V*D); }
+
     /*if (loss == LINEAR){ *//* Yv might not lie on the simplex;
         * create a point on the simplex by removing the minimum value
         * (resulting problem loss + d1 + simplex problem strictly equivalent)
@@ -261,8 +263,8 @@ TPL void PFDR_D1_LSX::initialize_iterate()
 
 TPL real_t PFDR_D1_LSX::compute_evolution()
 {
-    real_t dif = ZERO;
-    real_t amp = ZERO;
+    double dif = 0.0; // accumulate in double precision
+    double amp = 0.0;
     #pragma omp parallel for schedule(static) NUM_THREADS(V*D, V) \
         reduction(+:dif, amp)
     for (vertex_t v = 0; v < V; v++){
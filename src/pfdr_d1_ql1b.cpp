@@ -228,7 +228,7 @@ TPL void PFDR_D1_QL1B::compute_prox_Ga_h()
 
 TPL real_t PFDR_D1_QL1B::compute_f()
 {
-    real_t obj = ZERO;
+    double obj = 0.0; // accumulate in double precision
     if (!IS_ATA(N)){ /* direct matricial case, 1/2 ||Y - A X||^2 */
         #pragma omp parallel for schedule(static) NUM_THREADS(N) \
             reduction(+:obj)
@@ -246,7 +246,7 @@ TPL real_t PFDR_D1_QL1B::compute_f()
 
 TPL real_t PFDR_D1_QL1B::compute_h()
 {
-    real_t obj = ZERO;
+    double obj = 0.0; // accumulate in double precision
     if (l1_weights || homo_l1_weight){ /* ||x||_l1 */
         #pragma omp parallel for schedule(static) NUM_THREADS(V) \
              reduction(+:obj)
@@ -305,9 +305,13 @@ TPL void PFDR_D1_QL1B::preconditioning(bool init)
         if (lipschcomput == EACH){ lipschcomput = ONCE; }
     }
 
+    /* auxiliary variables given by the user mean a warm restart, in which
+     * case the iterate is kept as is */
+    bool warm_restart = Z;
+
     Pfdr_d1<real_t, vertex_t>::preconditioning(init);
 
-    if (init){ /* reinitialize according to penalizations */
+    if (init && !warm_restart){ /* reinitialize according to penalizations */
         vertex_t num_ops = (low_bnd || homo_low_bnd > -INF_REAL ||
             upp_bnd || homo_upp_bnd < INF_REAL) ? V : 1;
         #pragma omp parallel for schedule(static) NUM_THREADS(num_ops)
@@ -339,8 +343,8 @@ TPL void PFDR_D1_QL1B::main_iteration()
 
 TPL real_t PFDR_D1_QL1B::compute_evolution()
 {
-    real_t dif = ZERO;
-    real_t amp = ZERO;
+    double dif = 0.0; // accumulate in double precision
+    double amp = 0.0;
     #pragma omp parallel for schedule(static) NUM_THREADS(V) \
         reduction(+:dif, amp)
     for (vertex_t v = 0; v < V; v++){
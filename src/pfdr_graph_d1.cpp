@@ -62,7 +62,7 @@ TPL void PFDR_D1::add_pseudo_hess_g()
  * the second order derivative 1/||y1 - y2|| */
 {
     /* finite differences and amplitudes */
-    #pragma omp parallel for schedule(static) NUM_THREADS(4*E, E)
+    #pragma omp parallel for schedule(static) NUM_THREADS(4*E, E, OMP_GRAPH)
     for (size_t e = 0; e < E; e++){
         real_t* Xu = X + edges[2*e]*D;
         real_t* Xv = X + edges[2*e + 1]*D;
@@ -94,7 +94,8 @@ TPL void PFDR_D1::add_pseudo_hess_g()
     /* actual pseudo-hessian, can be parallelized along coordinates */
     const size_t Dga = gashape == MULTIDIM ? D : 1;
     const size_t Dw = wshape == MULTIDIM ? D : 1; /* Dw <= Dga */
-    #pragma omp parallel for schedule(static) NUM_THREADS(4*E*Dga, Dga)
+    #pragma omp parallel for schedule(static) \
+        NUM_THREADS(4*E*Dga, Dga, OMP_GRAPH)
     for (size_t d = 0; d < Dga; d++){
         size_t id = d;
         size_t jd = d + Dw;
@@ -191,7 +192,7 @@ TPL void PFDR_D1::preconditioning(bool init)
     const size_t Dd1 = thd1shape == MULTIDIM ? D : 1;
     const size_t Dga = gashape == MULTIDIM ? D : 1;
     const size_t Dw = wshape == MULTIDIM ? D : 1;
-    #pragma omp parallel for schedule(static) NUM_THREADS(8*E*Dd1, E)
+    #pragma omp parallel for schedule(static) NUM_THREADS(8*E*Dd1, E, OMP_GRAPH)
     for (size_t e = 0; e < E; e++){
         size_t i = 2*e;
         size_t j = 2*e + 1;
@@ -220,7 +221,7 @@ TPL void PFDR_D1::preconditioning(bool init)
 
 TPL void PFDR_D1::compute_prox_GaW_g()
 {
-    #pragma omp parallel for schedule(static) NUM_THREADS(8*E*D, E)
+    #pragma omp parallel for schedule(static) NUM_THREADS(8*E*D, E, OMP_GRAPH)
     for (size_t e = 0; e < E; e++){
         size_t i = 2*e;
         size_t j = 2*e + 1;
@@ -269,8 +270,8 @@ TPL void PFDR_D1::compute_prox_GaW_g()
 
 TPL real_t PFDR_D1::compute_g()
 {
-    real_t obj = ZERO;
-    #pragma omp parallel for schedule(static) NUM_THREADS(2*E*D, E) \
+    double obj = 0.0; // accumulate in double precision
+    #pragma omp parallel for schedule(static) NUM_THREADS(2*E*D, E, OMP_GRAPH) \
         reduction(+:obj)
     for (size_t e = 0; e < E; e++){
         size_t ud = edges[2*e]*D;
@@ -0,0 +1,562 @@
+/*=============================================================================
+ * Semismooth Newton augmented Lagrangian method for quadratic, l1 and bounds
+ * problems with graph total variation
+ *===========================================================================*/
+#include <cmath>
+#include <cstdint>
+#include "../include/ssnal_d1_ql1b.hpp"
+
+/* constants of the correct type */
+#define ZERO ((real_t) 0.0)
+#define ONE ((real_t) 1.0)
+#define HALF ((real_t) 0.5)
+#define EDGE_WEIGHTS_(e) (edge_weights ? edge_weights[(e)] : homo_edge_weight)
+#define L1_WEIGHTS_(v) (l1_weights ? l1_weights[(v)] : homo_l1_weight)
+#define LOW_BND_(v) (low_bnd ? low_bnd[(v)] : homo_low_bnd)
+#define UPP_BND_(v) (upp_bnd ? upp_bnd[(v)] : homo_upp_bnd)
+#define Y_(v) (Y ? Y[(v)] : (real_t) 0.0)
+#define Yl1_(v) (Yl1 ? Yl1[(v)] : (real_t) 0.0)
+#define AA_(v) (N == FULL_ATA ? A[(size_t) (V + 1)*(v)] : A[(v)]) // diagonal
+
+#define TPL template <typename real_t, typename vertex_t>
+#define SSNAL_D1_QL1B Ssnal_d1_ql1b<real_t, vertex_t>
+
+using namespace std;
+
+TPL SSNAL_D1_QL1B::Ssnal_d1_ql1b(vertex_t V, size_t E, const vertex_t* edges)
+    : V(V), E(E), edges(edges)
+{
+    /* ensure handling of infinite values (negation, comparisons) is safe */
+    static_assert(numeric_limits<real_t>::is_iec559,
+        "SSNAL d1 quadratic l1 bounds: real_t must satisfy IEEE 754.");
+    edge_weights = nullptr; homo_edge_weight = ONE;
+    N = DIAG_ATA;
+    Y = Yl1 = A = nullptr;
+    l1_weights = nullptr; homo_l1_weight = ZERO;
+    low_bnd = nullptr; homo_low_bnd = -INF_REAL;
+    upp_bnd = nullptr; homo_upp_bnd = INF_REAL;
+
+    dif_tol = 1e-10; it_max = 100; verbose = 0;
+    cancel = nullptr;
+    converged = false;
+
+    X = P = Pv = nullptr;
+    s = ONE;
+}
+
+TPL SSNAL_D1_QL1B::~Ssnal_d1_ql1b(){ free(X); free(P); free(Pv); }
+
+TPL void* SSNAL_D1_QL1B::malloc_check(size_t size)
+{
+    void *ptr = malloc(size);
+    if (ptr == nullptr){
+        cerr << "SSNAL d1 quadratic l1 bounds: not enough memory." << endl;
+        exit(EXIT_FAILURE);
+    }
+    return ptr;
+}
+
+TPL void SSNAL_D1_QL1B::set_edge_weights(const real_t* edge_weights,
+    real_t homo_edge_weight)
+{
+    if (!edge_weights && homo_edge_weight < ZERO){
+        cerr << "SSNAL d1 quadratic l1 bounds: negative homogeneous edge "
+            "weight (" << homo_edge_weight << ")." << endl;
+        exit(EXIT_FAILURE);
+    }
+    this->edge_weights = edge_weights;
+    this->homo_edge_weight = homo_edge_weight;
+}
+
+TPL void SSNAL_D1_QL1B::set_quadratic(const real_t* Y, size_t N,
+    const real_t* A)
+{
+    if (!IS_ATA(N) || !A){
+        cerr << "SSNAL d1 quadratic l1 bounds: the matrix A^t A must be "
+            "given, full (N = FULL_ATA) or diagonal (N = DIAG_ATA)." << endl;
+        exit(EXIT_FAILURE);
+    }
+    this->Y = Y; this->N = N; this->A = A;
+}
+
+TPL void SSNAL_D1_QL1B::set_l1(const real_t* l1_weights,
+    real_t homo_l1_weight, const real_t* Yl1)
+{
+    if (!l1_weights && homo_l1_weight < ZERO){
+        cerr << "SSNAL d1 quadratic l1 bounds: negative homogeneous l1 "
+            "penalization (" << homo_l1_weight << ")." << endl;
+        exit(EXIT_FAILURE);
+    }
+    this->l1_weights = l1_weights; this->homo_l1_weight = homo_l1_weight;
+    this->Yl1 = Yl1;
+}
+
+TPL void SSNAL_D1_QL1B::set_bounds(const real_t* low_bnd, real_t homo_low_bnd,
+    const real_t* upp_bnd, real_t homo_upp_bnd)
+{
+    if (!low_bnd && !upp_bnd && homo_low_bnd > homo_upp_bnd){
+        cerr << "SSNAL d1 quadratic l1 bounds: homogeneous lower bound ("
+            << homo_low_bnd << ") greater than homogeneous upper bound ("
+            << homo_upp_bnd << ")." << endl;
+        exit(EXIT_FAILURE);
+    }
+    this->low_bnd = low_bnd; this->homo_low_bnd = homo_low_bnd;
+    this->upp_bnd = upp_bnd; this->homo_upp_bnd = homo_upp_bnd;
+}
+
+TPL void SSNAL_D1_QL1B::set_cancel_flag(const atomic<bool>* cancel)
+{ this->cancel = cancel; }
+
+TPL void SSNAL_D1_QL1B::set_algo_param(real_t dif_tol, int it_max,
+    int verbose)
+{
+    this->dif_tol = dif_tol; this->it_max = it_max; this->verbose = verbose;
+}
+
+TPL void SSNAL_D1_QL1B::set_iterate(real_t* X){ this->X = X; }
+
+TPL real_t* SSNAL_D1_QL1B::get_iterate(){ return X; }
+
+TPL bool SSNAL_D1_QL1B::is_converged(){ return converged; }
+
+TPL void SSNAL_D1_QL1B::initialize_iterate()
+{
+    if (!X){ X = (real_t*) malloc_check(sizeof(real_t)*V); }
+    for (vertex_t v = 0; v < V; v++){
+        real_t aa = AA_(v), yl1 = Yl1_(v), l1 = L1_WEIGHTS_(v);
+        real_t x;
+        if (aa > ZERO){ /* soft-thresholding of the pseudo-inverse */
+            x = Y_(v)/aa;
+            if (x > yl1 + l1/aa){ x -= l1/aa; }
+            else if (x < yl1 - l1/aa){ x += l1/aa; }
+            else{ x = yl1; }
+        }else{
+            x = yl1;
+        }
+        if (x < LOW_BND_(v)){ x = LOW_BND_(v); }
+        else if (x > UPP_BND_(v)){ x = UPP_BND_(v); }
+        X[v] = x;
+    }
+}
+
+TPL void SSNAL_D1_QL1B::apply_AA(const real_t* x, real_t* AX)
+{
+    if (N == FULL_ATA){
+        for (vertex_t u = 0; u < V; u++){
+            const real_t* Au = A + (size_t) V*u; // by symmetry
+            AX[u] = ZERO;
+            for (vertex_t v = 0; v < V; v++){ AX[u] += Au[v]*x[v]; }
+        }
+    }else{
+        for (vertex_t v = 0; v < V; v++){ AX[v] = A[v]*x[v]; }
+    }
+}
+
+TPL real_t SSNAL_D1_QL1B::prox_vertex(vertex_t v, real_t t, bool& fixed)
+{
+    real_t l1 = L1_WEIGHTS_(v);
+    fixed = false;
+    if (l1 > ZERO){ /* soft-thresholding around Yl1 */
+        real_t yl1 = Yl1_(v), thr = l1/s;
+        if (t > yl1 + thr){ t -= thr; }
+        else if (t < yl1 - thr){ t += thr; }
+        else{ t = yl1; fixed = true; }
+    }
+    /* in dimension one, the projection commutes with the l1 proximity */
+    if (t < LOW_BND_(v)){ t = LOW_BND_(v); fixed = true; }
+    else if (t > UPP_BND_(v)){ t = UPP_BND_(v); fixed = true; }
+    return t;
+}
+
+TPL real_t SSNAL_D1_QL1B::compute_lagrangian(const real_t* x,
+    const real_t* AX)
+{
+    real_t lag = ZERO;
+    for (vertex_t v = 0; v < V; v++){
+        lag += x[v]*(HALF*AX[v] - Y_(v));
+        /* Moreau envelope of the separable part */
+        real_t t = x[v] + Pv[v]/s;
+        bool fixed;
+        real_t p = prox_vertex(v, t, fixed);
+        lag += L1_WEIGHTS_(v)*abs(p - Yl1_(v)) + HALF*s*(t - p)*(t - p);
+    }
+    for (size_t e = 0; e < E; e++){
+        vertex_t u = edges[2*e], v = edges[2*e + 1];
+        if (u == v){ continue; }
+        /* Moreau envelope of the absolute value, that is Huber function */
+        real_t w = EDGE_WEIGHTS_(e);
+        real_t t = abs(x[u] - x[v] + P[e]/s);
+        lag += s*t <= w ? HALF*s*t*t : w*(t - HALF*w/s);
+    }
+    return lag;
+}
+
+TPL real_t SSNAL_D1_QL1B::compute_gradient(const real_t* x, const real_t* AX,
+    real_t* Grad, real_t* P_new, real_t* Pv_new, bool* fused, bool* fixed)
+{
+    /* total variation part, K^t P_new, with P_new the projection of
+     * P + s K x over the edge weights */
+    for (vertex_t v = 0; v < V; v++){ Grad[v] = ZERO; }
+    for (size_t e = 0; e < E; e++){
+        vertex_t u = edges[2*e], v = edges[2*e + 1];
+        fused[e] = false;
+        if (u == v){ P_new[e] = ZERO; continue; }
+        real_t w = EDGE_WEIGHTS_(e);
+        real_t t = P[e] + s*(x[u] - x[v]);
+        if (t >= w){ P_new[e] = w; }
+        else if (t <= -w){ P_new[e] = -w; }
+        else{ P_new[e] = t; fused[e] = true; }
+        Grad[u] += P_new[e];
+        Grad[v] -= P_new[e];
+    }
+    real_t KtP2 = ZERO, AX2 = ZERO, Y2 = ZERO, Pv2 = ZERO;
+    for (vertex_t v = 0; v < V; v++){
+        KtP2 += Grad[v]*Grad[v];
+        /* separable part */
+        real_t t = x[v] + Pv[v]/s;
+        real_t p = prox_vertex(v, t, fixed[v]);
+        Pv_new[v] = s*(t - p);
+        Grad[v] += AX[v] - Y_(v) + Pv_new[v];
+        AX2 += AX[v]*AX[v];
+        Y2 += Y_(v)*Y_(v);
+        Pv2 += Pv_new[v]*Pv_new[v];
+    }
+    return sqrt(KtP2) + sqrt(AX2) + sqrt(Y2) + sqrt(Pv2);
+}
+
+TPL void SSNAL_D1_QL1B::factorize_hessian(const bool* fused,
+    const bool* fixed, real_t* H)
+{
+    const real_t eps = numeric_limits<real_t>::epsilon();
+    real_t reg = ZERO; // regularization, increased until factorizable
+    while (true){
+        /**  assemble A^t A + s K_F^t K_F + s I_B, lower triangular part  **/
+        for (vertex_t j = 0; j < V; j++){
+            real_t* Hj = H + (size_t) V*j;
+            if (N == FULL_ATA){
+                const real_t* Aj = A + (size_t) V*j;
+                for (vertex_t i = j; i < V; i++){ Hj[i] = Aj[i]; }
+            }else{
+                for (vertex_t i = j; i < V; i++){ Hj[i] = ZERO; }
+                Hj[j] = A[j];
+            }
+            Hj[j] += reg;
+            if (fixed[j]){ Hj[j] += s; }
+        }
+        for (size_t e = 0; e < E; e++){
+            if (!fused[e]){ continue; }
+            vertex_t u = edges[2*e], v = edges[2*e + 1];
+            H[(size_t) (V + 1)*u] += s;
+            H[(size_t) (V + 1)*v] += s;
+            if (u > v){ H[u + (size_t) V*v] -= s; }
+            else{ H[v + (size_t) V*u] -= s; }
+        }
+        real_t diag_max = ZERO;
+        for (vertex_t j = 0; j < V; j++){
+            if (H[(size_t) (V + 1)*j] > diag_max){
+                diag_max = H[(size_t) (V + 1)*j];
+            }
+        }
+
+        if (cholesky(V, H, eps*diag_max)){ return; }
+        reg = reg > ZERO ? (real_t) 1e2*reg : sqrt(eps)*(diag_max > ZERO ?
+            diag_max : s);
+    }
+}
+
+TPL bool SSNAL_D1_QL1B::cholesky(size_t n, real_t* M, real_t tol)
+{
+    /* right-looking, for contiguous access along columns */
+    for (size_t j = 0; j < n; j++){
+        real_t* Mj = M + n*j;
+        if (Mj[j] <= tol){ return false; }
+        Mj[j] = sqrt(Mj[j]);
+        for (size_t i = j + 1; i < n; i++){ Mj[i] /= Mj[j]; }
+        for (size_t k = j + 1; k < n; k++){
+            real_t* Mk = M + n*k;
+            for (size_t i = k; i < n; i++){ Mk[i] -= Mj[i]*Mj[k]; }
+        }
+    }
+    return true;
+}
+
+TPL void SSNAL_D1_QL1B::cholesky_solve(size_t n, const real_t* L, real_t* b)
+{
+    for (size_t j = 0; j < n; j++){
+        const real_t* Lj = L + n*j;
+        b[j] /= Lj[j];
+        for (size_t i = j + 1; i < n; i++){ b[i] -= Lj[i]*b[j]; }
+    }
+    for (size_t j = n; j-- > 0;){
+        const real_t* Lj = L + n*j;
+        for (size_t i = j + 1; i < n; i++){ b[j] -= Lj[i]*b[i]; }
+        b[j] /= Lj[j];
+    }
+}
+
+TPL real_t SSNAL_D1_QL1B::compute_objective(const real_t* x, const real_t* AX)
+{
+    real_t obj = ZERO;
+    for (vertex_t v = 0; v < V; v++){
+        obj += x[v]*(HALF*AX[v] - Y_(v)) + L1_WEIGHTS_(v)*abs(x[v] - Yl1_(v));
+    }
+    for (size_t e = 0; e < E; e++){
+        obj += EDGE_WEIGHTS_(e)*abs(x[edges[2*e]] - x[edges[2*e + 1]]);
+    }
+    return obj;
+}
+
+TPL void SSNAL_D1_QL1B::polish(const bool* fused, const bool* fixed,
+    real_t* H)
+{
+    /**  groups, as connected components of the fused edges  **/
+    vertex_t* group = (vertex_t*) malloc_check(sizeof(vertex_t)*V);
+    for (vertex_t v = 0; v < V; v++){ group[v] = v; }
+    auto find = [group](vertex_t v) -> vertex_t {
+        while (group[v] != v){ v = group[v] = group[group[v]]; }
+        return v;
+    };
+    for (size_t e = 0; e < E; e++){
+        if (!fused[e]){ continue; }
+        vertex_t u = find(edges[2*e]), v = find(edges[2*e + 1]);
+        if (u < v){ group[v] = u; }else{ group[u] = v; }
+    }
+    for (vertex_t v = 0; v < V; v++){ group[v] = find(v); } // roots first
+
+    /**  a group with a fixed vertex takes its value, at a bound or at the
+     **  kink of the l1 norm, whichever is closest; others are numbered  **/
+    const vertex_t FIXED = numeric_limits<vertex_t>::max();
+    real_t* X_pol = (real_t*) malloc_check(sizeof(real_t)*V);
+    bool* fixed_group = (bool*) malloc_check(sizeof(bool)*V);
+    for (vertex_t v = 0; v < V; v++){ fixed_group[v] = false; }
+    for (vertex_t v = 0; v < V; v++){
+        vertex_t r = group[v];
+        if (!fixed[v] || fixed_group[r]){ continue; }
+        real_t x = L1_WEIGHTS_(v) > ZERO ? Yl1_(v) : LOW_BND_(v);
+        if (abs(X[v] - LOW_BND_(v)) < abs(X[v] - x)){ x = LOW_BND_(v); }
+        if (abs(X[v] - UPP_BND_(v)) < abs(X[v] - x)){ x = UPP_BND_(v); }
+        X_pol[r] = x;
+        fixed_group[r] = true;
+    }
+    vertex_t G = 0; // number of free groups
+    vertex_t* index = (vertex_t*) malloc_check(sizeof(vertex_t)*V);
+    for (vertex_t v = 0; v < V; v++){
+        if (group[v] == v){ index[v] = fixed_group[v] ? FIXED : G++; }
+    }
+    for (vertex_t v = 0; v < V; v++){
+        X_pol[v] = X_pol[group[v]];
+        index[v] = index[group[v]];
+    }
+    free(fixed_group);
+
+    /**  optimality of the free groups: summing the gradient over each one
+     **  cancels the terms along the fused edges; the other terms of the
+     **  total variation and of the l1 norm are given by the multipliers  **/
+    real_t* B = (real_t*) malloc_check(sizeof(real_t)*(G ? G : 1));
+    for (vertex_t k = 0; k < G; k++){ B[k] = ZERO; }
+    for (size_t i = 0; i < (size_t) G*G; i++){ H[i] = ZERO; }
+    for (vertex_t v = 0; v < V; v++){
+        if (index[v] == FIXED){ continue; }
+        B[index[v]] += Y_(v) - Pv[v];
+    }
+    for (size_t e = 0; e < E; e++){
+        vertex_t u = edges[2*e], v = edges[2*e + 1];
+        if (index[u] != FIXED){ B[index[u]] -= P[e]; }
+        if (index[v] != FIXED){ B[index[v]] += P[e]; }
+    }
+    for (vertex_t v = 0; v < V; v++){
+        if (N == FULL_ATA){
+            const real_t* Av = A + (size_t) V*v;
+            for (vertex_t u = 0; u < V; u++){
+                if (index[u] == FIXED){ continue; }
+                if (index[v] == FIXED){
+                    B[index[u]] -= Av[u]*X_pol[v];
+                }else{
+                    H[index[u] + (size_t) G*index[v]] += Av[u];
+                }
+            }
+        }else if (index[v] != FIXED){
+            H[(size_t) (G + 1)*index[v]] += A[v];
+        }
+    }
+
+    real_t diag_max = ZERO;
+    for (vertex_t k = 0; k < G; k++){
+        if (H[(size_t) (G + 1)*k] > diag_max){
+            diag_max = H[(size_t) (G + 1)*k];
+        }
+    }
+    bool feasible = cholesky(G, H, numeric_limits<real_t>::epsilon()*
+        diag_max);
+    if (feasible){
+        cholesky_solve(G, H, B);
+        for (vertex_t v = 0; v < V && feasible; v++){
+            if (index[v] == FIXED){ continue; }
+            X_pol[v] = B[index[v]];
+            feasible = LOW_BND_(v) <= X_pol[v] && X_pol[v] <= UPP_BND_(v);
+        }
+    }
+
+    /**  keep the best of both  **/
+    if (feasible){
+        real_t* AX = (real_t*) malloc_check(sizeof(real_t)*V);
+        apply_AA(X, AX);
+        real_t obj = compute_objective(X, AX);
+        apply_AA(X_pol, AX);
+        if (compute_objective(X_pol, AX) <= obj){
+            for (vertex_t v = 0; v < V; v++){ X[v] = X_pol[v]; }
+        }
+        free(AX);
+    }
+
+    free(group); free(index); free(X_pol); free(B);
+}
+
+TPL int SSNAL_D1_QL1B::solve()
+{
+    if (!X){ initialize_iterate(); }
+    if (!P){ P = (real_t*) malloc_check(sizeof(real_t)*E); }
+    if (!Pv){ Pv = (real_t*) malloc_check(sizeof(real_t)*V); }
+    for (size_t e = 0; e < E; e++){ P[e] = ZERO; }
+    for (vertex_t v = 0; v < V; v++){ Pv[v] = ZERO; }
+
+    /* the initial penalty balances the mean curvature of the quadratic part,
+     * which also gives the typical scale of the iterate */
+    real_t curvature = ZERO;
+    for (vertex_t v = 0; v < V; v++){ curvature += AA_(v); }
+    curvature /= V;
+    if (curvature <= ZERO){ curvature = ONE; }
+    s = curvature;
+
+    real_t* AX = (real_t*) malloc_check(sizeof(real_t)*V);
+    real_t* AX_try = (real_t*) malloc_check(sizeof(real_t)*V);
+    real_t* X_try = (real_t*) malloc_check(sizeof(real_t)*V);
+    real_t* Grad = (real_t*) malloc_check(sizeof(real_t)*V);
+    real_t* dX = (real_t*) malloc_check(sizeof(real_t)*V);
+    real_t* P_new = (real_t*) malloc_check(sizeof(real_t)*E);
+    real_t* Pv_new = (real_t*) malloc_check(sizeof(real_t)*V);
+    bool* fused = (bool*) malloc_check(sizeof(bool)*E);
+    bool* fixed = (bool*) malloc_check(sizeof(bool)*V);
+    real_t* H = (real_t*) malloc_check(sizeof(real_t)*V*V);
+
+    const real_t eps = numeric_limits<real_t>::epsilon();
+    int it = 0;
+    converged = false;
+    real_t last_res = INF_REAL;
+    /* relative tolerance of the inner minimizations, decreasing along with
+     * the violation of the constraints */
+    real_t inner_tol = (real_t) 1e-2;
+    apply_AA(X, AX);
+    for (int outer = 1; ; outer++){
+        /**  minimize the augmented Lagrangian by Newton iterations  **/
+        real_t grad_norm, grad_scale;
+        while (true){
+            grad_scale = compute_gradient(X, AX, Grad, P_new, Pv_new, fused,
+                fixed);
+            grad_norm = ZERO;
+            for (vertex_t v = 0; v < V; v++){ grad_norm += Grad[v]*Grad[v]; }
+            grad_norm = sqrt(grad_norm);
+            if (grad_norm <= inner_tol*grad_scale || it >= it_max ||
+                (cancel && *cancel)){ break; }
+
+            /* Newton direction, solving L L^t dX = -Grad */
+            factorize_hessian(fused, fixed, H);
+            for (vertex_t j = 0; j < V; j++){ dX[j] = -Grad[j]; }
+            cholesky_solve(V, H, dX);
+
+            /* backtracking line search; when the decrease of the augmented
+             * Lagrangian is below its rounding errors, on the norm of its
+             * gradient instead, in which case the arrays given to
+             * compute_gradient() are recomputed at the next iteration */
+            real_t slope = ZERO;
+            for (vertex_t v = 0; v < V; v++){ slope += Grad[v]*dX[v]; }
+            real_t lag = compute_lagrangian(X, AX);
+            /* the terms of the augmented Lagrangian are bounded by the norm
+             * of the iterate times the scale of the gradient */
+            real_t X_norm = ZERO;
+            for (vertex_t v = 0; v < V; v++){ X_norm += X[v]*X[v]; }
+            bool on_grad = -slope <= (real_t) 1e2*eps*sqrt(X_norm)*grad_scale;
+            bool progress = false;
+            real_t step = ONE;
+            while (!progress && step >= (real_t) 1e-10){
+                for (vertex_t v = 0; v < V; v++){
+                    X_try[v] = X[v] + step*dX[v];
+                }
+                apply_AA(X_try, AX_try);
+                if (on_grad){
+                    compute_gradient(X_try, AX_try, Grad, P_new, Pv_new,
+                        fused, fixed);
+                    real_t grad_norm_try = ZERO;
+                    for (vertex_t v = 0; v < V; v++){
+                        grad_norm_try += Grad[v]*Grad[v];
+                    }
+                    progress = sqrt(grad_norm_try) <=
+                        (ONE - (real_t) 1e-4*step)*grad_norm;
+                }else{
+                    progress = compute_lagrangian(X_try, AX_try) <=
+                        lag + (real_t) 1e-4*step*slope;
+                }
+                step *= HALF;
+            }
+            it++;
+            if (!progress){ /* at precision, back to the current iterate */
+                grad_scale = compute_gradient(X, AX, Grad, P_new, Pv_new,
+                    fused, fixed);
+                break;
+            }
+            for (vertex_t v = 0; v < V; v++){ X[v] = X_try[v]; }
+            real_t* swap = AX; AX = AX_try; AX_try = swap;
+        }
+
+        /**  update multipliers; the variations are s times the violations
+         **  of the constraints  **/
+        real_t res = ZERO, X_norm = ZERO;
+        for (size_t e = 0; e < E; e++){
+            res += (P_new[e] - P[e])*(P_new[e] - P[e]);
+        }
+        for (vertex_t v = 0; v < V; v++){
+            res += (Pv_new[v] - Pv[v])*(Pv_new[v] - Pv[v]);
+            X_norm += X[v]*X[v];
+        }
+        res = sqrt(res)/s;
+        X_norm = sqrt(X_norm);
+        real_t* swap = P; P = P_new; P_new = swap;
+        swap = Pv; Pv = Pv_new; Pv_new = swap;
+
+        if (verbose){
+            cout << "SSNAL iteration " << it << ": penalty " << s
+                << ", constraints violation " << res << ", gradient "
+                << grad_norm << endl;
+        }
+
+        /* the scale of the gradient divided by the curvature gives a typical
+         * scale of the iterate, in case the latter is zero */
+        real_t X_scale = X_norm > grad_scale/curvature ? X_norm :
+            grad_scale/curvature;
+        if (grad_norm <= dif_tol*grad_scale && res <= dif_tol*X_scale){
+            converged = true;
+            break;
+        }
+        inner_tol = max(dif_tol, min(inner_tol, (real_t) 0.1*res/X_scale));
+        if (it >= it_max || outer >= it_max || (cancel && *cancel)){ break; }
+        if (res > (real_t) 0.25*last_res){ s *= (real_t) 10.0; }
+        last_res = res;
+    }
+
+    /* the constraints being satisfied up to the tolerance only */
+    for (vertex_t v = 0; v < V; v++){
+        if (X[v] < LOW_BND_(v)){ X[v] = LOW_BND_(v); }
+        else if (X[v] > UPP_BND_(v)){ X[v] = UPP_BND_(v); }
+    }
+    if (converged){ polish(fused, fixed, H); }
+
+    free(AX); free(AX_try); free(X_try); free(Grad); free(dX); free(P_new);
+    free(Pv_new); free(fused); free(fixed); free(H);
+    return it;
+}
+
+/**  instantiate for compilation  **/
+template class Ssnal_d1_ql1b<float, uint16_t>;
+template class Ssnal_d1_ql1b<float, uint32_t>;
+template class Ssnal_d1_ql1b<double, uint16_t>;
+template class Ssnal_d1_ql1b<double, uint32_t>;